@@ -2,19 +2,40 @@ local vs = [[
 #ifndef SKIN_ON
 	#define SKIN_ON 0
 #endif
+#ifndef SKIN_TEXTURE_ON
+	#define SKIN_TEXTURE_ON 0
+#endif
+#ifndef INSTANCING_ON
+	#define INSTANCING_ON 0
+#endif
 #ifndef RECIEVE_SHADOW_ON
 	#define RECIEVE_SHADOW_ON 0
 #endif
+#ifndef CLUSTER_LIGHT_ON
+	#define CLUSTER_LIGHT_ON 0
+#endif
+#if (CLUSTER_LIGHT_ON == 1)
+	// shadow is only recieved in light passes
+	#undef RECIEVE_SHADOW_ON
+	#define RECIEVE_SHADOW_ON 0
+#endif
 
 VK_UNIFORM_BINDING(0) uniform PerView
 {
 	mat4 u_view_matrix;
     mat4 u_projection_matrix;
 };
-VK_UNIFORM_BINDING(1) uniform PerRenderer
-{
-	mat4 u_model_matrix;
-};
+#if (INSTANCING_ON == 1)
+	VK_UNIFORM_BINDING(9) uniform PerRendererInstances
+	{
+		mat4 u_model_matrices[256];
+	};
+#else
+	VK_UNIFORM_BINDING(1) uniform PerRenderer
+	{
+		mat4 u_model_matrix;
+	};
+#endif
 VK_UNIFORM_BINDING(3) uniform PerMaterialVertex
 {
 	vec4 u_texture_scale_offset;
@@ -27,10 +48,16 @@ VK_LAYOUT_LOCATION(1) out vec2 v_uv;
 VK_LAYOUT_LOCATION(2) out vec3 v_normal;
 
 #if (SKIN_ON == 1)
-	VK_UNIFORM_BINDING(2) uniform PerRendererBones
-	{
-		vec4 u_bones[210];
-	};
+	#if (SKIN_TEXTURE_ON == 1)
+		VK_SAMPLER_BINDING(7) uniform highp sampler2D u_bones_texture;
+		#define BONE_ROW(index, row) texelFetch(u_bones_texture, ivec2(row, index), 0)
+	#else
+		VK_UNIFORM_BINDING(2) uniform PerRendererBones
+		{
+			vec4 u_bones[210];
+		};
+		#define BONE_ROW(index, row) u_bones[index*3+row]
+	#endif
 	layout(location = 6) in vec4 i_bone_weights;
 	layout(location = 7) in vec4 i_bone_indices;
 	mat4 skin_mat()
@@ -43,10 +70,10 @@ VK_LAYOUT_LOCATION(2) out vec3 v_normal;
 		float weights_1 = i_bone_weights.y;
 		float weights_2 = i_bone_weights.z;
 		float weights_3 = i_bone_weights.w;
-		mat4 bone_0 = mat4(u_bones[index_0*3], u_bones[index_0*3+1], u_bones[index_0*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_1 = mat4(u_bones[index_1*3], u_bones[index_1*3+1], u_bones[index_1*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_2 = mat4(u_bones[index_2*3], u_bones[index_2*3+1], u_bones[index_2*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_3 = mat4(u_bones[index_3*3], u_bones[index_3*3+1], u_bones[index_3*3+2], vec4(0, 0, 0, 1));
+		mat4 bone_0 = mat4(BONE_ROW(index_0, 0), BONE_ROW(index_0, 1), BONE_ROW(index_0, 2), vec4(0, 0, 0, 1));
+		mat4 bone_1 = mat4(BONE_ROW(index_1, 0), BONE_ROW(index_1, 1), BONE_ROW(index_1, 2), vec4(0, 0, 0, 1));
+		mat4 bone_2 = mat4(BONE_ROW(index_2, 0), BONE_ROW(index_2, 1), BONE_ROW(index_2, 2), vec4(0, 0, 0, 1));
+		mat4 bone_3 = mat4(BONE_ROW(index_3, 0), BONE_ROW(index_3, 1), BONE_ROW(index_3, 2), vec4(0, 0, 0, 1));
 		return bone_0 * weights_0 + bone_1 * weights_1 + bone_2 * weights_2 + bone_3 * weights_3;
 	}
 #endif
@@ -60,10 +87,16 @@ VK_LAYOUT_LOCATION(2) out vec3 v_normal;
 	};
 #endif
 
+#if (CLUSTER_LIGHT_ON == 1)
+	VK_LAYOUT_LOCATION(4) out vec4 v_cluster_pos;
+#endif
+
 void main()
 {
 #if (SKIN_ON == 1)
     mat4 model_matrix = skin_mat();
+#elif (INSTANCING_ON == 1)
+    mat4 model_matrix = u_model_matrices[VK_INSTANCE_INDEX];
 #else
     mat4 model_matrix = u_model_matrix;
 #endif
@@ -78,6 +111,11 @@ void main()
 	v_pos_light_proj = vec4(i_vertex.xyz, 1.0) * model_matrix * u_light_view_matrix * u_light_projection_matrix;
 #endif
 
+#if (CLUSTER_LIGHT_ON == 1)
+	// clip xy w and view depth
+	v_cluster_pos = vec4(gl_Position.xyw, -(world_pos * u_view_matrix).z);
+#endif
+
 	vk_convert();
 }
 ]]
@@ -92,6 +130,14 @@ local fs = [[
 #ifndef VR_GLES
 	#define VR_GLES 0
 #endif
+#ifndef CLUSTER_LIGHT_ON
+	#define CLUSTER_LIGHT_ON 0
+#endif
+#if (CLUSTER_LIGHT_ON == 1)
+	// shadow is only recieved in light passes
+	#undef RECIEVE_SHADOW_ON
+	#define RECIEVE_SHADOW_ON 0
+#endif
 
 precision highp float;
 VK_SAMPLER_BINDING(0) uniform sampler2D u_texture;
@@ -99,19 +145,100 @@ VK_UNIFORM_BINDING(4) uniform PerMaterialFragment
 {
     vec4 u_color;
 };
-VK_UNIFORM_BINDING(6) uniform PerLightFragment
-{
-	vec4 u_ambient_color;
-    vec4 u_light_pos;
-    vec4 u_light_color;
-	vec4 u_light_atten;
-	vec4 u_spot_light_dir;
-	vec4 u_shadow_params;
-};
 VK_LAYOUT_LOCATION(0) in vec3 v_pos;
 VK_LAYOUT_LOCATION(1) in vec2 v_uv;
 VK_LAYOUT_LOCATION(2) in vec3 v_normal;
 
+vec3 light_diffuse(vec3 c, vec3 normal, vec4 light_pos, vec4 light_color, vec4 light_atten, vec4 spot_light_dir)
+{
+	vec3 to_light = light_pos.xyz - v_pos * light_pos.w;
+	vec3 light_dir = normalize(to_light);
+	float nl = max(dot(normal, light_dir), 0.0);
+
+	float sqr_len = dot(to_light, to_light);
+	float atten = max(1.0 - sqr_len * light_atten.z, 0.0);
+	int light_type = int(light_color.a);
+	if (light_type == 1)
+	{
+		float theta = dot(light_dir, spot_light_dir.xyz);
+		if (theta > light_atten.x)
+		{
+			atten *= clamp((light_atten.x - theta) * light_atten.y, 0.0, 1.0);
+		}
+		else
+		{
+			atten = 0.0;
+		}
+	}
+
+	return c * nl * light_color.rgb * atten;
+}
+
+#if (CLUSTER_LIGHT_ON == 1)
+	VK_UNIFORM_BINDING(7) uniform PerViewLights
+	{
+		vec4 u_cluster_ambient_color;
+		vec4 u_cluster_size;
+		vec4 u_cluster_depth;
+		vec4 u_cluster_lights[256];
+	};
+	VK_UNIFORM_BINDING(8) uniform PerViewLightIndices
+	{
+		uvec4 u_cluster_indices[1024];
+	};
+	VK_LAYOUT_LOCATION(4) in vec4 v_cluster_pos;
+	uint cluster_uint(int i)
+	{
+		return u_cluster_indices[i / 4][i % 4];
+	}
+	vec3 cluster_light(vec3 c, vec3 normal, int i)
+	{
+		return light_diffuse(c, normal, u_cluster_lights[i * 4], u_cluster_lights[i * 4 + 1], u_cluster_lights[i * 4 + 2], u_cluster_lights[i * 4 + 3]);
+	}
+	vec3 cluster_lights(vec3 c, vec3 normal)
+	{
+		vec3 diffuse = vec3(0.0);
+
+		// directional lights
+		int directional_count = int(u_cluster_size.w);
+		for (int i = 0; i < directional_count; ++i)
+		{
+			diffuse += cluster_light(c, normal, i);
+		}
+
+		// lights of froxel
+		ivec3 size = ivec3(u_cluster_size.xyz);
+		vec2 ndc = v_cluster_pos.xy / v_cluster_pos.z;
+		float depth = u_cluster_depth.z > 0.0 ? log(max(v_cluster_pos.w, 0.0001)) : v_cluster_pos.w;
+		int x = clamp(int((ndc.x * 0.5 + 0.5) * u_cluster_size.x), 0, size.x - 1);
+		int y = clamp(int((ndc.y * 0.5 + 0.5) * u_cluster_size.y), 0, size.y - 1);
+		int z = clamp(int(floor(depth * u_cluster_depth.x + u_cluster_depth.y)), 0, size.z - 1);
+
+		uint record = cluster_uint((z * size.y + y) * size.x + x);
+		int offset = int(record & 0xffffu);
+		int count = int(record >> 16u);
+		int index_start = size.x * size.y * size.z;
+		for (int i = 0; i < count; ++i)
+		{
+			int k = offset + i;
+			int light = int((cluster_uint(index_start + k / 4) >> uint((k % 4) * 8)) & 0xffu);
+			diffuse += cluster_light(c, normal, light);
+		}
+
+		return diffuse;
+	}
+#else
+	VK_UNIFORM_BINDING(6) uniform PerLightFragment
+	{
+		vec4 u_ambient_color;
+		vec4 u_light_pos;
+		vec4 u_light_color;
+		vec4 u_light_atten;
+		vec4 u_spot_light_dir;
+		vec4 u_shadow_params;
+	};
+#endif
+
 #if (RECIEVE_SHADOW_ON == 1)
 	VK_SAMPLER_BINDING(1) uniform highp sampler2D u_shadow_texture;
 	VK_LAYOUT_LOCATION(3) in vec4 v_pos_light_proj;
@@ -214,30 +341,18 @@ layout(location = 0) out vec4 o_color;
 void main()
 {
     vec3 normal = normalize(v_normal);
-	vec3 to_light = u_light_pos.xyz - v_pos * u_light_pos.w;
-	vec3 light_dir = normalize(to_light);
-    float nl = max(dot(normal, light_dir), 0.0);
 	vec4 c = texture(u_texture, v_uv) * u_color;
 
-	float sqr_len = dot(to_light, to_light);
-	float atten = 1.0 - sqr_len * u_light_atten.z;
-	int light_type = int(u_light_color.a);
-	if (light_type == 1)
-	{
-		float theta = dot(light_dir, u_spot_light_dir.xyz);
-		if (theta > u_light_atten.x)
-		{
-			atten *= clamp((u_light_atten.x - theta) * u_light_atten.y, 0.0, 1.0);
-		}
-		else
-		{
-			atten = 0.0;
-		}
-	}
-
-	vec3 diffuse = c.rgb * nl * u_light_color.rgb * atten;
+#if (CLUSTER_LIGHT_ON == 1)
+	vec3 diffuse = cluster_lights(c.rgb, normal);
+	vec3 ambient = c.rgb * u_cluster_ambient_color.rgb;
+	c.rgb = ambient + diffuse;
+#else
+	vec3 diffuse = light_diffuse(c.rgb, normal, u_light_pos, u_light_color, u_light_atten, u_spot_light_dir);
 
 #if (RECIEVE_SHADOW_ON == 1)
+	vec3 light_dir = normalize(u_light_pos.xyz - v_pos * u_light_pos.w);
+	float nl = max(dot(normal, light_dir), 0.0);
 	float shadow = sample_shadow(v_pos_light_proj, nl);
     diffuse = diffuse * (1.0 - shadow);
 #endif
@@ -247,6 +362,7 @@ void main()
 #else
 	vec3 ambient = c.rgb * u_ambient_color.rgb;
 	c.rgb = ambient + diffuse;
+#endif
 #endif
 
 	c.a = 0.0;
@@ -313,6 +429,16 @@ local pass = {
 				},
 			},
 		},
+		{
+			name = "PerRendererInstances",
+			binding = 9,
+			members = {
+				{
+					name = "u_model_matrices",
+					size = 64 * 256,
+				},
+			},
+		},
         {
             name = "PerRendererBones",
             binding = 2,
@@ -387,8 +513,50 @@ local pass = {
                 },
             },
         },
+        {
+            name = "PerViewLights",
+            binding = 7,
+            members = {
+                {
+                    name = "u_cluster_ambient_color",
+                    size = 16,
+                },
+                {
+                    name = "u_cluster_size",
+                    size = 16,
+                },
+                {
+                    name = "u_cluster_depth",
+                    size = 16,
+                },
+                {
+                    name = "u_cluster_lights",
+                    size = 16 * 256,
+                },
+            },
+        },
+        {
+            name = "PerViewLightIndices",
+            binding = 8,
+            members = {
+                {
+                    name = "u_cluster_indices",
+                    size = 16 * 1024,
+                },
+            },
+        },
 	},
 	samplers = {
+		{
+			name = "PerRenderer",
+			binding = 1,
+			samplers = {
+				{
+					name = "u_bones_texture",
+					binding = 7,
+				},
+			},
+		},
 		{
 			name = "PerMaterialFragment",
 			binding = 4,
@@ -2,6 +2,9 @@ local vs = [[
 #ifndef SKIN_ON
 	#define SKIN_ON 0
 #endif
+#ifndef SKIN_TEXTURE_ON
+	#define SKIN_TEXTURE_ON 0
+#endif
 
 VK_UNIFORM_BINDING(0) uniform PerView
 {
@@ -26,10 +29,16 @@ VK_LAYOUT_LOCATION(1) out vec3 v_camera_pos;
 VK_LAYOUT_LOCATION(2) out vec4 v_tangent_to_world[3];
 
 #if (SKIN_ON == 1)
-	VK_UNIFORM_BINDING(2) uniform PerRendererBones
-	{
-		vec4 u_bones[210];
-	};
+	#if (SKIN_TEXTURE_ON == 1)
+		VK_SAMPLER_BINDING(7) uniform highp sampler2D u_bones_texture;
+		#define BONE_ROW(index, row) texelFetch(u_bones_texture, ivec2(row, index), 0)
+	#else
+		VK_UNIFORM_BINDING(2) uniform PerRendererBones
+		{
+			vec4 u_bones[210];
+		};
+		#define BONE_ROW(index, row) u_bones[index*3+row]
+	#endif
 	layout(location = 6) in vec4 i_bone_weights;
 	layout(location = 7) in vec4 i_bone_indices;
 	mat4 skin_mat()
@@ -42,10 +51,10 @@ VK_LAYOUT_LOCATION(2) out vec4 v_tangent_to_world[3];
 		float weights_1 = i_bone_weights.y;
 		float weights_2 = i_bone_weights.z;
 		float weights_3 = i_bone_weights.w;
-		mat4 bone_0 = mat4(u_bones[index_0*3], u_bones[index_0*3+1], u_bones[index_0*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_1 = mat4(u_bones[index_1*3], u_bones[index_1*3+1], u_bones[index_1*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_2 = mat4(u_bones[index_2*3], u_bones[index_2*3+1], u_bones[index_2*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_3 = mat4(u_bones[index_3*3], u_bones[index_3*3+1], u_bones[index_3*3+2], vec4(0, 0, 0, 1));
+		mat4 bone_0 = mat4(BONE_ROW(index_0, 0), BONE_ROW(index_0, 1), BONE_ROW(index_0, 2), vec4(0, 0, 0, 1));
+		mat4 bone_1 = mat4(BONE_ROW(index_1, 0), BONE_ROW(index_1, 1), BONE_ROW(index_1, 2), vec4(0, 0, 0, 1));
+		mat4 bone_2 = mat4(BONE_ROW(index_2, 0), BONE_ROW(index_2, 1), BONE_ROW(index_2, 2), vec4(0, 0, 0, 1));
+		mat4 bone_3 = mat4(BONE_ROW(index_3, 0), BONE_ROW(index_3, 1), BONE_ROW(index_3, 2), vec4(0, 0, 0, 1));
 		return bone_0 * weights_0 + bone_1 * weights_1 + bone_2 * weights_2 + bone_3 * weights_3;
 	}
 #endif
@@ -137,6 +137,16 @@ local pass = {
         },
 	},
 	samplers = {
+		{
+			name = "PerRenderer",
+			binding = 1,
+			samplers = {
+				{
+					name = "u_bones_texture",
+					binding = 7,
+				},
+			},
+		},
 		{
 			name = "PerMaterialFragment",
 			binding = 4,
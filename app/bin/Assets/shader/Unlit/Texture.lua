@@ -2,6 +2,12 @@ local vs = [[
 #ifndef SKIN_ON
 	#define SKIN_ON 0
 #endif
+#ifndef SKIN_TEXTURE_ON
+	#define SKIN_TEXTURE_ON 0
+#endif
+#ifndef INSTANCING_ON
+	#define INSTANCING_ON 0
+#endif
 #ifndef BLEND_SHAPE_ON
 	#define BLEND_SHAPE_ON 0
 #endif
@@ -11,10 +17,17 @@ VK_UNIFORM_BINDING(0) uniform PerView
 	mat4 u_view_matrix;
     mat4 u_projection_matrix;
 };
-VK_UNIFORM_BINDING(1) uniform PerRenderer
-{
-	mat4 u_model_matrix;
-};
+#if (INSTANCING_ON == 1)
+	VK_UNIFORM_BINDING(9) uniform PerRendererInstances
+	{
+		mat4 u_model_matrices[256];
+	};
+#else
+	VK_UNIFORM_BINDING(1) uniform PerRenderer
+	{
+		mat4 u_model_matrix;
+	};
+#endif
 VK_UNIFORM_BINDING(3) uniform PerMaterialVertex
 {
 	vec4 u_texture_scale_offset;
@@ -24,10 +37,16 @@ layout(location = 2) in vec2 i_uv;
 VK_LAYOUT_LOCATION(0) out vec2 v_uv;
 
 #if (SKIN_ON == 1)
-	VK_UNIFORM_BINDING(2) uniform PerRendererBones
-	{
-		vec4 u_bones[210];
-	};
+	#if (SKIN_TEXTURE_ON == 1)
+		VK_SAMPLER_BINDING(7) uniform highp sampler2D u_bones_texture;
+		#define BONE_ROW(index, row) texelFetch(u_bones_texture, ivec2(row, index), 0)
+	#else
+		VK_UNIFORM_BINDING(2) uniform PerRendererBones
+		{
+			vec4 u_bones[210];
+		};
+		#define BONE_ROW(index, row) u_bones[index*3+row]
+	#endif
 	layout(location = 6) in vec4 i_bone_weights;
 	layout(location = 7) in vec4 i_bone_indices;
 	mat4 skin_mat()
@@ -40,10 +59,10 @@ VK_LAYOUT_LOCATION(0) out vec2 v_uv;
 		float weights_1 = i_bone_weights.y;
 		float weights_2 = i_bone_weights.z;
 		float weights_3 = i_bone_weights.w;
-		mat4 bone_0 = mat4(u_bones[index_0*3], u_bones[index_0*3+1], u_bones[index_0*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_1 = mat4(u_bones[index_1*3], u_bones[index_1*3+1], u_bones[index_1*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_2 = mat4(u_bones[index_2*3], u_bones[index_2*3+1], u_bones[index_2*3+2], vec4(0, 0, 0, 1));
-		mat4 bone_3 = mat4(u_bones[index_3*3], u_bones[index_3*3+1], u_bones[index_3*3+2], vec4(0, 0, 0, 1));
+		mat4 bone_0 = mat4(BONE_ROW(index_0, 0), BONE_ROW(index_0, 1), BONE_ROW(index_0, 2), vec4(0, 0, 0, 1));
+		mat4 bone_1 = mat4(BONE_ROW(index_1, 0), BONE_ROW(index_1, 1), BONE_ROW(index_1, 2), vec4(0, 0, 0, 1));
+		mat4 bone_2 = mat4(BONE_ROW(index_2, 0), BONE_ROW(index_2, 1), BONE_ROW(index_2, 2), vec4(0, 0, 0, 1));
+		mat4 bone_3 = mat4(BONE_ROW(index_3, 0), BONE_ROW(index_3, 1), BONE_ROW(index_3, 2), vec4(0, 0, 0, 1));
 		return bone_0 * weights_0 + bone_1 * weights_1 + bone_2 * weights_2 + bone_3 * weights_3;
 	}
 #endif
@@ -93,6 +112,8 @@ void main()
 {
 #if (SKIN_ON == 1)
     mat4 model_matrix = skin_mat();
+#elif (INSTANCING_ON == 1)
+    mat4 model_matrix = u_model_matrices[VK_INSTANCE_INDEX];
 #else
     mat4 model_matrix = u_model_matrix;
 #endif
@@ -181,6 +202,16 @@ local pass = {
 				},
 			},
 		},
+		{
+			name = "PerRendererInstances",
+			binding = 9,
+			members = {
+				{
+					name = "u_model_matrices",
+					size = 64 * 256,
+				},
+			},
+		},
         {
             name = "PerRendererBones",
             binding = 2,
@@ -213,6 +244,16 @@ local pass = {
         },
 	},
 	samplers = {
+		{
+			name = "PerRenderer",
+			binding = 1,
+			samplers = {
+				{
+					name = "u_bones_texture",
+					binding = 7,
+				},
+			},
+		},
         {
 			name = "PerRendererBones",
 			binding = 2,
@@ -0,0 +1,599 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "App.h"
+#include "Engine.h"
+#include "Profiler.h"
+#include "GameObject.h"
+#include "graphics/Camera.h"
+#include "graphics/MeshRenderer.h"
+#include "graphics/StaticBatchingUtility.h"
+#include "graphics/SkinnedMeshRenderer.h"
+#include "graphics/Light.h"
+#include "graphics/Material.h"
+#include "graphics/Mesh.h"
+#include "graphics/RenderStats.h"
+#include "ui/CanvasRenderer.h"
+#include "ui/Sprite.h"
+#include "ui/Label.h"
+#include "time/Time.h"
+#include "io/File.h"
+#include "math/Mathf.h"
+#include "json/json.h"
+#include <backend/DriverEnums.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+// runs engine on noop driver with a generated scene and prints cpu timings as json,
+// needs no window or gpu, only Assets next to executable for shaders and font
+
+using namespace Viry3D;
+
+static std::atomic<int64_t> g_new_count(0);
+
+void* operator new(size_t size)
+{
+    g_new_count.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+struct BenchmarkConfig
+{
+    int renderers = 1000;
+    int materials = 16;
+    int lights = 8;
+    int skinned = 10;
+    int canvases = 2;
+    int sprites = 50;
+    int static_batching = 0;
+    int frames = 300;
+    int warmup = 60;
+    std::string output;
+    std::string trace;
+};
+
+static BenchmarkConfig g_config;
+
+static const int SKIN_BONE_COUNT = 8;
+static const float SKIN_BONE_LENGTH = 0.25f;
+
+static Ref<Mesh> CreateCubeMesh()
+{
+    const Vector3 normals[6] = {
+        Vector3(0, 0, -1), Vector3(0, 0, 1), Vector3(-1, 0, 0),
+        Vector3(1, 0, 0), Vector3(0, -1, 0), Vector3(0, 1, 0)
+    };
+
+    Vector<Mesh::Vertex> vertices;
+    Vector<unsigned int> indices;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        const Vector3& n = normals[i];
+        Vector3 u = fabs(n.y) > 0 ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+        Vector3 v = n * u;
+
+        int first = vertices.Size();
+        for (int j = 0; j < 4; ++j)
+        {
+            float su = (j == 1 || j == 2) ? 0.5f : -0.5f;
+            float sv = (j >= 2) ? 0.5f : -0.5f;
+
+            Mesh::Vertex vertex = { };
+            Vector3 p = n * 0.5f + u * su + v * sv;
+            vertex.vertex = Vector4(p.x, p.y, p.z, 1);
+            vertex.color = Color(1, 1, 1, 1);
+            vertex.uv = Vector2(su + 0.5f, sv + 0.5f);
+            vertex.normal = n;
+            vertices.Add(vertex);
+        }
+
+        indices.Add(first + 0);
+        indices.Add(first + 1);
+        indices.Add(first + 2);
+        indices.Add(first + 0);
+        indices.Add(first + 2);
+        indices.Add(first + 3);
+    }
+
+    return RefMake<Mesh>(std::move(vertices), std::move(indices));
+}
+
+// square column along y, each ring of vertices follows one bone
+static Ref<Mesh> CreateSkinMesh()
+{
+    Vector<Mesh::Vertex> vertices;
+    Vector<unsigned int> indices;
+    Vector<Matrix4x4> bindposes;
+
+    const float r = 0.1f;
+    const Vector3 corners[4] = { Vector3(-r, 0, -r), Vector3(r, 0, -r), Vector3(r, 0, r), Vector3(-r, 0, r) };
+
+    for (int i = 0; i <= SKIN_BONE_COUNT; ++i)
+    {
+        int bone = Mathf::Min(i, SKIN_BONE_COUNT - 1);
+        float y = i * SKIN_BONE_LENGTH;
+
+        for (int j = 0; j < 4; ++j)
+        {
+            Mesh::Vertex vertex = { };
+            vertex.vertex = Vector4(corners[j].x, y, corners[j].z, 1);
+            vertex.color = Color(1, 1, 1, 1);
+            vertex.uv = Vector2(j / 4.0f, i / (float) SKIN_BONE_COUNT);
+            vertex.normal = Vector3(corners[j].x, 0, corners[j].z).Normalized();
+            vertex.bone_weights = Vector4(1, 0, 0, 0);
+            vertex.bone_indices = Vector4((float) bone, 0, 0, 0);
+            vertices.Add(vertex);
+        }
+
+        if (i < SKIN_BONE_COUNT)
+        {
+            int first = i * 4;
+            for (int j = 0; j < 4; ++j)
+            {
+                int a = first + j;
+                int b = first + (j + 1) % 4;
+                indices.Add(a);
+                indices.Add(a + 4);
+                indices.Add(b + 4);
+                indices.Add(a);
+                indices.Add(b + 4);
+                indices.Add(b);
+            }
+
+            bindposes.Add(Matrix4x4::Translation(Vector3(0, -y, 0)));
+        }
+    }
+
+    auto mesh = RefMake<Mesh>(std::move(vertices), std::move(indices));
+    mesh->SetBindposes(std::move(bindposes));
+    return mesh;
+}
+
+class Benchmark : public AppImplement
+{
+public:
+    Benchmark()
+    {
+        auto camera = GameObject::Create("camera")->AddComponent<Camera>();
+        Camera::SetMainCamera(camera);
+        camera->GetTransform()->SetPosition(Vector3(0, 20, -40));
+        camera->GetTransform()->SetRotation(Quaternion::Euler(25, 0, 0));
+        camera->SetFarClip(200);
+        camera->SetCullingMask(1 << 0);
+
+        this->CreateMaterials();
+        this->CreateRenderers();
+        this->CreateLights();
+        this->CreateSkinnedCharacters();
+        this->CreateCanvases();
+    }
+
+    void CreateMaterials()
+    {
+        for (int i = 0; i < Mathf::Max(g_config.materials, 1); ++i)
+        {
+            auto material = RefMake<Material>(Shader::Find("Diffuse"));
+            material->SetColor(MaterialProperty::COLOR, Color((i % 3) / 2.0f, (i % 5) / 4.0f, (i % 7) / 6.0f, 1));
+            m_materials.Add(material);
+        }
+    }
+
+    void CreateRenderers()
+    {
+        auto mesh = CreateCubeMesh();
+        int side = (int) ceil(sqrt((float) g_config.renderers));
+        auto cubes = GameObject::Create("cubes");
+
+        for (int i = 0; i < g_config.renderers; ++i)
+        {
+            auto renderer = GameObject::Create("cube")->AddComponent<MeshRenderer>();
+            renderer->GetTransform()->SetParent(cubes->GetTransform());
+            renderer->GetTransform()->SetPosition(Vector3((i % side - side / 2) * 1.5f, 0, (i / side) * 1.5f));
+            renderer->SetMesh(mesh);
+            renderer->SetMaterial(m_materials[i % m_materials.Size()]);
+            renderer->EnableCastShadow(true);
+            renderer->EnableRecieveShadow(true);
+        }
+
+        if (g_config.static_batching)
+        {
+            StaticBatchingUtility::Combine(cubes);
+        }
+    }
+
+    // first light is directional with shadow, others are point lights spread over renderers
+    void CreateLights()
+    {
+        for (int i = 0; i < g_config.lights; ++i)
+        {
+            auto light = GameObject::Create("light")->AddComponent<Light>();
+            light->SetCullingMask(1 << 0);
+
+            if (i == 0)
+            {
+                light->GetTransform()->SetRotation(Quaternion::Euler(45, 30, 0));
+                light->EnableShadow(true);
+                light->SetShadowTextureSize(1024);
+                light->SetOrthographicSize(40);
+                light->SetNearClip(-50);
+                light->SetFarClip(50);
+            }
+            else
+            {
+                float angle = i * 360.0f / g_config.lights;
+                light->GetTransform()->SetPosition(Quaternion::Euler(0, angle, 0) * Vector3(0, 2, 15));
+                light->SetType(LightType::Point);
+                light->SetRange(10);
+            }
+        }
+    }
+
+    void CreateSkinnedCharacters()
+    {
+        if (g_config.skinned <= 0)
+        {
+            return;
+        }
+
+        auto mesh = CreateSkinMesh();
+        auto material = RefMake<Material>(Shader::Find("Diffuse"));
+
+        for (int i = 0; i < g_config.skinned; ++i)
+        {
+            auto character = GameObject::Create("character");
+            character->GetTransform()->SetPosition(Vector3((i - g_config.skinned / 2) * 1.0f, 0, -5));
+
+            auto root = GameObject::Create("root");
+            root->GetTransform()->SetParent(character->GetTransform());
+
+            Vector<String> bone_paths;
+            String path = "root";
+            Ref<Transform> parent = root->GetTransform();
+            for (int j = 0; j < SKIN_BONE_COUNT; ++j)
+            {
+                auto bone = GameObject::Create(String::Format("b%d", j));
+                bone->GetTransform()->SetParent(parent);
+                bone->GetTransform()->SetLocalPosition(Vector3(0, j == 0 ? 0 : SKIN_BONE_LENGTH, 0));
+
+                path += "/" + bone->GetName();
+                bone_paths.Add(path);
+                m_bones.Add(bone->GetTransform());
+                parent = bone->GetTransform();
+            }
+
+            auto renderer = character->AddComponent<SkinnedMeshRenderer>();
+            renderer->SetBonesRoot(root->GetTransform());
+            renderer->SetBonePaths(bone_paths);
+            renderer->SetMesh(mesh);
+            renderer->SetMaterial(material);
+            renderer->EnableShaderKeyword("SKIN_ON");
+            renderer->EnableCastShadow(true);
+        }
+    }
+
+    void CreateCanvases()
+    {
+        if (g_config.canvases <= 0)
+        {
+            return;
+        }
+
+        auto ui_camera = GameObject::Create("ui_camera")->AddComponent<Camera>();
+        ui_camera->SetClearFlags(CameraClearFlags::Nothing);
+        ui_camera->SetDepth(1);
+        ui_camera->SetCullingMask(1 << 1);
+
+        for (int i = 0; i < g_config.canvases; ++i)
+        {
+            auto canvas = GameObject::Create("canvas")->AddComponent<CanvasRenderer>(FilterMode::Linear);
+            canvas->GetGameObject()->SetLayer(1);
+            canvas->SetCamera(ui_camera);
+
+            for (int j = 0; j < g_config.sprites; ++j)
+            {
+                auto sprite = RefMake<Sprite>();
+                sprite->SetAlignment(ViewAlignment::Left | ViewAlignment::Top);
+                sprite->SetPivot(Vector2(0, 0));
+                sprite->SetOffset(Vector2i((j % 10) * 40, i * 200 + (j / 10) * 40));
+                sprite->SetSize(Vector2i(32, 32));
+                sprite->SetTexture(Texture::GetSharedWhiteTexture());
+                canvas->AddView(sprite);
+            }
+
+            // text changes every frame so canvas mesh is rebuilt like a hud
+            auto label = RefMake<Label>();
+            label->SetAlignment(ViewAlignment::Left | ViewAlignment::Top);
+            label->SetPivot(Vector2(0, 0));
+            label->SetOffset(Vector2i(0, i * 200 + 180));
+            label->SetColor(Color(1, 1, 1, 1));
+            canvas->AddView(label);
+            m_labels.Add(label.get());
+        }
+    }
+
+    void Update()
+    {
+        float time = Time::GetFrameCount() * (1.0f / 60);
+
+        for (int i = 0; i < m_bones.Size(); ++i)
+        {
+            auto bone = m_bones[i].lock();
+            if (bone)
+            {
+                bone->SetLocalRotation(Quaternion::Euler(0, 0, sin(time * 2 + i) * 20));
+            }
+        }
+
+        for (auto i : m_labels)
+        {
+            i->SetText(String::Format("frame:%d dc:%d", Time::GetFrameCount(), Time::GetDrawCall()));
+        }
+    }
+
+private:
+    Vector<Ref<Material>> m_materials;
+    Vector<WeakRef<Transform>> m_bones;
+    Vector<Label*> m_labels;
+};
+
+namespace Viry3D
+{
+    App::App()
+    {
+        m_implement = RefMake<Benchmark>();
+    }
+
+    void App::Update()
+    {
+        RefCast<Benchmark>(m_implement)->Update();
+    }
+}
+
+static Json::Value Summarize(Vector<float>& values)
+{
+    Json::Value value;
+    if (values.Size() == 0)
+    {
+        return value;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0;
+    for (auto i : values)
+    {
+        sum += i;
+    }
+
+    value["mean"] = sum / values.Size();
+    value["min"] = values[0];
+    value["p50"] = values[values.Size() / 2];
+    value["p95"] = values[Mathf::Min((int) (values.Size() * 0.95f), values.Size() - 1)];
+    value["max"] = values[values.Size() - 1];
+    return value;
+}
+
+static bool ParseArgs(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "-renderers") g_config.renderers = atoi(value.c_str());
+        else if (arg == "-materials") g_config.materials = atoi(value.c_str());
+        else if (arg == "-lights") g_config.lights = atoi(value.c_str());
+        else if (arg == "-skinned") g_config.skinned = atoi(value.c_str());
+        else if (arg == "-canvases") g_config.canvases = atoi(value.c_str());
+        else if (arg == "-sprites") g_config.sprites = atoi(value.c_str());
+        else if (arg == "-static_batching") g_config.static_batching = atoi(value.c_str());
+        else if (arg == "-frames") g_config.frames = atoi(value.c_str());
+        else if (arg == "-warmup") g_config.warmup = atoi(value.c_str());
+        else if (arg == "-output") g_config.output = value;
+        else if (arg == "-trace") g_config.trace = value;
+        else return false;
+    }
+
+    return g_config.frames > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (!ParseArgs(argc, argv))
+    {
+        printf("Usage:\n");
+        printf("\tBenchmark.exe [-renderers 1000] [-materials 16] [-lights 8] [-skinned 10] [-canvases 2] [-sprites 50]\n");
+        printf("\t              [-static_batching 0] [-frames 300] [-warmup 60] [-output result.json] [-trace trace.json]\n");
+        return 1;
+    }
+
+    Engine::SetBackend(filament::backend::Backend::NOOP);
+    Engine* engine = Engine::Create(nullptr, 1280, 720);
+    if (engine == nullptr)
+    {
+        printf("engine create failed\n");
+        return 1;
+    }
+
+    // lets async shader variants finish compiling before measuring
+    for (int i = 0; i < g_config.warmup; ++i)
+    {
+        engine->Execute();
+    }
+
+    // only measured frames, ring keeps latest events of each thread
+    if (g_config.trace.size() > 0)
+    {
+        Profiler::SetEnable(true);
+    }
+
+    Vector<float> scene_update;
+    Vector<float> prepare_renderers;
+    Vector<float> render_shadow_maps;
+    Vector<float> render_cameras;
+    Vector<float> frame;
+    Vector<float> command_bytes;
+    Vector<float> command_count;
+    Vector<float> command_flushes;
+    Vector<float> command_stall;
+    int command_stalls = 0;
+    Vector<float> new_count;
+#if VR_MEMORY_ALLOC_COUNT
+    Vector<float> alloc_count;
+#endif
+    int draw_call = 0;
+
+    for (int i = 0; i < g_config.frames; ++i)
+    {
+        int64_t new_begin = g_new_count.load(std::memory_order_relaxed);
+#if VR_MEMORY_ALLOC_COUNT
+        int64_t alloc_begin = Memory::GetAllocCount();
+#endif
+
+        engine->Execute();
+
+        const auto& stats = engine->GetFrameStats();
+        scene_update.Add(stats.scene_update);
+        prepare_renderers.Add(stats.prepare_renderers);
+        render_shadow_maps.Add(stats.render_shadow_maps);
+        render_cameras.Add(stats.render_cameras);
+        frame.Add(stats.frame);
+        command_bytes.Add((float) stats.command_bytes);
+        command_count.Add((float) stats.command_count);
+        command_flushes.Add((float) stats.command_flushes);
+        command_stall.Add(stats.command_stall);
+        command_stalls += stats.command_stalls;
+        new_count.Add((float) (g_new_count.load(std::memory_order_relaxed) - new_begin));
+#if VR_MEMORY_ALLOC_COUNT
+        alloc_count.Add((float) (Memory::GetAllocCount() - alloc_begin));
+#endif
+        draw_call = Time::GetDrawCall();
+    }
+
+    // by type in last frame
+    Vector<Engine::CommandStats> command_stats;
+    engine->GetCommandStats(command_stats);
+    Json::Value commands;
+    for (const auto& i : command_stats)
+    {
+        Json::Value item;
+        item["count"] = i.count;
+        item["bytes"] = i.bytes;
+        commands[i.name] = item;
+    }
+    int command_buffer_size = engine->GetCommandBufferSize();
+
+    // last frame
+    const auto& render_stats = RenderStats::GetLastFrame();
+    Json::Value render;
+    render["draw_calls"] = render_stats.draws.draw_calls;
+    render["instanced_draws"] = render_stats.draws.instanced_draws;
+    render["instances"] = render_stats.draws.instances;
+    render["triangles"] = (Json::Int64) render_stats.draws.triangles;
+    render["material_binds"] = render_stats.draws.material_binds;
+    render["program_changes"] = render_stats.draws.program_changes;
+    render["binds"] = render_stats.binds;
+    render["bind_skips"] = render_stats.bind_skips;
+    render["uniform_uploads"] = render_stats.uniform_uploads;
+    render["uniform_upload_bytes"] = (Json::Int64) render_stats.uniform_upload_bytes;
+    render["texture_uploads"] = render_stats.texture_uploads;
+    render["texture_upload_bytes"] = (Json::Int64) render_stats.texture_upload_bytes;
+    render["buffer_uploads"] = render_stats.buffer_uploads;
+    render["buffer_upload_bytes"] = (Json::Int64) render_stats.buffer_upload_bytes;
+    render["visible_renderers"] = render_stats.visible_renderers;
+    render["culled_renderers"] = render_stats.culled_renderers;
+    render["shadow_casters"] = render_stats.shadow_casters;
+    render["shader_variants_compiled"] = render_stats.shader_variants_compiled;
+    render["shader_variant_cache_hits"] = render_stats.shader_variant_cache_hits;
+    render["temporary_targets"] = render_stats.temporary_targets;
+    render["temporary_targets_created"] = render_stats.temporary_targets_created;
+
+    if (g_config.trace.size() > 0)
+    {
+        Profiler::SetEnable(false);
+        if (!Profiler::DumpChromeTrace(g_config.trace.c_str()))
+        {
+            printf("write trace failed: %s\n", g_config.trace.c_str());
+        }
+    }
+
+    Engine::Destroy(&engine);
+
+    Json::Value config;
+    config["renderers"] = g_config.renderers;
+    config["materials"] = g_config.materials;
+    config["lights"] = g_config.lights;
+    config["skinned"] = g_config.skinned;
+    config["canvases"] = g_config.canvases;
+    config["sprites"] = g_config.sprites;
+    config["static_batching"] = g_config.static_batching;
+    config["frames"] = g_config.frames;
+    config["warmup"] = g_config.warmup;
+
+    Json::Value phases;
+    phases["scene_update_ms"] = Summarize(scene_update);
+    phases["prepare_renderers_ms"] = Summarize(prepare_renderers);
+    phases["render_shadow_maps_ms"] = Summarize(render_shadow_maps);
+    phases["render_cameras_ms"] = Summarize(render_cameras);
+    phases["frame_ms"] = Summarize(frame);
+
+    Json::Value root;
+    root["backend"] = "noop";
+    root["config"] = config;
+    root["phases"] = phases;
+    root["command_bytes"] = Summarize(command_bytes);
+    root["command_count"] = Summarize(command_count);
+    root["command_flushes"] = Summarize(command_flushes);
+    root["command_stall_ms"] = Summarize(command_stall);
+    root["command_stalls"] = command_stalls;
+    root["command_buffer_size"] = command_buffer_size;
+    root["commands"] = commands;
+    root["new_count"] = Summarize(new_count);
+#if VR_MEMORY_ALLOC_COUNT
+    root["memory_alloc_count"] = Summarize(alloc_count);
+#endif
+    root["draw_call"] = draw_call;
+    root["render"] = render;
+
+    std::string json = root.toStyledString();
+    if (g_config.output.size() > 0)
+    {
+        File::WriteAllText(g_config.output.c_str(), json.c_str());
+    }
+    else
+    {
+        printf("%s", json.c_str());
+    }
+
+    return 0;
+}
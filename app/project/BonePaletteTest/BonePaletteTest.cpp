@@ -0,0 +1,265 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "App.h"
+#include "Engine.h"
+#include "GameObject.h"
+#include "graphics/SkinnedMeshRenderer.h"
+#include "graphics/Material.h"
+#include "graphics/Mesh.h"
+#include "graphics/Texture.h"
+#include "math/Matrix4x4.h"
+#include "math/Quaternion.h"
+#include "math/Mathf.h"
+#include <backend/DriverEnums.h>
+#include <stdio.h>
+
+// checks bone palette packing and texel indexing of skinned mesh renderer on cpu,
+// then prepares a skinned mesh past uniform block budget on noop driver,
+// exits with 1 on any mismatch. needs Assets next to executable for shaders like Benchmark
+
+using namespace Viry3D;
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...) \
+    if (!(cond)) \
+    { \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        ++g_failures; \
+    }
+
+static Matrix4x4 MakeBoneMatrix(int bone)
+{
+    return Matrix4x4::TRS(
+        Vector3((float) bone, (float) -bone * 0.5f, (float) bone * 2.0f),
+        Quaternion::Euler((float) (bone % 360), (float) (bone * 7 % 360), 0),
+        Vector3(1.0f + bone * 0.001f, 1.0f, 1.0f));
+}
+
+// same as BONE_ROW(index, row) with texelFetch(u_bones_texture, ivec2(row, index), 0) in skinning shaders
+static Vector4 FetchBoneTexel(const Vector<Vector4>& texels, int index, int row)
+{
+    return texels[index * SkinnedMeshRendererUniforms::BONES_TEXTURE_WIDTH + row];
+}
+
+static void TestThreshold()
+{
+    int uniform_max = SkinnedMeshRendererUniforms::BONES_VECTOR_MAX_COUNT / 3;
+
+    CHECK(!SkinnedMeshRenderer::IsBonesTextureNeeded(uniform_max), "%d bones should fit uniform block", uniform_max);
+    CHECK(SkinnedMeshRenderer::IsBonesTextureNeeded(uniform_max + 1), "%d bones should use bones texture", uniform_max + 1);
+    CHECK(SkinnedMeshRenderer::IsBonesTextureNeeded(SkinnedMeshRendererUniforms::BONES_TEXTURE_MAX_COUNT), "max bones should use bones texture");
+}
+
+static void TestPalette(int bone_count)
+{
+    Vector<Matrix4x4> mats(bone_count);
+    Vector<Vector4> texels(bone_count * 3);
+
+    for (int i = 0; i < bone_count; ++i)
+    {
+        mats[i] = MakeBoneMatrix(i);
+        SkinnedMeshRenderer::PackBone(texels, i, mats[i]);
+    }
+
+    // uploaded as one BONES_TEXTURE_WIDTH x bone_count rgba32f image
+    int image_size = SkinnedMeshRendererUniforms::BONES_TEXTURE_WIDTH * bone_count * (int) sizeof(float) * 4;
+    CHECK(texels.SizeInBytes() == image_size, "%d bones: palette is %d bytes, texture needs %d", bone_count, texels.SizeInBytes(), image_size);
+
+    Vector3 point(0.25f, -1.5f, 3.0f);
+
+    for (int i = 0; i < bone_count; ++i)
+    {
+        // bone indices reach the shader as floats in Mesh::Vertex::bone_indices
+        Mesh::Vertex vertex;
+        vertex.bone_indices = Vector4((float) i, 0, 0, 0);
+        int index = (int) vertex.bone_indices.x;
+        CHECK(index == i, "%d bones: bone index %d read back as %d", bone_count, i, index);
+
+        Vector3 expected = mats[i].MultiplyPoint3x4(point);
+        float skinned[3];
+        for (int row = 0; row < 3; ++row)
+        {
+            Vector4 r = FetchBoneTexel(texels, index, row);
+            skinned[row] = point.x * r.x + point.y * r.y + point.z * r.z + r.w;
+        }
+
+        bool match =
+            Mathf::Abs(skinned[0] - expected.x) < 1e-3f &&
+            Mathf::Abs(skinned[1] - expected.y) < 1e-3f &&
+            Mathf::Abs(skinned[2] - expected.z) < 1e-3f;
+        CHECK(match, "%d bones: bone %d skinned to (%f, %f, %f), expected (%f, %f, %f)",
+            bone_count, i, skinned[0], skinned[1], skinned[2], expected.x, expected.y, expected.z);
+    }
+}
+
+static const int SKIN_BONE_COUNT = 300;
+static const int SKIN_FRAMES = 3;
+
+static Ref<GameObject> g_bones;
+static Ref<SkinnedMeshRenderer> g_skin;
+
+// one triangle skinned by last bone only
+static Ref<Mesh> CreateSkinMesh(int bone_count)
+{
+    Vector<Mesh::Vertex> vertices;
+    Vector<unsigned int> indices = { 0, 1, 2 };
+
+    const Vector3 corners[3] = { Vector3(0, 0, 0), Vector3(0, 1, 0), Vector3(1, 0, 0) };
+    for (int i = 0; i < 3; ++i)
+    {
+        Mesh::Vertex vertex = { };
+        vertex.vertex = Vector4(corners[i].x, corners[i].y, corners[i].z, 1);
+        vertex.color = Color(1, 1, 1, 1);
+        vertex.normal = Vector3(0, 0, -1);
+        vertex.bone_weights = Vector4(1, 0, 0, 0);
+        vertex.bone_indices = Vector4((float) (bone_count - 1), 0, 0, 0);
+        vertices.Add(vertex);
+    }
+
+    Vector<Matrix4x4> bindposes(bone_count);
+    for (int i = 0; i < bone_count; ++i)
+    {
+        bindposes[i] = MakeBoneMatrix(i).Inverse();
+    }
+
+    auto mesh = RefMake<Mesh>(std::move(vertices), std::move(indices));
+    mesh->SetBindposes(std::move(bindposes));
+    return mesh;
+}
+
+class BonePaletteTest : public AppImplement
+{
+public:
+    BonePaletteTest()
+    {
+        g_bones = GameObject::Create("bones");
+
+        Vector<String> bone_paths;
+        for (int i = 0; i < SKIN_BONE_COUNT; ++i)
+        {
+            String name = String::Format("bone%d", i);
+            auto bone = GameObject::Create(name)->GetTransform();
+            bone->SetParent(g_bones->GetTransform());
+            bone->SetLocalPosition(Vector3((float) i, 1, 0));
+            bone->SetLocalRotation(Quaternion::Euler(0, (float) (i % 360), 0));
+            bone_paths.Add("bones/" + name);
+        }
+
+        g_skin = GameObject::Create("skin")->AddComponent<SkinnedMeshRenderer>();
+        g_skin->SetBonesRoot(g_bones->GetTransform());
+        g_skin->SetBonePaths(bone_paths);
+        g_skin->SetMesh(CreateSkinMesh(SKIN_BONE_COUNT));
+        g_skin->SetMaterial(RefMake<Material>(Shader::Find("Diffuse")));
+    }
+};
+
+namespace Viry3D
+{
+    App::App()
+    {
+        m_implement = RefMake<BonePaletteTest>();
+    }
+
+    void App::Update()
+    {
+    }
+}
+
+// palette of renderer is what UpdateBonesTexture uploads to bones texture
+static void TestBonesTexture()
+{
+    int bone_count = SKIN_BONE_COUNT;
+
+    CHECK(g_skin->IsBonesTextureEnable(), "%d bones: bones texture not enabled", bone_count);
+
+    const auto& texture = g_skin->GetBonesTexture();
+    CHECK(texture, "%d bones: no bones texture", bone_count);
+    if (!texture)
+    {
+        return;
+    }
+
+    CHECK(texture->GetWidth() == SkinnedMeshRendererUniforms::BONES_TEXTURE_WIDTH && texture->GetHeight() == bone_count,
+        "%d bones: bones texture is %dx%d", bone_count, texture->GetWidth(), texture->GetHeight());
+    CHECK(texture->GetFormat() == TextureFormat::R32G32B32A32F, "%d bones: bones texture is not rgba32f", bone_count);
+
+    const auto& texels = g_skin->GetBoneVectors();
+    int image_size = texture->GetWidth() * texture->GetHeight() * (int) sizeof(float) * 4;
+    CHECK(texels.SizeInBytes() == image_size, "%d bones: palette is %d bytes, bones texture is %d", bone_count, texels.SizeInBytes(), image_size);
+    if (texels.SizeInBytes() != image_size)
+    {
+        return;
+    }
+
+    int last = bone_count - 1;
+    auto bone = g_bones->GetTransform()->Find(String::Format("bone%d", last));
+    Matrix4x4 expected = bone->GetLocalToWorldMatrix() * g_skin->GetMesh()->GetBindposes()[last];
+
+    for (int row = 0; row < 3; ++row)
+    {
+        Vector4 texel = FetchBoneTexel(texels, last, row);
+        Vector4 r = expected.GetRow(row);
+        bool match =
+            Mathf::Abs(texel.x - r.x) < 1e-4f &&
+            Mathf::Abs(texel.y - r.y) < 1e-4f &&
+            Mathf::Abs(texel.z - r.z) < 1e-4f &&
+            Mathf::Abs(texel.w - r.w) < 1e-4f;
+        CHECK(match, "%d bones: texel (%d, %d) is (%f, %f, %f, %f), expected (%f, %f, %f, %f)",
+            bone_count, row, last, texel.x, texel.y, texel.z, texel.w, r.x, r.y, r.z, r.w);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    TestThreshold();
+
+    int bone_counts[] = { 71, 256, 257, 300, SkinnedMeshRendererUniforms::BONES_TEXTURE_MAX_COUNT };
+    for (int bone_count : bone_counts)
+    {
+        TestPalette(bone_count);
+    }
+
+    Engine::SetBackend(filament::backend::Backend::NOOP);
+    Engine* engine = Engine::Create(nullptr, 1280, 720);
+    if (engine == nullptr)
+    {
+        printf("engine create failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < SKIN_FRAMES; ++i)
+    {
+        engine->Execute();
+    }
+    TestBonesTexture();
+
+    g_skin.reset();
+    g_bones.reset();
+    Engine::Destroy(&engine);
+
+    if (g_failures > 0)
+    {
+        printf("BonePaletteTest failed: %d checks\n", g_failures);
+        return 1;
+    }
+
+    printf("BonePaletteTest passed\n");
+    return 0;
+}
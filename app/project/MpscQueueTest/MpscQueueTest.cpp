@@ -0,0 +1,270 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "thread/MpscQueue.h"
+#include "Action.h"
+#include <atomic>
+#include <thread>
+#include <stdio.h>
+
+// pushes from several producer threads while main thread pops, small ring so overflow list is used too,
+// checks each producer's values arrive once and in order, exits with 1 on any failure.
+// also stalls a producer between claiming and writing its cell to check overflow is not popped early
+
+using namespace Viry3D;
+
+static const int PRODUCER_COUNT = 4;
+static const int PUSH_COUNT = 200000;
+static const int QUEUE_CAPACITY = 64;
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...) \
+    if (!(cond)) \
+    { \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        ++g_failures; \
+    }
+
+struct Item
+{
+    int producer;
+    int seq;
+};
+
+// counts live copies, to find leaked or doubly destroyed captures
+struct Tracker
+{
+    static std::atomic<int> alive;
+
+    Tracker() { alive.fetch_add(1, std::memory_order_relaxed); }
+    Tracker(const Tracker&) { alive.fetch_add(1, std::memory_order_relaxed); }
+    ~Tracker() { alive.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+std::atomic<int> Tracker::alive(0);
+
+class OrderChecker
+{
+public:
+    OrderChecker(const char* name):
+        m_name(name),
+        m_received(0)
+    {
+        for (int i = 0; i < PRODUCER_COUNT; ++i)
+        {
+            m_next[i] = 0;
+        }
+    }
+
+    void Receive(int producer, int seq)
+    {
+        CHECK(producer >= 0 && producer < PRODUCER_COUNT, "%s: bad producer %d", m_name, producer);
+        if (producer < 0 || producer >= PRODUCER_COUNT)
+        {
+            return;
+        }
+
+        CHECK(seq == m_next[producer], "%s: producer %d sent %d, expected %d", m_name, producer, seq, m_next[producer]);
+        m_next[producer] = seq + 1;
+        ++m_received;
+    }
+
+    bool Done() const { return m_received >= PRODUCER_COUNT * PUSH_COUNT; }
+
+    void CheckAll() const
+    {
+        for (int i = 0; i < PRODUCER_COUNT; ++i)
+        {
+            CHECK(m_next[i] == PUSH_COUNT, "%s: producer %d got %d of %d", m_name, i, m_next[i], PUSH_COUNT);
+        }
+        CHECK(m_received == PRODUCER_COUNT * PUSH_COUNT, "%s: received %d of %d", m_name, m_received, PRODUCER_COUNT * PUSH_COUNT);
+    }
+
+private:
+    const char* m_name;
+    int m_next[PRODUCER_COUNT];
+    int m_received;
+};
+
+template <typename T, typename MakeFunc, typename ConsumeFunc>
+static void RunProducers(MpscQueue<T>& queue, OrderChecker& checker, MakeFunc make, ConsumeFunc consume)
+{
+    std::atomic<bool> start(false);
+    Vector<std::thread*> producers;
+
+    for (int i = 0; i < PRODUCER_COUNT; ++i)
+    {
+        producers.Add(new std::thread([&queue, &start, &make, i]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            for (int j = 0; j < PUSH_COUNT; ++j)
+            {
+                queue.Push(make(i, j));
+            }
+        }));
+    }
+
+    start.store(true, std::memory_order_release);
+
+    T value;
+    while (!checker.Done())
+    {
+        if (queue.Pop(value))
+        {
+            consume(value);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto i : producers)
+    {
+        i->join();
+        delete i;
+    }
+
+    CHECK(!queue.Pop(value), "queue should be empty after all values are received");
+    checker.CheckAll();
+}
+
+static void TestItems()
+{
+    MpscQueue<Item> queue(QUEUE_CAPACITY);
+    OrderChecker checker("items");
+
+    RunProducers(queue, checker,
+        [](int producer, int seq) {
+            Item item;
+            item.producer = producer;
+            item.seq = seq;
+            return item;
+        },
+        [&checker](Item& item) {
+            checker.Receive(item.producer, item.seq);
+        });
+}
+
+static void TestActions()
+{
+    {
+        MpscQueue<InplaceAction> queue(QUEUE_CAPACITY);
+        OrderChecker checker("actions");
+        OrderChecker* checker_ptr = &checker;
+
+        RunProducers(queue, checker,
+            [checker_ptr](int producer, int seq) {
+                Tracker tracker;
+                return InplaceAction([checker_ptr, producer, seq, tracker]() {
+                    checker_ptr->Receive(producer, seq);
+                });
+            },
+            [](InplaceAction& action) {
+                action();
+                action = nullptr;
+            });
+    }
+
+    CHECK(Tracker::alive.load() == 0, "actions: %d captures not destroyed", Tracker::alive.load());
+}
+
+// move assigning a gate value into a ring cell blocks until gate opens,
+// so its producer holds a claimed but unwritten cell
+struct GateItem
+{
+    static std::atomic<bool> entered;
+    static std::atomic<bool> open;
+
+    int value;
+    bool gate;
+
+    GateItem(): value(0), gate(false) { }
+    GateItem(int v, bool g): value(v), gate(g) { }
+    GateItem(GateItem&& from): value(from.value), gate(from.gate) { }
+
+    GateItem& operator =(GateItem&& from)
+    {
+        if (from.gate && !open.load(std::memory_order_acquire))
+        {
+            entered.store(true, std::memory_order_release);
+            while (!open.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+        value = from.value;
+        gate = from.gate;
+        return *this;
+    }
+};
+
+std::atomic<bool> GateItem::entered(false);
+std::atomic<bool> GateItem::open(false);
+
+static void TestClaimedHead()
+{
+    MpscQueue<GateItem> queue(2);
+
+    // producer a claims cell 0 and stalls before writing it
+    std::thread producer_a([&queue]() {
+        queue.Push(GateItem(0, true));
+    });
+    while (!GateItem::entered.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    // producer b fills cell 1, then ring is full so its next value goes to overflow
+    queue.Push(GateItem(1, false));
+    queue.Push(GateItem(2, false));
+
+    GateItem item;
+    bool popped = queue.Pop(item);
+    CHECK(!popped, "claimed head: popped %d before stalled cell was written", item.value);
+
+    GateItem::open.store(true, std::memory_order_release);
+    producer_a.join();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        popped = queue.Pop(item);
+        CHECK(popped && item.value == i, "claimed head: pop %d got %d", i, popped ? item.value : -1);
+    }
+    CHECK(!queue.Pop(item), "claimed head: queue should be empty");
+}
+
+int main(int argc, char* argv[])
+{
+    TestClaimedHead();
+    TestItems();
+    TestActions();
+
+    if (g_failures > 0)
+    {
+        printf("MpscQueueTest failed: %d checks\n", g_failures);
+        return 1;
+    }
+
+    printf("MpscQueueTest passed\n");
+    return 0;
+}
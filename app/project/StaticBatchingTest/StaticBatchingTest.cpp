@@ -0,0 +1,174 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "App.h"
+#include "Engine.h"
+#include "GameObject.h"
+#include "graphics/Camera.h"
+#include "graphics/MeshRenderer.h"
+#include "graphics/StaticBatchingUtility.h"
+#include "graphics/Material.h"
+#include "graphics/Mesh.h"
+#include "graphics/RenderStats.h"
+#include "math/Quaternion.h"
+#include <backend/DriverEnums.h>
+#include <stdio.h>
+
+// checks static batching on noop driver: a batched grid of quads draws once per material
+// and fewer triangles when partly visible, exits with 1 on any mismatch.
+// needs Assets next to executable for shaders like Benchmark
+
+using namespace Viry3D;
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...) \
+    if (!(cond)) \
+    { \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        ++g_failures; \
+    }
+
+static const int GRID_SIZE = 8;
+static const int MATERIAL_COUNT = 2;
+static const int WARMUP_FRAMES = 60;
+
+static Ref<GameObject> g_grid;
+static Ref<Camera> g_camera;
+
+// quad facing up, 2 triangles
+static Ref<Mesh> CreateQuadMesh()
+{
+    Vector<Mesh::Vertex> vertices;
+    Vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+
+    const Vector2 corners[4] = { Vector2(-0.5f, -0.5f), Vector2(-0.5f, 0.5f), Vector2(0.5f, 0.5f), Vector2(0.5f, -0.5f) };
+    for (int i = 0; i < 4; ++i)
+    {
+        Mesh::Vertex vertex = { };
+        vertex.vertex = Vector4(corners[i].x, 0, corners[i].y, 1);
+        vertex.color = Color(1, 1, 1, 1);
+        vertex.uv = Vector2(corners[i].x + 0.5f, corners[i].y + 0.5f);
+        vertex.normal = Vector3(0, 1, 0);
+        vertices.Add(vertex);
+    }
+
+    return RefMake<Mesh>(std::move(vertices), std::move(indices));
+}
+
+class StaticBatchingTest : public AppImplement
+{
+public:
+    StaticBatchingTest()
+    {
+        // instancing would merge unbatched quads too
+        g_camera = GameObject::Create("camera")->AddComponent<Camera>();
+        g_camera->EnableInstancing(false);
+        g_camera->SetCullingMask(1 << 0);
+
+        Vector<Ref<Material>> materials;
+        for (int i = 0; i < MATERIAL_COUNT; ++i)
+        {
+            auto material = RefMake<Material>(Shader::Find("Diffuse"));
+            material->SetColor(MaterialProperty::COLOR, Color((float) i, 1, 1, 1));
+            materials.Add(material);
+        }
+
+        auto mesh = CreateQuadMesh();
+        g_grid = GameObject::Create("grid");
+
+        for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i)
+        {
+            auto renderer = GameObject::Create("quad")->AddComponent<MeshRenderer>();
+            renderer->GetTransform()->SetParent(g_grid->GetTransform());
+            renderer->GetTransform()->SetPosition(Vector3((i % GRID_SIZE - GRID_SIZE / 2) * 1.5f, 0, (i / GRID_SIZE - GRID_SIZE / 2) * 1.5f));
+            renderer->SetMesh(mesh);
+            renderer->SetMaterial(materials[i % MATERIAL_COUNT]);
+        }
+    }
+};
+
+namespace Viry3D
+{
+    App::App()
+    {
+        m_implement = RefMake<StaticBatchingTest>();
+    }
+
+    void App::Update()
+    {
+    }
+}
+
+// looks down on grid from height, low enough to see only part of it
+static RenderCounters DrawFrames(Engine* engine, float height, int frames)
+{
+    g_camera->GetTransform()->SetPosition(Vector3(0, height, 0));
+    g_camera->GetTransform()->SetRotation(Quaternion::Euler(90, 0, 0));
+
+    for (int i = 0; i < frames; ++i)
+    {
+        engine->Execute();
+    }
+
+    return RenderStats::GetLastFrame().draws;
+}
+
+int main(int argc, char* argv[])
+{
+    Engine::SetBackend(filament::backend::Backend::NOOP);
+    Engine* engine = Engine::Create(nullptr, 1280, 720);
+    if (engine == nullptr)
+    {
+        printf("engine create failed\n");
+        return 1;
+    }
+
+    int quad_count = GRID_SIZE * GRID_SIZE;
+
+    // async shader variants are compiled in warmup
+    RenderCounters unbatched = DrawFrames(engine, 30, WARMUP_FRAMES);
+    RenderCounters unbatched_part = DrawFrames(engine, 3, 2);
+    CHECK(unbatched.draw_calls == quad_count, "unbatched grid draws %d, expected %d", unbatched.draw_calls, quad_count);
+    CHECK(unbatched_part.draw_calls > 0 && unbatched_part.draw_calls < quad_count, "unbatched part of grid draws %d", unbatched_part.draw_calls);
+
+    StaticBatchingUtility::Combine(g_grid);
+
+    RenderCounters batched = DrawFrames(engine, 30, WARMUP_FRAMES);
+    RenderCounters batched_part = DrawFrames(engine, 3, 2);
+    CHECK(batched.draw_calls < unbatched.draw_calls, "batched grid draws %d, unbatched %d", batched.draw_calls, unbatched.draw_calls);
+    CHECK(batched.draw_calls == MATERIAL_COUNT, "batched grid draws %d, expected one per material", batched.draw_calls);
+    CHECK(batched.triangles == unbatched.triangles, "batched grid draws %lld triangles, unbatched %lld", (long long) batched.triangles, (long long) unbatched.triangles);
+
+    // only ranges of visible members are drawn
+    CHECK(batched_part.draw_calls > 0 && batched_part.draw_calls <= unbatched_part.draw_calls, "batched part of grid draws %d, unbatched %d", batched_part.draw_calls, unbatched_part.draw_calls);
+    CHECK(batched_part.triangles == unbatched_part.triangles, "batched part of grid draws %lld triangles, unbatched %lld", (long long) batched_part.triangles, (long long) unbatched_part.triangles);
+
+    g_grid.reset();
+    g_camera.reset();
+    Engine::Destroy(&engine);
+
+    if (g_failures > 0)
+    {
+        printf("StaticBatchingTest failed: %d checks\n", g_failures);
+        return 1;
+    }
+
+    printf("StaticBatchingTest passed\n");
+    return 0;
+}
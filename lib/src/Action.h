@@ -18,8 +18,118 @@
 #pragma once
 
 #include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace Viry3D
 {
     typedef std::function<void()> Action;
+
+    // move only void() callable stored inline, for queues posting across threads.
+    // fits an Action plus two pointers, larger captures fail to compile.
+    // does not allocate itself, but a wrapped Action keeps whatever its capture allocated
+    class InplaceAction
+    {
+    public:
+        static constexpr size_t CAPACITY = sizeof(Action) + 2 * sizeof(void*);
+
+        InplaceAction(): m_ops(nullptr) { }
+        InplaceAction(std::nullptr_t): m_ops(nullptr) { }
+
+        template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InplaceAction>::value>::type>
+        InplaceAction(F&& func): m_ops(nullptr)
+        {
+            typedef typename std::decay<F>::type Func;
+            static_assert(sizeof(Func) <= CAPACITY, "capture too large for InplaceAction, capture pointers or move state into a shared object");
+            static_assert(alignof(Func) <= alignof(Storage), "capture alignment too large for InplaceAction");
+
+            if (!IsNull(func))
+            {
+                new (&m_storage) Func(std::forward<F>(func));
+                m_ops = &Ops<Func>::table;
+            }
+        }
+
+        InplaceAction(InplaceAction&& from): m_ops(nullptr)
+        {
+            *this = std::move(from);
+        }
+
+        InplaceAction& operator =(InplaceAction&& from)
+        {
+            if (this != &from)
+            {
+                this->Reset();
+                if (from.m_ops)
+                {
+                    from.m_ops->move(&m_storage, &from.m_storage);
+                    m_ops = from.m_ops;
+                    from.m_ops = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        InplaceAction(const InplaceAction&) = delete;
+        InplaceAction& operator =(const InplaceAction&) = delete;
+
+        ~InplaceAction()
+        {
+            this->Reset();
+        }
+
+        void operator ()() const
+        {
+            m_ops->invoke(const_cast<Storage*>(&m_storage));
+        }
+
+        explicit operator bool() const { return m_ops != nullptr; }
+
+    private:
+        typedef typename std::aligned_storage<CAPACITY, alignof(std::max_align_t)>::type Storage;
+
+        struct OpsTable
+        {
+            void (*invoke)(void* func);
+            // move constructs into dest and destroys src
+            void (*move)(void* dest, void* src);
+            void (*destroy)(void* func);
+        };
+
+        template <typename Func>
+        struct Ops
+        {
+            static void Invoke(void* func) { (*(Func*) func)(); }
+            static void Move(void* dest, void* src)
+            {
+                new (dest) Func(std::move(*(Func*) src));
+                ((Func*) src)->~Func();
+            }
+            static void Destroy(void* func) { ((Func*) func)->~Func(); }
+
+            static const OpsTable table;
+        };
+
+        template <typename F>
+        static bool IsNull(const F&) { return false; }
+        static bool IsNull(const Action& func) { return !func; }
+
+        void Reset()
+        {
+            if (m_ops)
+            {
+                m_ops->destroy(&m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+    private:
+        Storage m_storage;
+        const OpsTable* m_ops;
+    };
+
+    template <typename Func>
+    const InplaceAction::OpsTable InplaceAction::Ops<Func>::table = { &Invoke, &Move, &Destroy };
 }
@@ -159,6 +159,7 @@ namespace Viry3D
         ImGui::ShowDemoWindow();
 
         m_imgui_window_rects.Clear();
+        m_imgui_window_rects.Add(ImGuiRenderer::DrawRenderStats());
 
         auto selected_object = m_selected_object.lock();
         if (selected_object)
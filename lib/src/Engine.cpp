@@ -31,11 +31,18 @@
 #include "graphics/Camera.h"
 #include "graphics/Light.h"
 #include "graphics/Renderer.h"
+#include "graphics/BindingCache.h"
+#include "graphics/UniformBufferPool.h"
+#include "graphics/RenderStats.h"
 #include "ui/Font.h"
 #include "audio/AudioManager.h"
 #include "time/Time.h"
+#include "math/Mathf.h"
 #include "video/VideoDecoder.h"
 #include "Editor.h"
+#include "Profiler.h"
+#include "thread/JobSystem.h"
+#include "thread/MpscQueue.h"
 #include <thread>
 
 #if VR_WINDOWS
@@ -69,12 +76,97 @@ namespace Viry3D
     {
 		Memory::Free(buffer, (int) size);
     }
+
+    // milliseconds since time, which moves to now
+    static float ElapsedMS(std::chrono::steady_clock::time_point& time)
+    {
+        auto now = std::chrono::steady_clock::now();
+        float ms = std::chrono::duration<float, std::milli>(now - time).count();
+        time = now;
+        return ms;
+    }
+
+    // driver commands recorded by one chunk of a parallel recording into its own buffer.
+    // commands move to heap between draws when buffer fills up, in blocks small enough
+    // for engine command stream to take after a flush. stream is relocatable, so commands
+    // that can't be copied to engine command stream reject the chunk instead of being recorded
+    struct CommandSegment
+    {
+        static constexpr size_t BUFFER_SIZE = 256 * 1024;
+        static constexpr size_t SPILL_SIZE = 64 * 1024;
+
+        backend::CircularBuffer buffer;
+        backend::CommandStream stream;
+        Vector<uint8_t> spilled;
+        Vector<int> spill_ends;
+        int bind_count = 0;
+        int skip_count = 0;
+
+        CommandSegment(backend::Driver& driver):
+            buffer(BUFFER_SIZE),
+            stream(driver, buffer)
+        {
+            stream.setRelocatable(true);
+        }
+
+        size_t GetRecordedSize() const
+        {
+            return (size_t) ((uint8_t*) buffer.getHead() - (uint8_t*) buffer.getTail());
+        }
+
+        void Spill()
+        {
+            int size = (int) this->GetRecordedSize();
+            if (size > 0)
+            {
+                spilled.AddRange((const uint8_t*) buffer.getTail(), size);
+                spill_ends.Add(spilled.Size());
+                buffer.circularize();
+            }
+        }
+
+        // drops recorded commands, all relocatable so none owns anything to release
+        void Discard()
+        {
+            spilled.Clear();
+            spill_ends.Clear();
+            buffer.circularize();
+            stream.resetStats();
+            stream.clearRejectedCommands();
+        }
+    };
+
+    // parallel chunks are expected to only bind, set draw ranges and draw, these must stay relocatable
+    // so they are copied by appendCommands instead of rejecting the chunk
+#define VR_COMMAND_RELOCATABLE(method) backend::CommandType<decltype(&backend::Driver::method)>::Command<&backend::Driver::method>::isRelocatable
+    static_assert(
+        VR_COMMAND_RELOCATABLE(draw) &&
+        VR_COMMAND_RELOCATABLE(setRenderPrimitiveRange) &&
+        VR_COMMAND_RELOCATABLE(bindUniformBuffer) &&
+        VR_COMMAND_RELOCATABLE(bindUniformBufferRange) &&
+        VR_COMMAND_RELOCATABLE(bindSamplers) &&
+        VR_COMMAND_RELOCATABLE(setViewportScissor),
+        "bind and draw commands must be copyable between command streams");
+#undef VR_COMMAND_RELOCATABLE
+
+    // segment current thread records to, null for engine command stream
+    static thread_local CommandSegment* g_command_segment = nullptr;
     
 	class EnginePrivate
 	{
 	public:
 		static constexpr size_t CONFIG_MIN_COMMAND_BUFFERS_SIZE			= 1 * 1024 * 1024;
-		static constexpr size_t CONFIG_COMMAND_BUFFERS_SIZE				= 3 * CONFIG_MIN_COMMAND_BUFFERS_SIZE;
+		static constexpr int ACTION_QUEUE_CAPACITY						= 4096;
+		static constexpr int MESSAGE_QUEUE_CAPACITY						= 1024;
+		static constexpr int FRAMES_IN_FLIGHT_MAX						= 3;
+		// room for every frame in flight plus the one being recorded
+		static constexpr size_t CONFIG_COMMAND_BUFFERS_SIZE				= (FRAMES_IN_FLIGHT_MAX + 1) * CONFIG_MIN_COMMAND_BUFFERS_SIZE;
+		// bounds of adaptive size between flushes, initial size is CONFIG_MIN_COMMAND_BUFFERS_SIZE
+		static constexpr size_t COMMAND_BUFFERS_SIZE_LOWER				= 256 * 1024;
+		static constexpr size_t COMMAND_BUFFERS_SIZE_MAX				= 16 * 1024 * 1024;
+		static constexpr int COMMAND_BUFFERS_SHRINK_FRAMES				= 300;
+		static constexpr int RECORD_CHUNK_ITEMS_MIN						= 64;
+		static constexpr int RECORD_CHUNK_MAX							= 16;
 
 		Engine* m_engine;
 		backend::Backend m_backend;
@@ -82,7 +174,10 @@ namespace Viry3D
 		void* m_shared_gl_context = nullptr;
 		std::thread m_driver_thread;
 		utils::CountDownLatch m_driver_barrier;
-		utils::CountDownLatch m_frame_barrier;
+		// one latch per frame slot, signaled by driver thread when frame end is executed
+		Vector<Ref<utils::CountDownLatch>> m_frame_barriers;
+		int m_frames_in_flight = 2;
+		uint32_t m_frame_id_done = 0;
 		backend::Driver* m_driver = nullptr;
 		backend::CommandBufferQueue m_command_buffer_queue;
 		backend::DriverApi m_command_stream;
@@ -98,11 +193,21 @@ namespace Viry3D
         bool m_quit = false;
         Ref<Scene> m_scene;
         Ref<ThreadPool> m_thread_pool;
-        List<Action> m_actions;
-        List<Message> m_messages;
+        Ref<JobSystem> m_job_system;
+        // posted from any thread without lock, consumed by main thread
+        MpscQueue<InplaceAction> m_actions;
+        MpscQueue<Message> m_messages;
+        Vector<InplaceAction> m_actions_process;
+        Vector<Message> m_messages_process;
         Map<int, List<MessageHandler>> m_message_handlers;
         Mutex m_mutex;
         Ref<Editor> m_editor;
+        Engine::FrameStats m_frame_stats;
+        static backend::Backend m_backend_override;
+        size_t m_command_buffer_size_max = COMMAND_BUFFERS_SIZE_MAX;
+        int m_command_buffer_light_frames = 0;
+        backend::CommandBufferQueue::Stats m_command_stats_begin;
+        Vector<Ref<CommandSegment>> m_command_segments;
         
 		EnginePrivate(Engine* engine, void* native_window, int width, int height, uint64_t flags, void* shared_gl_context):
 			m_engine(engine),
@@ -119,13 +224,24 @@ namespace Viry3D
 #endif
 			m_shared_gl_context(shared_gl_context),
 			m_driver_barrier(1),
-			m_frame_barrier(1),
 			m_command_buffer_queue(CONFIG_MIN_COMMAND_BUFFERS_SIZE, CONFIG_COMMAND_BUFFERS_SIZE),
 			m_native_window(native_window),
 			m_width(width),
 			m_height(height),
-			m_window_flags(flags)
+			m_window_flags(flags),
+			m_actions(ACTION_QUEUE_CAPACITY),
+			m_messages(MESSAGE_QUEUE_CAPACITY)
 		{
+			if (m_backend_override != backend::Backend::DEFAULT)
+			{
+				m_backend = m_backend_override;
+			}
+
+			for (int i = 0; i < FRAMES_IN_FLIGHT_MAX; ++i)
+			{
+				m_frame_barriers.Add(RefMake<utils::CountDownLatch>(1));
+			}
+
             m_editor = RefMake<Editor>();
 		}
 
@@ -143,6 +259,7 @@ namespace Viry3D
 
 		void Init()
 		{
+			Profiler::SetThreadName("main");
 			m_command_stream = backend::CommandStream(*m_driver, m_command_buffer_queue.getCircularBuffer());
 			m_swap_chain = this->GetDriverApi().createSwapChain(m_native_window, m_window_flags);
 			m_render_target = this->GetDriverApi().createDefaultRenderTarget();
@@ -152,6 +269,8 @@ namespace Viry3D
             
 #if !VR_WASM
             m_thread_pool = RefMake<ThreadPool>(4);
+            m_job_system = RefMake<JobSystem>();
+            m_job_system->Adopt();
 #endif
             
             Shader::Init();
@@ -159,6 +278,7 @@ namespace Viry3D
 			RenderTarget::Init();
 			Camera::Init();
             Material::Init();
+            UniformBufferPool::Init();
 			Mesh::Init();
 			Font::Init();
 			Resources::Init();
@@ -168,6 +288,9 @@ namespace Viry3D
 
 		void Shutdown()
 		{
+			// driver callbacks of pending frames may still reference engine objects
+			this->WaitFrames(0);
+
 			AudioManager::DestroyListener();
             m_scene.reset();
 
@@ -178,11 +301,18 @@ namespace Viry3D
 			Mesh::Done();
             Material::Done();
 			Camera::Done();
+			Light::Done();
 			RenderTarget::Done();
             Texture::Done();
             Shader::Done();
+            UniformBufferPool::Done();
             
             m_thread_pool.reset();
+            if (m_job_system)
+            {
+                m_job_system->Emancipate();
+                m_job_system.reset();
+            }
             
 			this->GetDriverApi().destroyRenderTarget(m_render_target);
 
@@ -216,6 +346,8 @@ namespace Viry3D
 				return;
 			}
 
+			Profiler::SetThreadName("driver");
+
 			while (true)
 			{
 				if (!this->Execute())
@@ -237,6 +369,8 @@ namespace Viry3D
 				return false;
 			}
 
+			PROFILE_SCOPE("Driver::Execute");
+
 			for (int i = 0; i < buffers.size(); ++i)
 			{
 				auto& item = buffers[i];
@@ -256,6 +390,194 @@ namespace Viry3D
 			m_command_buffer_queue.flush();
 		}
 
+		// split frame before recorded commands outgrow space guaranteed by last flush,
+		// reserve is size about to be appended
+		void FlushIfNeeded(size_t reserve = 0)
+		{
+			// workers spill their segment instead
+			if (g_command_segment)
+			{
+				if (g_command_segment->GetRecordedSize() >= CommandSegment::SPILL_SIZE)
+				{
+					g_command_segment->Spill();
+				}
+				return;
+			}
+
+			if (m_command_buffer_queue.getRecordedSize() + reserve >= m_command_buffer_queue.getRequiredSize() / 4 * 3)
+			{
+				this->Flush();
+				if (!UTILS_HAS_THREADING)
+				{
+					this->Execute();
+				}
+			}
+		}
+
+		int GetRecordChunkCount(int count) const
+		{
+			if (!m_job_system)
+			{
+				return 1;
+			}
+			return Mathf::Clamp(count / RECORD_CHUNK_ITEMS_MIN, 1, RECORD_CHUNK_MAX);
+		}
+
+		void RecordParallel(int count, int chunk_count, const std::function<void(int chunk, int begin, int end)>& record)
+		{
+			if (chunk_count <= 1 || !m_job_system)
+			{
+				record(0, 0, count);
+				return;
+			}
+
+			while (m_command_segments.Size() < chunk_count)
+			{
+				m_command_segments.Add(RefMake<CommandSegment>(*m_driver));
+			}
+
+			m_job_system->ParallelFor(0, chunk_count, 1, [&](int begin, int end) {
+				for (int i = begin; i < end; ++i)
+				{
+					PROFILE_SCOPE("Engine::RecordChunk");
+
+					auto& segment = *m_command_segments[i];
+
+					// driver state left by previous chunk is unknown when recording
+					BindingCache::Invalidate();
+					int bind_count = BindingCache::GetBindCount();
+					int skip_count = BindingCache::GetSkipCount();
+
+					g_command_segment = &segment;
+					segment.stream.debugThreading();
+					record(i, (int) ((int64_t) count * i / chunk_count), (int) ((int64_t) count * (i + 1) / chunk_count));
+					g_command_segment = nullptr;
+
+					segment.bind_count = BindingCache::GetBindCount() - bind_count;
+					segment.skip_count = BindingCache::GetSkipCount() - skip_count;
+					BindingCache::AddStats(-segment.bind_count, -segment.skip_count);
+				}
+			});
+
+			PROFILE_SCOPE("Engine::AppendSegments");
+			for (int i = 0; i < chunk_count; ++i)
+			{
+				auto& segment = *m_command_segments[i];
+
+				// chunk used allocate(), queueCommand() or a command with payload, which can't move
+				// between streams, so it is recorded again here straight to driver api in its place
+				if (segment.stream.hasRejectedCommands())
+				{
+					segment.Discard();
+
+					BindingCache::Invalidate();
+					record(i, (int) ((int64_t) count * i / chunk_count), (int) ((int64_t) count * (i + 1) / chunk_count));
+					BindingCache::Invalidate();
+					continue;
+				}
+
+				this->AppendSegment(segment);
+			}
+			BindingCache::Invalidate();
+		}
+
+		void AppendSegment(CommandSegment& segment)
+		{
+			const auto& stats = segment.stream.getStats();
+
+			int begin = 0;
+			for (int end : segment.spill_ends)
+			{
+				this->FlushIfNeeded((size_t) (end - begin));
+				m_command_stream.appendCommands(&segment.spilled[begin], (size_t) (end - begin));
+				begin = end;
+			}
+			segment.spilled.Clear();
+			segment.spill_ends.Clear();
+
+			size_t size = segment.GetRecordedSize();
+			if (size > 0)
+			{
+				this->FlushIfNeeded(size);
+				m_command_stream.appendCommands(segment.buffer.getTail(), size);
+				segment.buffer.circularize();
+			}
+
+			m_command_stream.addStats(stats);
+			segment.stream.resetStats();
+			BindingCache::AddStats(segment.bind_count, segment.skip_count);
+		}
+
+		void BeginCommandStats()
+		{
+			m_command_stats_begin = m_command_buffer_queue.getStats();
+			m_command_stream.resetStats();
+		}
+
+		void EndCommandStats()
+		{
+			const auto& begin = m_command_stats_begin;
+			const auto& stats = m_command_buffer_queue.getStats();
+			const auto& commands = m_command_stream.getStats();
+
+			int command_count = 0;
+			for (size_t i = 0; i < (size_t) backend::CommandId::COUNT; ++i)
+			{
+				if (i != (size_t) backend::CommandId::DATA)
+				{
+					command_count += (int) commands.count[i];
+				}
+			}
+
+			m_frame_stats.command_bytes = (int) (stats.flushedSize - begin.flushedSize);
+			m_frame_stats.command_count = command_count;
+			m_frame_stats.command_flushes = (int) (stats.flushCount - begin.flushCount);
+			m_frame_stats.command_peak_bytes = (int) stats.peakFlushSize;
+			m_frame_stats.command_in_flight_bytes = (int) stats.peakUsedSize;
+			m_frame_stats.command_stalls = (int) (stats.stallCount - begin.stallCount);
+			m_frame_stats.command_stall = (stats.stallTime - begin.stallTime) / 1000000.0f;
+		}
+
+		// call after last flush of frame, grows buffer when a flush used over half of it,
+		// shrinks after a run of frames using under an eighth
+		void UpdateCommandBufferSize()
+		{
+			size_t size = m_command_buffer_queue.getRequiredSize();
+			size_t peak = m_command_buffer_queue.getStats().peakFlushSize;
+			size_t new_size = size;
+
+			if (size > m_command_buffer_size_max)
+			{
+				new_size = m_command_buffer_size_max;
+			}
+			else if (peak > size / 2)
+			{
+				new_size = Mathf::Min(size * 2, m_command_buffer_size_max);
+				m_command_buffer_light_frames = 0;
+			}
+			else if (peak < size / 8 && size > COMMAND_BUFFERS_SIZE_LOWER)
+			{
+				if (++m_command_buffer_light_frames >= COMMAND_BUFFERS_SHRINK_FRAMES)
+				{
+					new_size = Mathf::Max(size / 2, COMMAND_BUFFERS_SIZE_LOWER);
+				}
+			}
+			else
+			{
+				m_command_buffer_light_frames = 0;
+			}
+
+			if (new_size != size)
+			{
+				m_command_buffer_light_frames = 0;
+
+				// driver thread must be done with every command before buffer is reallocated
+				this->WaitFrames(0);
+				m_command_buffer_queue.resize(new_size, (FRAMES_IN_FLIGHT_MAX + 1) * new_size);
+			}
+			m_command_buffer_queue.resetPeaks();
+		}
+
 		void BeginFrame()
 		{
             Time::Update();
@@ -272,30 +594,37 @@ namespace Viry3D
 
 		void Render()
 		{
-			Time::SetDrawCall(0);
+			PROFILE_SCOPE("Engine::Render");
+			BindingCache::ResetStats();
+			UniformBufferPool::BeginFrame();
+
+			auto time = std::chrono::steady_clock::now();
 			Renderer::PrepareAll();
+			m_frame_stats.prepare_renderers = ElapsedMS(time);
 			Light::RenderShadowMaps();
+			m_frame_stats.render_shadow_maps = ElapsedMS(time);
 			Camera::RenderAll();
+			m_frame_stats.render_cameras = ElapsedMS(time);
+
 			this->Flush();
 		}
 
 		void EndFrame()
 		{
+			PROFILE_SCOPE("Engine::EndFrame");
 			this->GetDriverApi().commit(m_swap_chain);
 			this->GetDriverApi().endFrame(m_frame_id);
 			if (UTILS_HAS_THREADING)
 			{
-				this->GetDriverApi().queueCommand([this]() {
-					m_frame_barrier.latch();
+				utils::CountDownLatch* barrier = m_frame_barriers[m_frame_id % FRAMES_IN_FLIGHT_MAX].get();
+				this->GetDriverApi().queueCommand([barrier]() {
+					barrier->latch();
 				});
 			}
 			this->Flush();
 
-			if (UTILS_HAS_THREADING)
-			{
-				m_frame_barrier.await();
-				m_frame_barrier.reset(1);
-			}
+			// main thread goes on with next frame while driver thread executes this one
+			this->WaitFrames(m_frames_in_flight - 1);
             
 #if VR_ANDROID
             if (Input::GetKeyDown(KeyCode::Backspace))
@@ -309,6 +638,30 @@ namespace Viry3D
             Input::Update();
 		}
         
+		// block until no more than pending_count submitted frames are not executed by driver thread
+		void WaitFrames(int pending_count)
+		{
+			if (!UTILS_HAS_THREADING)
+			{
+				return;
+			}
+
+			PROFILE_SCOPE("Engine::WaitFrames");
+			while (m_frame_id - m_frame_id_done > (uint32_t) pending_count)
+			{
+				++m_frame_id_done;
+
+				auto& barrier = m_frame_barriers[m_frame_id_done % FRAMES_IN_FLIGHT_MAX];
+				barrier->await();
+				barrier->reset(1);
+			}
+		}
+
+		void SetFramesInFlight(int count)
+		{
+			m_frames_in_flight = Mathf::Clamp(count, 1, FRAMES_IN_FLIGHT_MAX);
+		}
+
         void Quit()
         {
             m_quit = true;
@@ -318,34 +671,35 @@ namespace Viry3D
 #endif
         }
 
-        void PostAction(Action action)
+        void PostAction(InplaceAction action)
         {
-            m_mutex.lock();
-            m_actions.AddLast(action);
-            m_mutex.unlock();
+            m_actions.Push(std::move(action));
         }
         
         void ProcessActions()
         {
-            List<Action> actions;
-            List<Message> messages;
-            
-            m_mutex.lock();
-            actions = m_actions;
-            m_actions.Clear();
-            messages = m_messages;
-            m_messages.Clear();
-            m_mutex.unlock();
+            // take what is queued now, anything posted while processing runs next frame
+            InplaceAction action;
+            while (m_actions.Pop(action))
+            {
+                m_actions_process.Add(std::move(action));
+            }
+            Message message;
+            while (m_messages.Pop(message))
+            {
+                m_messages_process.Add(std::move(message));
+            }
             
-            for (const auto& action : actions)
+            for (const auto& action : m_actions_process)
             {
                 if (action)
                 {
                     action();
                 }
             }
+            m_actions_process.Clear();
             
-            for (const auto& msg : messages)
+            for (const auto& msg : m_messages_process)
             {
                 if (m_message_handlers.Contains(msg.id))
                 {
@@ -359,13 +713,12 @@ namespace Viry3D
                     }
                 }
             }
+            m_messages_process.Clear();
         }
         
         void SendMessage(int id, const String& msg)
         {
-            m_mutex.lock();
-            m_messages.AddLast({ id, msg });
-            m_mutex.unlock();
+            m_messages.Push({ id, msg });
         }
         
         void AddMessageHandler(int id, std::function<void(int id, const String&)> handler)
@@ -535,6 +888,12 @@ namespace Viry3D
 	};
 
 	Engine* Engine::m_instance = nullptr;
+	backend::Backend EnginePrivate::m_backend_override = backend::Backend::DEFAULT;
+
+	void Engine::SetBackend(backend::Backend backend)
+	{
+		EnginePrivate::m_backend_override = backend;
+	}
 
 	Engine* Engine::Create(void* native_window, int width, int height, uint64_t flags, void* shared_gl_context)
 	{
@@ -602,26 +961,42 @@ namespace Viry3D
 
 	void Engine::Execute()
 	{
+        PROFILE_SCOPE("Engine::Execute");
+        auto frame_time = std::chrono::steady_clock::now();
+        auto time = frame_time;
+        m_private->BeginCommandStats();
+        RenderStats::BeginFrame();
+
         if (!m_private->m_scene)
         {
             m_private->m_scene = RefMake<Scene>();
         }
         m_private->m_scene->Update();
         m_private->m_editor->Update();
+        m_private->m_frame_stats.scene_update = ElapsedMS(time);
 
 		m_private->BeginFrame();
 		m_private->Render();
 		m_private->EndFrame();
+		RenderStats::EndFrame();
 
 		if (!UTILS_HAS_THREADING)
 		{
 			m_private->Flush();
 			m_private->Execute();
 		}
+
+        m_private->EndCommandStats();
+        m_private->UpdateCommandBufferSize();
+        m_private->m_frame_stats.frame = ElapsedMS(frame_time);
 	}
 
 	backend::DriverApi& Engine::GetDriverApi()
 	{
+		if (g_command_segment)
+		{
+			return g_command_segment->stream;
+		}
 		return m_private->GetDriverApi();
 	}
 
@@ -682,14 +1057,29 @@ namespace Viry3D
         return m_private->m_quit;
     }
 
+    int Engine::GetFramesInFlight() const
+    {
+        return m_private->m_frames_in_flight;
+    }
+
+    void Engine::SetFramesInFlight(int count)
+    {
+        m_private->SetFramesInFlight(count);
+    }
+
     ThreadPool* Engine::GetThreadPool() const
     {
         return m_private->m_thread_pool.get();
     }
     
-    void Engine::PostAction(Action action)
+    JobSystem* Engine::GetJobSystem() const
+    {
+        return m_private->m_job_system.get();
+    }
+
+    void Engine::PostAction(InplaceAction action)
     {
-        m_private->PostAction(action);
+        m_private->PostAction(std::move(action));
     }
     
     void Engine::SendMessage(int id, const String& msg)
@@ -706,4 +1096,57 @@ namespace Viry3D
     {
         return m_private->m_editor;
     }
+
+    const Engine::FrameStats& Engine::GetFrameStats() const
+    {
+        return m_private->m_frame_stats;
+    }
+
+    void Engine::GetCommandStats(Vector<CommandStats>& stats) const
+    {
+        const auto& commands = m_private->m_command_stream.getStats();
+
+        stats.Clear();
+        for (size_t i = 0; i < (size_t) backend::CommandId::COUNT; ++i)
+        {
+            if (commands.count[i] > 0)
+            {
+                CommandStats item;
+                item.name = backend::CommandStream::getCommandName((backend::CommandId) i);
+                item.count = (int) commands.count[i];
+                item.bytes = (int) commands.size[i];
+                stats.Add(item);
+            }
+        }
+    }
+
+    int Engine::GetCommandBufferSize() const
+    {
+        return (int) m_private->m_command_buffer_queue.getRequiredSize();
+    }
+
+    int Engine::GetCommandBufferSizeMax() const
+    {
+        return (int) m_private->m_command_buffer_size_max;
+    }
+
+    void Engine::SetCommandBufferSizeMax(int size)
+    {
+        m_private->m_command_buffer_size_max = Mathf::Max((size_t) size, EnginePrivate::COMMAND_BUFFERS_SIZE_LOWER);
+    }
+
+    void Engine::FlushCommandsIfNeeded()
+    {
+        m_private->FlushIfNeeded();
+    }
+
+    int Engine::GetRecordChunkCount(int count) const
+    {
+        return m_private->GetRecordChunkCount(count);
+    }
+
+    void Engine::RecordParallel(int count, int chunk_count, const std::function<void(int chunk, int begin, int end)>& record)
+    {
+        m_private->RecordParallel(count, chunk_count, record);
+    }
 }
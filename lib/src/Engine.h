@@ -40,10 +40,41 @@ namespace Viry3D
 {
 	class EnginePrivate;
     class Editor;
+    class JobSystem;
 
     class Engine
     {
 	public:
+        // main thread cpu time in milliseconds of phases in last Execute,
+        // with usage of driver command buffer by it
+        struct FrameStats
+        {
+            float scene_update = 0;
+            float prepare_renderers = 0;
+            float render_shadow_maps = 0;
+            float render_cameras = 0;
+            float frame = 0;
+            int command_bytes = 0;
+            int command_count = 0;
+            int command_flushes = 0;
+            // largest single flush, and most bytes not yet executed by driver thread
+            int command_peak_bytes = 0;
+            int command_in_flight_bytes = 0;
+            // flushes waiting for driver thread to free buffer space, and milliseconds waited
+            int command_stalls = 0;
+            float command_stall = 0;
+        };
+
+        // driver commands of one type recorded in last Execute
+        struct CommandStats
+        {
+            const char* name;
+            int count;
+            int bytes;
+        };
+
+        // backend of engines created after, NOOP runs without window and gpu
+        static void SetBackend(filament::backend::Backend backend);
 		static Engine* Create(void* native_window, int width, int height, uint64_t flags = 0, void* shared_gl_context = nullptr);
 		static void Destroy(Engine** engine);
 		static Engine* Instance();
@@ -62,11 +93,40 @@ namespace Viry3D
 		int GetWidth() const;
 		int GetHeight() const;
         bool HasQuit() const;
+        // frames submitted to driver thread that main thread may run ahead of, in 1 to 3,
+        // 1 waits for driver thread to finish each frame before next one starts
+        int GetFramesInFlight() const;
+        void SetFramesInFlight(int count);
+        // for blocking async tasks, completion callbacks run on main thread
         ThreadPool* GetThreadPool() const;
-        void PostAction(Action action);
+        // for parallel work within a frame, null on web
+        JobSystem* GetJobSystem() const;
+        // action runs on main thread next ProcessActions, lambda captures must fit InplaceAction,
+        // Action callers such as Task dispatch still pay for their std::function capture
+        void PostAction(InplaceAction action);
         void SendMessage(int id, const String& msg);
         void AddMessageHandler(int id, std::function<void(int id, const String&)> handler);
         const Ref<Editor>& GetEditor() const;
+        const FrameStats& GetFrameStats() const;
+        // types not recorded are skipped
+        void GetCommandStats(Vector<CommandStats>& stats) const;
+        // bytes of driver commands recorded between two flushes, doubles after a heavy frame
+        // up to max and halves after a long run of light frames
+        int GetCommandBufferSize() const;
+        int GetCommandBufferSizeMax() const;
+        void SetCommandBufferSizeMax(int size);
+        // flush recorded driver commands if near buffer size, so heavy frames are split,
+        // call between draws when no allocated command data waits for its command
+        void FlushCommandsIfNeeded();
+        // chunks a list of count draws is recorded in, 1 without job system or with few draws
+        int GetRecordChunkCount(int count) const;
+        // record count items split evenly into chunks on job system, each chunk into its own
+        // command segment appended to driver api in chunk order, so commands do not depend on
+        // thread scheduling. record should only bind and draw, a chunk using DriverApi::allocate,
+        // queueCommand or commands with payload is discarded and recorded again on calling thread,
+        // so record must tolerate running twice for a chunk. binding cache is empty in each chunk and after.
+        // 1 chunk records on calling thread straight to driver api
+        void RecordParallel(int count, int chunk_count, const std::function<void(int chunk, int begin, int end)>& record);
         
 	private:
 		Engine(void* native_window, int width, int height, uint64_t flags, void* shared_gl_context);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "string/String.h"
+#include <atomic>
 
 namespace Viry3D
 {
@@ -26,7 +27,8 @@ namespace Viry3D
     public:
         Object()
         {
-            static uint32_t s_id = 0;
+            // objects like images are also created on worker threads
+            static std::atomic<uint32_t> s_id(0);
             m_id = ++s_id;
         }
         virtual ~Object() { }
@@ -0,0 +1,242 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Profiler.h"
+#include "io/File.h"
+#include "container/Vector.h"
+#include "memory/Ref.h"
+#include "math/Mathf.h"
+#include "thread/ThreadPool.h"
+#include <chrono>
+#include <string>
+#include <stdio.h>
+
+namespace Viry3D
+{
+    struct ProfileEvent
+    {
+        const char* name;
+        int64_t begin;
+        int64_t end;
+    };
+
+    // written by owner thread only, events are allocated on first write.
+    // recycled by next new thread after owner exits
+    struct ProfileThreadBuffer
+    {
+        static constexpr int CAPACITY = 16384;
+
+        ProfileEvent* events = nullptr;
+        std::atomic<uint64_t> write_count;
+        int id = 0;
+        String name;
+        Mutex name_mutex;
+
+        ProfileThreadBuffer():
+            write_count(0)
+        {
+        }
+
+        ~ProfileThreadBuffer()
+        {
+            delete[] events;
+        }
+    };
+
+    std::atomic<bool> Profiler::m_enable(false);
+    static Vector<Ref<ProfileThreadBuffer>> g_thread_buffers;
+    static Vector<ProfileThreadBuffer*> g_free_thread_buffers;
+    static Mutex g_thread_buffers_mutex;
+
+    // returns buffer to free list on thread exit, so short lived threads don't grow buffers
+    struct ProfileThreadBufferOwner
+    {
+        ProfileThreadBuffer* buffer = nullptr;
+
+        ~ProfileThreadBufferOwner()
+        {
+            if (buffer)
+            {
+                std::lock_guard<Mutex> lock(g_thread_buffers_mutex);
+                g_free_thread_buffers.Add(buffer);
+            }
+        }
+    };
+
+    static thread_local ProfileThreadBufferOwner g_thread_buffer;
+
+    static ProfileThreadBuffer* GetThreadBuffer()
+    {
+        if (g_thread_buffer.buffer == nullptr)
+        {
+            std::lock_guard<Mutex> lock(g_thread_buffers_mutex);
+
+            if (g_free_thread_buffers.Size() > 0)
+            {
+                // events of exited thread stay in ring under same tid until overwritten,
+                // write count keeps growing so dump needs no change
+                int last = g_free_thread_buffers.Size() - 1;
+                ProfileThreadBuffer* buffer = g_free_thread_buffers[last];
+                g_free_thread_buffers.Remove(last);
+
+                std::lock_guard<Mutex> name_lock(buffer->name_mutex);
+                buffer->name = String();
+                g_thread_buffer.buffer = buffer;
+            }
+            else
+            {
+                auto buffer = RefMake<ProfileThreadBuffer>();
+                buffer->id = g_thread_buffers.Size() + 1;
+                g_thread_buffers.Add(buffer);
+                g_thread_buffer.buffer = buffer.get();
+            }
+        }
+        return g_thread_buffer.buffer;
+    }
+
+    void Profiler::SetEnable(bool enable)
+    {
+        m_enable.store(enable, std::memory_order_relaxed);
+    }
+
+    int64_t Profiler::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Profiler::AddEvent(const char* name, int64_t begin, int64_t end)
+    {
+        ProfileThreadBuffer* buffer = GetThreadBuffer();
+        if (buffer->events == nullptr)
+        {
+            buffer->events = new ProfileEvent[ProfileThreadBuffer::CAPACITY];
+        }
+
+        uint64_t index = buffer->write_count.load(std::memory_order_relaxed);
+        ProfileEvent& event = buffer->events[index & (ProfileThreadBuffer::CAPACITY - 1)];
+        event.name = name;
+        event.begin = begin;
+        event.end = end;
+
+        // publishes event to dump
+        buffer->write_count.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetThreadName(const String& name)
+    {
+        ProfileThreadBuffer* buffer = GetThreadBuffer();
+
+        std::lock_guard<Mutex> lock(buffer->name_mutex);
+        buffer->name = name;
+    }
+
+    static void AppendEscaped(std::string& json, const char* str)
+    {
+        for (const char* c = str; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                json += '\\';
+                json += *c;
+            }
+            else if ((unsigned char) *c >= 0x20)
+            {
+                json += *c;
+            }
+        }
+    }
+
+    String Profiler::DumpChromeTrace()
+    {
+        Vector<Ref<ProfileThreadBuffer>> buffers;
+        {
+            std::lock_guard<Mutex> lock(g_thread_buffers_mutex);
+            buffers = g_thread_buffers;
+        }
+
+        std::string json = "{\"traceEvents\":[";
+        bool first = true;
+        char text[256];
+
+        for (const auto& buffer : buffers)
+        {
+            {
+                std::lock_guard<Mutex> lock(buffer->name_mutex);
+                String name = buffer->name.Empty() ? String::Format("thread %d", buffer->id) : buffer->name;
+
+                snprintf(text, sizeof(text), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", first ? "" : ",", buffer->id);
+                json += text;
+                AppendEscaped(json, name.CString());
+                json += "\"}}";
+                first = false;
+            }
+
+            uint64_t end = buffer->write_count.load(std::memory_order_acquire);
+            if (end == 0)
+            {
+                continue;
+            }
+            uint64_t copy_begin = end > ProfileThreadBuffer::CAPACITY ? end - ProfileThreadBuffer::CAPACITY : 0;
+            uint64_t begin = copy_begin;
+
+            Vector<ProfileEvent> events((int) (end - copy_begin));
+            for (uint64_t i = copy_begin; i < end; ++i)
+            {
+                events[(int) (i - copy_begin)] = buffer->events[i & (ProfileThreadBuffer::CAPACITY - 1)];
+            }
+
+            // events the owner thread wrapped around while copying are dropped, including
+            // the slot of event written next, which may have been copied half written
+            uint64_t written = buffer->write_count.load(std::memory_order_acquire);
+            if (written >= ProfileThreadBuffer::CAPACITY && written - ProfileThreadBuffer::CAPACITY + 1 > begin)
+            {
+                begin = Mathf::Min<uint64_t>(written - ProfileThreadBuffer::CAPACITY + 1, end);
+            }
+
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                const auto& event = events[(int) (i - copy_begin)];
+
+                snprintf(text, sizeof(text), ",{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"",
+                    buffer->id,
+                    event.begin / 1000.0,
+                    (event.end - event.begin) / 1000.0);
+                json += text;
+                AppendEscaped(json, event.name);
+                json += "\"}";
+            }
+        }
+
+        json += "],\"displayTimeUnit\":\"ms\"}";
+
+        return String(json.c_str());
+    }
+
+    bool Profiler::DumpChromeTrace(const String& path)
+    {
+        return File::WriteAllText(path, DumpChromeTrace());
+    }
+
+    void Profiler::Clear()
+    {
+        std::lock_guard<Mutex> lock(g_thread_buffers_mutex);
+        for (auto& i : g_thread_buffers)
+        {
+            i->write_count.store(0, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "string/String.h"
+#include <atomic>
+#include <stdint.h>
+
+// set to 0 to compile scopes out entirely
+#ifndef VR_PROFILER
+#define VR_PROFILER 1
+#endif
+
+namespace Viry3D
+{
+    // scoped cpu timeline of all threads, dumped as chrome trace json for chrome://tracing or perfetto.
+    // each thread writes finished scopes into its own ring buffer without locks, oldest events
+    // are overwritten when it is full, buffers of exited threads are reused by new threads.
+    // disabled by default, a scope then costs one relaxed load
+    class Profiler
+    {
+    public:
+        static bool IsEnable() { return m_enable.load(std::memory_order_relaxed); }
+        static void SetEnable(bool enable);
+        // nanoseconds of steady clock
+        static int64_t Now();
+        // name must outlive the dump, string literals do
+        static void AddEvent(const char* name, int64_t begin, int64_t end);
+        // shown in trace for current thread
+        static void SetThreadName(const String& name);
+        // may be called while other threads record, events overwritten meanwhile are dropped
+        static String DumpChromeTrace();
+        static bool DumpChromeTrace(const String& path);
+        // forget recorded events, other threads must not record meanwhile
+        static void Clear();
+
+    private:
+        static std::atomic<bool> m_enable;
+    };
+
+    class ProfileScope
+    {
+    public:
+        ProfileScope(const char* name):
+            m_name(nullptr)
+        {
+            if (Profiler::IsEnable())
+            {
+                m_name = name;
+                m_begin = Profiler::Now();
+            }
+        }
+
+        ~ProfileScope()
+        {
+            if (m_name)
+            {
+                Profiler::AddEvent(m_name, m_begin, Profiler::Now());
+            }
+        }
+
+    private:
+        const char* m_name;
+        int64_t m_begin;
+    };
+}
+
+#if VR_PROFILER
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) Viry3D::ProfileScope PROFILE_SCOPE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
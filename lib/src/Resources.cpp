@@ -21,6 +21,7 @@
 #include "io/MemoryStream.h"
 #include "graphics/MeshRenderer.h"
 #include "graphics/SkinnedMeshRenderer.h"
+#include "graphics/StaticBatchingUtility.h"
 #include "graphics/Mesh.h"
 #include "graphics/Material.h"
 #include "graphics/Shader.h"
@@ -31,6 +32,7 @@
 #include "physics/SpringBone.h"
 #include "physics/SpringCollider.h"
 #include "physics/SpringManager.h"
+#include "thread/Future.h"
 
 #if VR_WASM
 #include <emscripten.h>
@@ -208,6 +210,26 @@ namespace Viry3D
         return texture;
     }
     
+    struct TextureImages
+    {
+        TextureInfo info;
+        // one image for 2d texture, 6 faces per mip level for cubemap
+        Vector<Ref<Image>> images;
+    };
+
+    static Ref<Image> ReadImage(const String& path)
+    {
+        Ref<Image> image;
+
+        String full_path = Engine::Instance()->GetDataPath() + "/" + path;
+        if (File::Exist(full_path))
+        {
+            image = Image::LoadFromMemory(File::ReadAllBytes(full_path));
+        }
+
+        return image;
+    }
+
     static void ReadTextureAsync(const String& path, std::function<void(const Ref<Texture>&)> complete)
     {
         if (g_cache.Contains(path))
@@ -219,103 +241,81 @@ namespace Viry3D
             return;
         }
         
-        auto on_success = [=](const Ref<Texture>& texture) {
-            g_cache.Add(path, texture);
-            
-            if (complete)
-            {
-                complete(texture);
-            }
-        };
-        
-        auto on_failed = [=]() {
-            if (complete)
+        // read and decode on worker, upload on main thread
+        Task::Run([=]() {
+            TextureImages result;
+
+            String full_path = Engine::Instance()->GetDataPath() + "/" + path;
+            if (File::Exist(full_path))
             {
-                complete(Ref<Texture>());
+                result.info = ParseTextureInfo(File::ReadAllText(full_path));
+
+                if (result.info.texture_type == "Texture2D")
+                {
+                    result.images.Add(ReadImage(result.info.png_path));
+                }
+                else if (result.info.texture_type == "Cubemap")
+                {
+                    for (int i = 0; i < result.info.cube_faces.Size(); ++i)
+                    {
+                        for (int j = 0; j < result.info.cube_faces[i].Size(); ++j)
+                        {
+                            result.images.Add(ReadImage(result.info.cube_faces[i][j]));
+                        }
+                    }
+                }
             }
-        };
-        
-        auto on_load_json = [=](const ByteBuffer& json_buffer) {
-            String json = String(json_buffer);
-            TextureInfo info = ParseTextureInfo(json);
-            
+
+            return result;
+        }).Then([=](const TextureImages& result) {
+            const auto& info = result.info;
+            Ref<Texture> texture;
+
             if (info.texture_type == "Texture2D")
             {
-                String png_path = Engine::Instance()->GetDataPath() + "/" + info.png_path;
-                Resources::LoadFileAsync(png_path, [=](const ByteBuffer& image_buffer) {
-                    if (image_buffer.Size() > 0)
-                    {
-                        auto texture = Texture::LoadTexture2DFromMemory(image_buffer, info.filter_mode, info.wrap_mode, info.mipmap_count > 1);
-                        texture->SetName(info.name);
-                        
-                        on_success(texture);
-                    }
-                    else
-                    {
-                        on_failed();
-                    }
-                });
+                texture = Texture::CreateTexture2DFromImage(result.images[0], info.filter_mode, info.wrap_mode, info.mipmap_count > 1);
             }
             else if (info.texture_type == "Cubemap")
             {
-                Vector<String> image_paths;
-                for (int i = 0; i < info.cube_faces.Size(); ++i)
+                texture = Texture::CreateCubemap(info.width, TextureFormat::R8G8B8A8, info.filter_mode, info.wrap_mode, info.mipmap_count > 1);
+
+                for (int i = 0; i < info.mipmap_count; ++i)
                 {
-                    for (int j = 0; j < info.cube_faces[i].Size(); ++j)
-                    {
-                        image_paths.Add(info.cube_faces[i][j]);
-                    }
-                }
-                
-                Resources::LoadFilesAsync(image_paths, [=](const Vector<ByteBuffer>& image_buffers) {
-                    for (int i = 0; i < image_buffers.Size(); ++i)
-                    {
-                        if (image_buffers.Size() == 0)
-                        {
-                            on_failed();
-                            return;
-                        }
-                    }
-                    
-                    auto texture = Texture::CreateCubemap(info.width, TextureFormat::R8G8B8A8, info.filter_mode, info.wrap_mode, info.mipmap_count > 1);
-                    
-                    for (int i = 0; i < info.mipmap_count; ++i)
+                    ByteBuffer buffer;
+                    Vector<int> offsets(6);
+
+                    for (int j = 0; j < 6 && i * 6 + j < result.images.Size(); ++j)
                     {
-                        ByteBuffer buffer;
-                        Vector<int> offsets(6);
-                        
-                        for (int j = 0; j < 6; ++j)
+                        const auto& image = result.images[i * 6 + j];
+                        if (image)
                         {
-                            const auto& image_buffer = image_buffers[i * 6 + j];
-
-                            Ref<Image> image = Image::LoadFromMemory(image_buffer);
-                            if (image)
+                            if (buffer.Size() == 0)
                             {
-                                if (buffer.Size() == 0)
-                                {
-                                    buffer = ByteBuffer(image->data.Size() * 6);
-                                }
-                                Memory::Copy(&buffer[j * image->data.Size()], image->data.Bytes(), image->data.Size());
-                                offsets[j] = j * image->data.Size();
+                                buffer = ByteBuffer(image->data.Size() * 6);
                             }
-                        }
-                        
-                        if (buffer.Size() > 0)
-                        {
-                            texture->UpdateCubemap(buffer, i, offsets);
+                            Memory::Copy(&buffer[j * image->data.Size()], image->data.Bytes(), image->data.Size());
+                            offsets[j] = j * image->data.Size();
                         }
                     }
-                    
-                    on_success(texture);
-                });
+
+                    if (buffer.Size() > 0)
+                    {
+                        texture->UpdateCubemap(buffer, i, offsets);
+                    }
+                }
             }
-            else
+
+            if (texture)
             {
-                on_failed();
+                texture->SetName(info.name);
+                g_cache.Add(path, texture);
             }
-        };
-        
-        Resources::LoadFileAsync(path, on_load_json);
+
+            if (complete)
+            {
+                complete(texture);
+            }
+        }, TaskContext::MainThread);
     }
 
     static Ref<Material> ReadMaterial(const String& path)
@@ -691,7 +691,7 @@ namespace Viry3D
         return obj;
     }
 
-    Ref<GameObject> Resources::LoadGameObject(const String& path)
+    Ref<GameObject> Resources::LoadGameObject(const String& path, bool static_batching)
     {
 		Ref<GameObject> obj;
 
@@ -701,6 +701,11 @@ namespace Viry3D
             MemoryStream ms(File::ReadAllBytes(full_path));
 
 			obj = ReadGameObject(ms, Ref<GameObject>());
+
+            if (static_batching)
+            {
+                StaticBatchingUtility::Combine(obj);
+            }
         }
 
         return obj;
@@ -739,25 +744,19 @@ namespace Viry3D
     
     void Resources::LoadFilesAsync(const Vector<String>& paths, std::function<void(const Vector<ByteBuffer>&)> complete)
     {
-        Thread::Task task;
-        task.job = [=]() {
-            auto ptr = new Vector<ByteBuffer>(paths.Size());
+        Task::Run([=]() {
+            Vector<ByteBuffer> buffers(paths.Size());
             for (int i = 0; i < paths.Size(); ++i)
             {
-                (*ptr)[i] = File::ReadAllBytes(Engine::Instance()->GetDataPath() + "/" + paths[i]);
+                buffers[i] = File::ReadAllBytes(Engine::Instance()->GetDataPath() + "/" + paths[i]);
             }
-            return ptr;
-        };
-        task.complete = [=](void* result) {
-            auto ptr = (Vector<ByteBuffer>*) result;
+            return buffers;
+        }).Then([=](const Vector<ByteBuffer>& buffers) {
             if (complete)
             {
-                complete(*ptr);
+                complete(buffers);
             }
-            delete ptr;
-        };
-        
-        Engine::Instance()->GetThreadPool()->AddTask(task);
+        }, TaskContext::MainThread);
     }
 
 	void Resources::LoadTextureAsync(const String& path, std::function<void(const Ref<Texture>&)> complete)
@@ -31,7 +31,8 @@ namespace Viry3D
     public:
 		static void Init();
 		static void Done();
-        static Ref<GameObject> LoadGameObject(const String& path);
+        // static batching combines meshes of all mesh renderers in loaded hierarchy, they must not move
+        static Ref<GameObject> LoadGameObject(const String& path, bool static_batching = false);
 		static Ref<Mesh> LoadMesh(const String& path);
         static Ref<Texture> LoadTexture(const String& path);
 
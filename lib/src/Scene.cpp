@@ -18,6 +18,7 @@
 #include "Scene.h"
 #include "GameObject.h"
 #include "App.h"
+#include "Profiler.h"
 
 namespace Viry3D
 {
@@ -59,6 +60,8 @@ namespace Viry3D
     
     void Scene::Update()
     {
+		PROFILE_SCOPE("Scene::Update");
+
 		for (auto& i : m_objects)
 		{
 			auto& obj = i.second;
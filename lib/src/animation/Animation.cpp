@@ -21,6 +21,7 @@
 #include "math/Mathf.h"
 #include "graphics/SkinnedMeshRenderer.h"
 #include "Debug.h"
+#include "Profiler.h"
 
 namespace Viry3D
 {
@@ -175,6 +176,8 @@ namespace Viry3D
 
     void Animation::Update()
     {
+        PROFILE_SCOPE("Animation::Update");
+
         this->UpdateTime();
 
         bool first_state = true;
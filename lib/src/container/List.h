@@ -30,6 +30,7 @@ namespace Viry3D
 
 		void AddFirst(const V& v);
 		void AddLast(const V& v);
+		void AddLast(V&& v);
 		V& First();
 		const V& First() const;
 		V& Last();
@@ -94,6 +95,12 @@ namespace Viry3D
 		m_list.push_back(v);
 	}
 
+	template<class V>
+	void List<V>::AddLast(V&& v)
+	{
+		m_list.push_back(std::move(v));
+	}
+
 	template<class V>
 	void List<V>::RemoveFirst()
 	{
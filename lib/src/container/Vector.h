@@ -34,6 +34,7 @@ namespace Viry3D
         Vector(Vector&& from);
 
 		void Add(const V& v);
+		void Add(V&& v);
 		void AddRange(const V* vs, int count);
         void AddRange(std::initializer_list<V> list);
         void AddRange(const Vector<V>& vs);
@@ -103,6 +104,12 @@ namespace Viry3D
 		m_vector.push_back(v);
 	}
 
+	template<class V>
+	void Vector<V>::Add(V&& v)
+	{
+		m_vector.push_back(std::move(v));
+	}
+
 	template<class V>
 	void Vector<V>::AddRange(const V* vs, int count)
 	{
@@ -45,8 +45,8 @@ static constexpr uint64_t SWAP_CHAIN_CONFIG_READABLE = 0x2;
 static constexpr size_t MAX_VERTEX_ATTRIBUTE_COUNT = 8; // FIXME: what should this be?
 static constexpr size_t MAX_SAMPLER_COUNT = 16;         // Matches the Adreno Vulkan driver.
 
-static constexpr size_t CONFIG_UNIFORM_BINDING_COUNT = 7;
-static constexpr size_t CONFIG_SAMPLER_BINDING_COUNT = CONFIG_UNIFORM_BINDING_COUNT;
+static constexpr size_t CONFIG_UNIFORM_BINDING_COUNT = 10;  // last 3 are uniform only cluster light and instance buffers
+static constexpr size_t CONFIG_SAMPLER_BINDING_COUNT = 7;
 
 /**
  * Selects which driver a particular Engine should use.
@@ -67,15 +67,19 @@ public:
     // call at least once every getRequiredSize() bytes allocated from the buffer
     void circularize() noexcept;
 
+    // reallocates the buffer, previous contents are discarded.
+    // the caller must make sure no reader still references the old memory.
+    void resize(size_t bufferSize) noexcept;
+
 private:
     void* alloc(size_t size) noexcept;
     void dealloc() noexcept;
 
-    // pointer to the beginning of the circular buffer (constant)
+    // pointer to the beginning of the circular buffer (constant until resize)
     void* mData = nullptr;
     int mUsesAshmem = -1;
 
-    // size of the circular buffer (constant)
+    // size of the circular buffer (constant until resize)
     size_t mSize = 0;
 
     // pointer to the beginning of recorded data
@@ -37,7 +37,21 @@ class CommandBufferQueue {
         void* end;
     };
 
-    const size_t mRequiredSize;
+public:
+    struct Stats {
+        // bytes of commands flushed since creation
+        uint64_t flushedSize = 0;
+        uint32_t flushCount = 0;
+        // flushes that had to wait for the consumer to free space, and nanoseconds waited
+        uint32_t stallCount = 0;
+        uint64_t stallTime = 0;
+        // largest single flush and most bytes in flight, since resetPeaks()
+        size_t peakFlushSize = 0;
+        size_t peakUsedSize = 0;
+    };
+
+private:
+    size_t mRequiredSize;
 
     CircularBuffer mCircularBuffer;
 
@@ -47,7 +61,7 @@ class CommandBufferQueue {
     mutable utils::Condition mCondition;
     mutable std::vector<Slice> mCommandBuffersToExecute;
     size_t mFreeSpace = 0;
-    size_t mHighWatermark = 0;
+    Stats mStats;
     bool mExitRequested = false;
 
 public:
@@ -57,7 +71,22 @@ public:
 
     CircularBuffer& getCircularBuffer() { return mCircularBuffer; }
 
-    size_t getHigWatermark() noexcept { return mHighWatermark; }
+    size_t getHigWatermark() noexcept { return mStats.peakUsedSize; }
+
+    size_t getRequiredSize() const noexcept { return mRequiredSize; }
+
+    // bytes of commands recorded since the last flush()
+    size_t getRecordedSize() const noexcept {
+        return size_t(intptr_t(mCircularBuffer.getHead()) - intptr_t(mCircularBuffer.getTail()));
+    }
+
+    // only meaningful on the producer thread
+    Stats const& getStats() const noexcept { return mStats; }
+    void resetPeaks() noexcept;
+
+    // reallocates the circular buffer with new sizes, must be called from the producer thread
+    // right after flush(). blocks until the consumer has released every buffer.
+    void resize(size_t requiredSize, size_t bufferSize);
 
     // wait for commands to be available and returns an array containing these commands
     std::vector<Slice> waitForCommands() const;
@@ -128,6 +128,13 @@ constexpr void apply(M&& m, D&& d, T&& t) {
  * We won't call through that pointer though.
  */
 template<typename... ARGS>
+struct AllTriviallyDestructible : std::true_type { };
+
+template<typename FIRST, typename... REMAINING>
+struct AllTriviallyDestructible<FIRST, REMAINING...> : std::integral_constant<bool,
+        std::is_trivially_destructible<FIRST>::value && AllTriviallyDestructible<REMAINING...>::value> { };
+
+template<typename... ARGS>
 struct CommandType;
 
 template<typename... ARGS>
@@ -145,6 +152,15 @@ struct CommandType<void (Driver::*)(ARGS...)> {
         using SavedParameters = std::tuple<typename std::decay<ARGS>::type...>;
         SavedParameters mArgs;
 
+    public:
+        // a command whose parameters have trivial destructors owns nothing (no BufferDescriptor,
+        // no lambda) and can be moved to another stream by copying its bytes, see appendCommands().
+        // std::tuple<> and Handle<> (its move clears the source) are never trivially copyable,
+        // but both are plain bytes once their parameters are
+        static constexpr bool isRelocatable =
+                AllTriviallyDestructible<typename std::decay<ARGS>::type...>::value;
+
+    private:
         void log() noexcept;
         template<std::size_t... I> void log(std::index_sequence<I...>) noexcept;
 
@@ -232,13 +248,31 @@ public:
     #define DEBUG_COMMAND(methodName, ...) mDriver->debugCommand(#methodName)
 #endif
 
+/*
+ * CommandId identifies the kind of each command recorded in a CommandStream, it is only used
+ * for usage statistics. CUSTOM is queueCommand() and DATA is memory from allocate().
+ */
+enum class CommandId : uint16_t {
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                     methodName,
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)     methodName,
+#include "DriverAPI.inc"
+    CUSTOM,
+    DATA,
+    COUNT
+};
+
 class CommandStream {
 public:
 #define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
     inline void methodName(paramsDecl) {                                                        \
         DEBUG_COMMAND(methodName, params);                                                      \
         using Cmd = COMMAND_TYPE(methodName);                                                   \
-        void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
+        if (!Cmd::isRelocatable && UTILS_UNLIKELY(mRelocatable)) {                              \
+            mRejected = true;                                                                   \
+            return;                                                                             \
+        }                                                                                       \
+        void* const p = allocateCommand(CommandId::methodName, CommandBase::align(sizeof(Cmd)));\
         new(p) Cmd(mDispatcher->methodName##_, params);                                         \
     }
 
@@ -251,9 +285,13 @@ public:
 #define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)                         \
     inline RetType methodName(paramsDecl) {                                                     \
         DEBUG_COMMAND(methodName, params);                                                      \
-        RetType result = mDriver->methodName##S();                                              \
         using Cmd = COMMAND_TYPE(methodName##R);                                                \
-        void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
+        if (!Cmd::isRelocatable && UTILS_UNLIKELY(mRelocatable)) {                              \
+            mRejected = true;                                                                   \
+            return RetType();                                                                   \
+        }                                                                                       \
+        RetType result = mDriver->methodName##S();                                              \
+        void* const p = allocateCommand(CommandId::methodName, CommandBase::align(sizeof(Cmd)));\
         new(p) Cmd(mDispatcher->methodName##_, RetType(result), params);                        \
         return result;                                                                          \
     }
@@ -296,6 +334,40 @@ public:
     inline PodType* allocatePod(
             size_t count = 1, size_t alignment = alignof(PodType)) noexcept;
 
+    /*
+     * Number and bytes of commands recorded since the last resetStats(), indexed by CommandId
+     */
+    struct Stats {
+        uint32_t count[size_t(CommandId::COUNT)];
+        uint32_t size[size_t(CommandId::COUNT)];
+    };
+
+    Stats const& getStats() const noexcept { return mStats; }
+
+    void resetStats() noexcept { mStats = {}; }
+
+    void addStats(Stats const& stats) noexcept;
+
+    /*
+     * Copies commands recorded by another CommandStream to the end of this one, they execute
+     * in order with the commands of this stream. Commands are moved by copying their bytes, so
+     * they must not hold memory from the other stream's allocate() or a queueCommand() lambda,
+     * record them with setRelocatable(true). size must fit in the space guaranteed by the last flush.
+     */
+    void appendCommands(void const* commands, size_t size) noexcept;
+
+    /*
+     * A relocatable stream only records commands appendCommands() can copy. allocate(),
+     * queueCommand() and commands holding a BufferDescriptor, Program or lambda mark the stream
+     * rejected instead, their payload is released without executing, and the caller should
+     * discard what was recorded and record it again on a stream that executes it.
+     */
+    void setRelocatable(bool relocatable) noexcept { mRelocatable = relocatable; }
+    bool hasRejectedCommands() const noexcept { return mRejected; }
+    void clearRejectedCommands() noexcept { mRejected = false; }
+
+    static const char* getCommandName(CommandId id) noexcept;
+
 private:
     // Dispatcher could be a value (instead of pointer), which saves a load when writing commands
     // at the expense of a larger CommandStream object (about ~400 bytes)
@@ -303,13 +375,19 @@ private:
     Driver* mDriver = nullptr;
     CircularBuffer* UTILS_RESTRICT mCurrentBuffer = nullptr;
 
+    Stats mStats = {};
+    bool mRelocatable = false;
+    bool mRejected = false;
+
 #ifndef NDEBUG
     // just for debugging...
     std::thread::id mThreadId;
 #endif
 
-    inline void* allocateCommand(size_t size) {
+    inline void* allocateCommand(CommandId id, size_t size) {
         assert(mThreadId == std::this_thread::get_id());
+        mStats.count[size_t(id)]++;
+        mStats.size[size_t(id)] += uint32_t(size);
         return mCurrentBuffer->allocate(size);
     }
 };
@@ -318,11 +396,16 @@ void* CommandStream::allocate(size_t size, size_t alignment) noexcept {
     // make sure alignment is a power of two
     assert(alignment && !(alignment & alignment-1));
 
+    // memory is still handed out, but commands using it can't be moved to another stream
+    if (UTILS_UNLIKELY(mRelocatable)) {
+        mRejected = true;
+    }
+
     // pad the requested size to accommodate NoopCommand and alignment
     const size_t s = CustomCommand::align(sizeof(NoopCommand) + size + alignment - 1);
 
     // allocate space in the command stream and insert a NoopCommand
-    char* const p = (char *)allocateCommand(s);
+    char* const p = (char *)allocateCommand(CommandId::DATA, s);
     new(p) NoopCommand(p + s);
 
     // calculate the "user" data pointer
@@ -156,5 +156,13 @@ void CircularBuffer::circularize() noexcept {
     mTail = mHead;
 }
 
+void CircularBuffer::resize(size_t size) noexcept {
+    dealloc();
+    mData = alloc(size);
+    mSize = size;
+    mTail = mData;
+    mHead = mData;
+}
+
 } // namespace backend
 } // namespace filament
@@ -18,6 +18,8 @@
 
 #include <assert.h>
 
+#include <chrono>
+
 #include <utils/Log.h>
 #include <utils/Systrace.h>
 
@@ -39,6 +41,27 @@ CommandBufferQueue::~CommandBufferQueue() {
     assert(mCommandBuffersToExecute.empty());
 }
 
+void CommandBufferQueue::resetPeaks() noexcept {
+    mStats.peakFlushSize = 0;
+    mStats.peakUsedSize = 0;
+}
+
+void CommandBufferQueue::resize(size_t requiredSize, size_t bufferSize) {
+    SYSTRACE_CALL();
+
+    assert(mCircularBuffer.empty());
+
+    std::unique_lock<utils::Mutex> lock(mLock);
+    mCondition.wait(lock, [this]() -> bool {
+        return mFreeSpace == mCircularBuffer.size();
+    });
+
+    mCircularBuffer.resize(bufferSize);
+    mRequiredSize = (requiredSize + CircularBuffer::BLOCK_MASK) & ~CircularBuffer::BLOCK_MASK;
+    mFreeSpace = mCircularBuffer.size();
+    assert(mCircularBuffer.size() > requiredSize);
+}
+
 void CommandBufferQueue::requestExit() {
     std::unique_lock<utils::Mutex> lock(mLock);
     mExitRequested = true;
@@ -67,6 +90,9 @@ void CommandBufferQueue::flush() noexcept {
     uint32_t used = uint32_t(intptr_t(head) - intptr_t(tail));
 
     circularBuffer.circularize();
+    mStats.flushedSize += used;
+    mStats.flushCount++;
+    mStats.peakFlushSize = std::max(mStats.peakFlushSize, size_t(used));
 
     std::unique_lock<utils::Mutex> lock(mLock);
     mCommandBuffersToExecute.push_back({ tail, head });
@@ -78,9 +104,10 @@ void CommandBufferQueue::flush() noexcept {
     mFreeSpace -= used;
     const size_t requiredSize = mRequiredSize;
 
-#ifndef NDEBUG
     size_t totalUsed = circularBuffer.size() - mFreeSpace;
-    mHighWatermark = std::max(mHighWatermark, totalUsed);
+    mStats.peakUsedSize = std::max(mStats.peakUsedSize, totalUsed);
+
+#ifndef NDEBUG
     if (UTILS_UNLIKELY(totalUsed > requiredSize)) {
         slog.d << "CommandStream used too much space: " << totalUsed
             << ", out of " << requiredSize << " (will block)" << io::endl;
@@ -96,9 +123,13 @@ void CommandBufferQueue::flush() noexcept {
         // unfortunately, there is not enough space left, we'll have to wait.
         mCondition.notify_one(); // too bad there isn't a notify-and-wait
         SYSTRACE_NAME("waiting: CircularBuffer::flush()");
+        auto start = std::chrono::steady_clock::now();
         mCondition.wait(lock, [this, requiredSize]() -> bool {
             return mFreeSpace >= requiredSize;
         });
+        mStats.stallCount++;
+        mStats.stallTime += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
     }
 }
 
@@ -23,6 +23,8 @@
 
 #include <functional>
 
+#include <string.h>
+
 using namespace utils;
 
 namespace filament {
@@ -95,7 +97,39 @@ void CommandStream::execute(void* buffer) {
 }
 
 void CommandStream::queueCommand(std::function<void()> command) {
-    new(allocateCommand(CustomCommand::align(sizeof(CustomCommand)))) CustomCommand(std::move(command));
+    if (UTILS_UNLIKELY(mRelocatable)) {
+        // dropped without running, the lambda copy would not survive appendCommands()
+        mRejected = true;
+        return;
+    }
+    new(allocateCommand(CommandId::CUSTOM, CustomCommand::align(sizeof(CustomCommand)))) CustomCommand(std::move(command));
+}
+
+void CommandStream::addStats(Stats const& stats) noexcept {
+    for (size_t i = 0; i < size_t(CommandId::COUNT); i++) {
+        mStats.count[i] += stats.count[i];
+        mStats.size[i] += stats.size[i];
+    }
+}
+
+void CommandStream::appendCommands(void const* commands, size_t size) noexcept {
+    assert(mThreadId == std::this_thread::get_id());
+    assert(size == CommandBase::align(size));
+    memcpy(mCurrentBuffer->allocate(size), commands, size);
+}
+
+const char* CommandStream::getCommandName(CommandId id) noexcept {
+    static const char* const names[] = {
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                     #methodName,
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)     #methodName,
+#include "private/backend/DriverAPI.inc"
+            "queueCommand",
+            "allocate",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == size_t(CommandId::COUNT),
+            "command names must match CommandId");
+    return id < CommandId::COUNT ? names[size_t(id)] : "";
 }
 
 /*
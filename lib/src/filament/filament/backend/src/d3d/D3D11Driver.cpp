@@ -844,7 +844,7 @@ namespace filament
 			
 		}
 
-		void D3D11Driver::draw(backend::PipelineState ps, Handle<HwRenderPrimitive> rph)
+		void D3D11Driver::draw(backend::PipelineState ps, Handle<HwRenderPrimitive> rph, uint32_t instanceCount)
 		{
 			auto program = handle_cast<D3D11Program>(m_handle_map, ps.program);
 			auto primitive = handle_cast<D3D11RenderPrimitive>(m_handle_map, rph);
@@ -1035,7 +1035,14 @@ namespace filament
 			}
 			m_context->context->IASetInputLayout(program->input_layout);
 
-			m_context->context->DrawIndexed(primitive->count, primitive->offset, 0);
+			if (instanceCount > 1)
+			{
+				m_context->context->DrawIndexedInstanced(primitive->count, instanceCount, primitive->offset, 0, 0);
+			}
+			else
+			{
+				m_context->context->DrawIndexed(primitive->count, primitive->offset, 0);
+			}
 		}
 	}
 }
@@ -3615,7 +3615,7 @@ void OpenGLDriver::updateTextureLodRange(GLTexture* texture, int8_t targetLevel)
     }
 }
 
-void OpenGLDriver::draw(PipelineState state, Handle<HwRenderPrimitive> rph) {
+void OpenGLDriver::draw(PipelineState state, Handle<HwRenderPrimitive> rph, uint32_t instanceCount) {
     DEBUG_MARKER()
 	CHECK_GL_ERROR(utils::slog.e)
 
@@ -3647,12 +3647,22 @@ void OpenGLDriver::draw(PipelineState state, Handle<HwRenderPrimitive> rph) {
 
     if (this->getShaderModel() == backend::ShaderModel::GL_ES_20)
     {
+        // no instancing in es2, callers draw instances one by one
+        assert(instanceCount == 1);
         glDrawElements(GLenum(rp->type), rp->count, rp->gl.indicesType, (const void*) (size_t) rp->offset);
     }
     else if (this->getShaderModel() >= backend::ShaderModel::GL_ES_30)
     {
-        glDrawRangeElements(GLenum(rp->type), rp->minIndex, rp->maxIndex, rp->count,
-                            rp->gl.indicesType, (const void*) (size_t) rp->offset);
+        if (instanceCount > 1)
+        {
+            glDrawElementsInstanced(GLenum(rp->type), rp->count, rp->gl.indicesType,
+                                    (const void*) (size_t) rp->offset, instanceCount);
+        }
+        else
+        {
+            glDrawRangeElements(GLenum(rp->type), rp->minIndex, rp->maxIndex, rp->count,
+                                rp->gl.indicesType, (const void*) (size_t) rp->offset);
+        }
     }
 
     CHECK_GL_ERROR(utils::slog.e)
@@ -0,0 +1,106 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BindingCache.h"
+#include "Engine.h"
+
+namespace Viry3D
+{
+    thread_local filament::backend::UniformBufferHandle BindingCache::m_uniform_buffers[filament::backend::CONFIG_UNIFORM_BINDING_COUNT];
+    thread_local int BindingCache::m_uniform_offsets[filament::backend::CONFIG_UNIFORM_BINDING_COUNT];
+    thread_local filament::backend::SamplerGroupHandle BindingCache::m_sampler_groups[filament::backend::CONFIG_SAMPLER_BINDING_COUNT];
+    thread_local int BindingCache::m_bind_count = 0;
+    thread_local int BindingCache::m_skip_count = 0;
+
+    void BindingCache::BeginRenderPass(filament::backend::RenderTargetHandle target, const filament::backend::RenderPassParams& params)
+    {
+        UniformBufferPool::Flush();
+        Engine::Instance()->GetDriverApi().beginRenderPass(target, params);
+        Invalidate();
+    }
+
+    void BindingCache::BindUniformBuffer(int binding, filament::backend::UniformBufferHandle buffer)
+    {
+        assert(binding >= 0 && binding < (int) filament::backend::CONFIG_UNIFORM_BINDING_COUNT);
+
+        if (m_uniform_buffers[binding] == buffer && m_uniform_offsets[binding] < 0)
+        {
+            ++m_skip_count;
+            return;
+        }
+
+        Engine::Instance()->GetDriverApi().bindUniformBuffer((size_t) binding, buffer);
+        m_uniform_buffers[binding] = buffer;
+        m_uniform_offsets[binding] = -1;
+        ++m_bind_count;
+    }
+
+    void BindingCache::BindUniformBuffer(int binding, const UniformBufferSlice& slice)
+    {
+        assert(binding >= 0 && binding < (int) filament::backend::CONFIG_UNIFORM_BINDING_COUNT);
+
+        if (m_uniform_buffers[binding] == slice.uniform_buffer && m_uniform_offsets[binding] == slice.offset)
+        {
+            ++m_skip_count;
+            return;
+        }
+
+        Engine::Instance()->GetDriverApi().bindUniformBufferRange((size_t) binding, slice.uniform_buffer, (size_t) slice.offset, (size_t) slice.size);
+        m_uniform_buffers[binding] = slice.uniform_buffer;
+        m_uniform_offsets[binding] = slice.offset;
+        ++m_bind_count;
+    }
+
+    void BindingCache::BindSamplers(int binding, filament::backend::SamplerGroupHandle group)
+    {
+        assert(binding >= 0 && binding < (int) filament::backend::CONFIG_SAMPLER_BINDING_COUNT);
+
+        if (m_sampler_groups[binding] == group)
+        {
+            ++m_skip_count;
+            return;
+        }
+
+        Engine::Instance()->GetDriverApi().bindSamplers((size_t) binding, group);
+        m_sampler_groups[binding] = group;
+        ++m_bind_count;
+    }
+
+    void BindingCache::Invalidate()
+    {
+        for (auto& i : m_uniform_buffers)
+        {
+            i.clear();
+        }
+        for (auto& i : m_sampler_groups)
+        {
+            i.clear();
+        }
+    }
+
+    void BindingCache::ResetStats()
+    {
+        m_bind_count = 0;
+        m_skip_count = 0;
+    }
+
+    void BindingCache::AddStats(int bind_count, int skip_count)
+    {
+        m_bind_count += bind_count;
+        m_skip_count += skip_count;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "Shader.h"
+#include "UniformBufferPool.h"
+#include "private/backend/DriverApi.h"
+
+namespace Viry3D
+{
+    // uniform buffer and sampler group last bound to each binding point of driver command stream,
+    // binding the same handle again is skipped. bindings are forgotten when a render pass begins,
+    // draws carry their whole pipeline state so programs have nothing to skip.
+    // pooled uniform buffers are flushed before each render pass.
+    // state is per thread, workers recording draws into their own command segment bind on their own
+    class BindingCache
+    {
+    public:
+        static void BeginRenderPass(filament::backend::RenderTargetHandle target, const filament::backend::RenderPassParams& params);
+        static void BindUniformBuffer(int binding, filament::backend::UniformBufferHandle buffer);
+        static void BindUniformBuffer(Shader::BindingPoint binding, filament::backend::UniformBufferHandle buffer) { BindUniformBuffer((int) binding, buffer); }
+        static void BindUniformBuffer(int binding, const UniformBufferSlice& slice);
+        static void BindUniformBuffer(Shader::BindingPoint binding, const UniformBufferSlice& slice) { BindUniformBuffer((int) binding, slice); }
+        static void BindSamplers(int binding, filament::backend::SamplerGroupHandle group);
+        static void BindSamplers(Shader::BindingPoint binding, filament::backend::SamplerGroupHandle group) { BindSamplers((int) binding, group); }
+        static void Invalidate();
+        // binds issued and skipped since frame begin
+        static int GetBindCount() { return m_bind_count; }
+        static int GetSkipCount() { return m_skip_count; }
+        static void ResetStats();
+        // moves counts of workers to main thread
+        static void AddStats(int bind_count, int skip_count);
+
+    private:
+        static thread_local filament::backend::UniformBufferHandle m_uniform_buffers[filament::backend::CONFIG_UNIFORM_BINDING_COUNT];
+        static thread_local int m_uniform_offsets[filament::backend::CONFIG_UNIFORM_BINDING_COUNT]; // -1 for whole buffer
+        static thread_local filament::backend::SamplerGroupHandle m_sampler_groups[filament::backend::CONFIG_SAMPLER_BINDING_COUNT];
+        static thread_local int m_bind_count;
+        static thread_local int m_skip_count;
+    };
+}
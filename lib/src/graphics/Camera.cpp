@@ -21,12 +21,18 @@
 #include "RenderTarget.h"
 #include "Engine.h"
 #include "Editor.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Material.h"
 #include "SkinnedMeshRenderer.h"
 #include "Light.h"
+#include "Mesh.h"
+#include "BindingCache.h"
 #include "time/Time.h"
+#include "math/Mathf.h"
+#include "math/Frustum.h"
 #include "postprocessing/PostProcessing.h"
+#include <algorithm>
 
 namespace Viry3D
 {
@@ -36,6 +42,63 @@ namespace Viry3D
 	bool Camera::m_cameras_order_dirty = false;
 	Ref<Mesh> Camera::m_quad_mesh;
 	Ref<Material> Camera::m_blit_material;
+	Vector<Camera::InstancedMesh> Camera::m_instanced_meshes;
+
+	static filament::backend::RenderPrimitiveHandle GetRendererPrimitive(Renderer* renderer, int material_index, int* index_count = nullptr)
+	{
+		filament::backend::RenderPrimitiveHandle primitive;
+		int index = -1;
+
+		auto primitives = renderer->GetPrimitives();
+		if (material_index < primitives.Size())
+		{
+			index = material_index;
+		}
+		else if (primitives.Size() > 0)
+		{
+			index = 0;
+		}
+
+		if (index >= 0)
+		{
+			primitive = primitives[index];
+		}
+		if (index_count)
+		{
+			*index_count = index >= 0 ? renderer->GetPrimitiveIndexCount(index) : 0;
+		}
+
+		return primitive;
+	}
+
+	static bool IsSamePropertyBlock(const Renderer* a, const Renderer* b)
+	{
+		if (a == nullptr || !a->HasPropertyBlock())
+		{
+			return !b->HasPropertyBlock();
+		}
+		if (!b->HasPropertyBlock())
+		{
+			return false;
+		}
+		return a->GetPropertyBlock() == b->GetPropertyBlock() || a->GetPropertyBlock()->IsSame(*b->GetPropertyBlock());
+	}
+
+	static bool IsSameLights(const Vector<Light*>& a, const Vector<Light*>& b, int b_begin, int b_count)
+	{
+		if (a.Size() != b_count)
+		{
+			return false;
+		}
+		for (int i = 0; i < a.Size(); ++i)
+		{
+			if (a[i] != b[b_begin + i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 
 	void Camera::Init()
 	{
@@ -46,10 +109,13 @@ namespace Viry3D
 	{
 		m_quad_mesh.reset();
 		m_blit_material.reset();
+		m_instanced_meshes.Clear();
 	}
 
 	void Camera::RenderAll()
 	{
+		PROFILE_SCOPE("Camera::RenderAll");
+
 		const auto& lights = Light::GetLights();
 		for (auto i : lights)
 		{
@@ -58,6 +124,12 @@ namespace Viry3D
                 i->Prepare();
             }
 		}
+		Light::PrepareAmbient();
+
+		for (const auto& i : m_instanced_meshes)
+		{
+			i.material->Prepare();
+		}
 
 		if (m_cameras_order_dirty)
 		{
@@ -73,15 +145,38 @@ namespace Viry3D
 			{
 				m_current_camera = i;
 
+				int draw_calls = RenderStats::GetCounters().draw_calls;
+
 				List<Renderer*> renderers;
-				i->CullRenderers(Renderer::GetRenderers(), renderers);
+				int culled = i->CullRenderers(Renderer::GetRenderers(), renderers);
 				i->UpdateViewUniforms();
+				i->UpdateLightClusters();
 				i->Draw(renderers);
 				i->PostProcessing();
 
+				RenderStats::AddCamera(i->GetGameObject()->GetName(), renderers.Size(), culled, RenderStats::GetCounters().draw_calls - draw_calls);
+
 				m_current_camera = nullptr;
 			}
 		}
+
+		m_instanced_meshes.Clear();
+	}
+
+	void Camera::DrawMeshInstanced(const Ref<Mesh>& mesh, int submesh, const Ref<Material>& material, const Vector<Matrix4x4>& matrices, int layer)
+	{
+		if (!mesh || !material || matrices.Size() == 0)
+		{
+			return;
+		}
+
+		InstancedMesh instanced_mesh;
+		instanced_mesh.mesh = mesh;
+		instanced_mesh.submesh = submesh;
+		instanced_mesh.material = material;
+		instanced_mesh.matrices = matrices;
+		instanced_mesh.layer = layer;
+		m_instanced_meshes.Add(instanced_mesh);
 	}
     
     void Camera::OnResizeAll(int width, int height)
@@ -103,46 +198,369 @@ namespace Viry3D
         m_projection_matrix_dirty = true;
     }
 
-    void Camera::CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result)
+    int Camera::CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result)
     {
+        PROFILE_SCOPE("Camera::CullRenderers");
+
+        Frustum frustum(this->GetProjectionMatrix() * this->GetViewMatrix());
+        int culled = 0;
+
         for (auto i : renderers)
         {
             int layer = i->GetGameObject()->GetLayer();
             if (i->GetGameObject()->IsActiveInTree() && i->IsEnable() && ((1 << layer) & m_culling_mask) != 0)
             {
+                // renderers without bounds are always visible
+                Bounds bounds = i->GetWorldBounds();
+                if (bounds.GetSize().SqrMagnitude() > 0 &&
+                    frustum.ContainsBounds(bounds.Min(), bounds.Max()) == ContainsResult::Out)
+                {
+                    ++culled;
+                    continue;
+                }
+
                 result.AddLast(i);
             }
         }
-        result.Sort([](Renderer* a, Renderer* b) {
-            const auto& materials_a = a->GetMaterials();
-            int queue_a = 0;
-            for (int i = 0; i < materials_a.Size(); ++i)
-            {
-				if (materials_a[i])
+
+        return culled;
+    }
+
+	void Camera::BuildDrawItems(const List<Renderer*>& renderers)
+	{
+		PROFILE_SCOPE("Camera::BuildDrawItems");
+
+		m_draw_items.Clear();
+		m_item_lights.Clear();
+		m_static_batch_members.Clear();
+		m_static_batch_ranges.Clear();
+
+		bool cluster_light_active = this->IsClusterLightActive();
+		Vector3 camera_pos = this->GetTransform()->GetPosition();
+		Vector3 camera_forward = this->GetTransform()->GetForward();
+		float depth_scale = 1.0f / m_far_clip;
+
+		// static batch members are drawn by their root with ranges of members visible in this camera
+		auto add_items = [&](Renderer* i, const StaticBatchMember* members, int member_count) {
+			Bounds bounds = i->GetWorldBounds();
+			Vector3 center = bounds.GetSize().SqrMagnitude() > 0 ? bounds.GetCenter() : i->GetTransform()->GetPosition();
+			float depth = (center - camera_pos).Dot(camera_forward) * depth_scale;
+
+			// lights are culled on first material not shaded by cluster lights, and shared by all
+			int light_begin = -1;
+			int light_count = 0;
+
+			const auto& materials = i->GetMaterials();
+			for (int j = 0; j < materials.Size(); ++j)
+			{
+				const auto& material = materials[j];
+				if (material)
 				{
-					int queue = materials_a[i]->GetQueue();
-					if (queue_a < queue)
+					DrawItem item;
+					item.key = DrawItem::MakeKey(material->GetQueue(), material->GetShader()->GetId(), material->GetId(), depth);
+					item.renderer = i;
+					item.material_index = j;
+					item.instance_batch = -1;
+					item.light_begin = 0;
+					item.light_count = 0;
+					item.range_begin = 0;
+					item.range_count = 0;
+
+					if (members)
+					{
+						item.range_begin = m_static_batch_ranges.Size();
+						this->AddStaticBatchRanges(static_cast<MeshRenderer*>(i), j, members, member_count);
+						item.range_count = m_static_batch_ranges.Size() - item.range_begin;
+					}
+
+					if (!(cluster_light_active && material->GetShader()->IsClusterLight()))
 					{
-						queue_a = queue;
+						if (light_begin < 0)
+						{
+							Light::CullLights(i, m_renderer_lights);
+							light_begin = m_item_lights.Size();
+							light_count = m_renderer_lights.Size();
+							m_item_lights.AddRange(m_renderer_lights);
+						}
+						item.light_begin = light_begin;
+						item.light_count = light_count;
 					}
+
+					m_draw_items.Add(item);
 				}
-            }
-            const auto& materials_b = b->GetMaterials();
-            int queue_b = 0;
-            for (int i = 0; i < materials_b.Size(); ++i)
-            {
-				if (materials_b[i])
+			}
+		};
+
+		for (auto i : renderers)
+		{
+			// only mesh renderers are static batched
+			if (i->IsStaticBatched())
+			{
+				MeshRenderer* renderer = static_cast<MeshRenderer*>(i);
+				if (renderer->IsStaticBatchMember())
 				{
-					int queue = materials_b[i]->GetQueue();
-					if (queue_b < queue)
+					auto root = renderer->GetStaticBatchRoot();
+					if (root && root->IsStaticBatchRoot() && root->GetGameObject()->IsActiveInTree() && root->IsEnable())
 					{
-						queue_b = queue;
+						m_static_batch_members.Add({ root.get(), renderer->m_static_batch_index });
 					}
 				}
-            }
-            return queue_a < queue_b;
-        });
-    }
+				continue;
+			}
+
+			add_items(i, nullptr, 0);
+		}
+
+		if (m_static_batch_members.Size() > 0)
+		{
+			// members of one root become adjacent and in combined mesh order
+			std::sort(m_static_batch_members.begin(), m_static_batch_members.end(), [](const StaticBatchMember& a, const StaticBatchMember& b) {
+				return a.root != b.root ? a.root < b.root : a.index < b.index;
+			});
+
+			int begin = 0;
+			for (int i = 1; i <= m_static_batch_members.Size(); ++i)
+			{
+				if (i == m_static_batch_members.Size() || m_static_batch_members[i].root != m_static_batch_members[begin].root)
+				{
+					add_items(m_static_batch_members[begin].root, &m_static_batch_members[begin], i - begin);
+					begin = i;
+				}
+			}
+		}
+
+		DrawItem::Sort(m_draw_items, m_draw_items_temp);
+
+		this->BuildInstanceBatches();
+	}
+
+	void Camera::AddStaticBatchRanges(MeshRenderer* root, int material_index, const StaticBatchMember* members, int member_count)
+	{
+		int range_begin = m_static_batch_ranges.Size();
+
+		for (int i = 0; i < member_count; ++i)
+		{
+			const auto& submesh = root->GetStaticMemberRange(material_index, members[i].index);
+
+			// members next to each other in combined mesh merge into one draw
+			int last = m_static_batch_ranges.Size() - 1;
+			if (last >= range_begin && m_static_batch_ranges[last].index_first + m_static_batch_ranges[last].index_count == submesh.index_first)
+			{
+				m_static_batch_ranges[last].index_count += submesh.index_count;
+			}
+			else
+			{
+				m_static_batch_ranges.Add({ submesh.index_first, submesh.index_count });
+			}
+		}
+	}
+
+	bool Camera::IsInstancingActive() const
+	{
+		// no instanced draw on gles 2.0
+		return m_instancing_enable &&
+			!(Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
+			Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20);
+	}
+
+	void Camera::BuildInstanceBatches()
+	{
+		for (int i = 0; i < m_instance_batch_count; ++i)
+		{
+			m_instance_batches[i].material.reset();
+		}
+		m_instance_batch_count = 0;
+		m_instance_uniform_buffer_count = 0;
+
+		if (!this->IsInstancingActive())
+		{
+			return;
+		}
+
+		bool cluster_light_active = this->IsClusterLightActive();
+
+		// opaque items are sorted by shader and material, so renderers to merge are adjacent,
+		// merged items are removed and the first one draws the batch
+		Material* run_material = nullptr;
+		int run_begin = 0;
+		int item_count = 0;
+
+		for (int i = 0; i < m_draw_items.Size(); ++i)
+		{
+			DrawItem item = m_draw_items[i];
+			Renderer* renderer = item.renderer;
+			const auto& material = renderer->GetMaterials()[item.material_index];
+
+			if (material.get() != run_material)
+			{
+				run_material = material.get();
+				run_begin = m_instance_batch_count;
+			}
+
+			filament::backend::RenderPrimitiveHandle primitive;
+			int index_count = 0;
+			if (material->GetQueue() < (int) Shader::Queue::Transparent &&
+				material->GetShader()->IsInstancing() &&
+				item.range_count == 0 &&
+				dynamic_cast<SkinnedMeshRenderer*>(renderer) == nullptr)
+			{
+				primitive = GetRendererPrimitive(renderer, item.material_index, &index_count);
+			}
+
+			if (primitive)
+			{
+				InstanceBatch* batch = nullptr;
+				for (int j = run_begin; j < m_instance_batch_count; ++j)
+				{
+					auto& run_batch = m_instance_batches[j];
+					if (run_batch.primitive == primitive &&
+						run_batch.keywords == renderer->GetShaderKeywordMask() &&
+						run_batch.recieve_shadow == renderer->IsRecieveShadow() &&
+						IsSamePropertyBlock(run_batch.block_renderer, renderer) &&
+						run_batch.matrices.Size() < InstanceUniforms::INSTANCE_MAX_COUNT &&
+						IsSameLights(run_batch.lights, m_item_lights, item.light_begin, item.light_count))
+					{
+						batch = &run_batch;
+						break;
+					}
+				}
+
+				if (batch)
+				{
+					batch->matrices.Add(renderer->GetRendererUniforms().model_matrix);
+					continue;
+				}
+
+				item.instance_batch = m_instance_batch_count;
+
+				auto& new_batch = this->AddInstanceBatch();
+				new_batch.material = material;
+				new_batch.primitive = primitive;
+				new_batch.index_count = index_count;
+				new_batch.keywords = renderer->GetShaderKeywordMask();
+				new_batch.recieve_shadow = renderer->IsRecieveShadow();
+				new_batch.block_renderer = renderer->HasPropertyBlock() ? renderer : nullptr;
+				new_batch.block_material_index = item.material_index;
+				for (int j = 0; j < item.light_count; ++j)
+				{
+					new_batch.lights.Add(m_item_lights[item.light_begin + j]);
+				}
+				new_batch.matrices.Add(renderer->GetRendererUniforms().model_matrix);
+				new_batch.item_index = item_count;
+			}
+
+			m_draw_items[item_count] = item;
+			item_count += 1;
+		}
+
+		m_draw_items.Resize(item_count);
+
+		// instances from DrawMeshInstanced, split by max instance count
+		if (m_instanced_meshes.Size() > 0)
+		{
+			Frustum frustum(this->GetProjectionMatrix() * this->GetViewMatrix());
+
+			for (const auto& i : m_instanced_meshes)
+			{
+				const auto& primitives = i.mesh->GetPrimitives();
+				if (((1 << i.layer) & m_culling_mask) == 0 ||
+					i.submesh < 0 ||
+					i.submesh >= primitives.Size() ||
+					!i.material->GetShader()->IsInstancing())
+				{
+					continue;
+				}
+
+				const Bounds& bounds = i.mesh->GetBounds();
+				bool has_bounds = bounds.GetSize().SqrMagnitude() > 0;
+
+				for (int j = 0; j < i.matrices.Size(); j += InstanceUniforms::INSTANCE_MAX_COUNT)
+				{
+					int count = Mathf::Min(i.matrices.Size() - j, InstanceUniforms::INSTANCE_MAX_COUNT);
+
+					Bounds world_bounds;
+					if (has_bounds)
+					{
+						world_bounds = bounds.Transform(i.matrices[j]);
+						for (int k = 1; k < count; ++k)
+						{
+							world_bounds.Encapsulate(bounds.Transform(i.matrices[j + k]));
+						}
+
+						if (frustum.ContainsBounds(world_bounds.Min(), world_bounds.Max()) == ContainsResult::Out)
+						{
+							continue;
+						}
+					}
+
+					auto& batch = this->AddInstanceBatch();
+					batch.material = i.material;
+					batch.primitive = primitives[i.submesh];
+					batch.index_count = i.mesh->GetSubmeshes()[i.submesh].index_count;
+					batch.keywords = 0;
+					batch.recieve_shadow = false;
+					batch.block_renderer = nullptr;
+					batch.block_material_index = 0;
+					if (!(cluster_light_active && i.material->GetShader()->IsClusterLight()))
+					{
+						Light::CullLights(world_bounds, i.layer, -1, batch.lights);
+					}
+					batch.matrices.AddRange(&i.matrices[j], count);
+					batch.item_index = -1;
+				}
+			}
+		}
+
+		for (int i = 0; i < m_instance_batch_count; ++i)
+		{
+			auto& batch = m_instance_batches[i];
+
+			// single renderer draws with its own uniform buffer
+			if (batch.item_index >= 0 && batch.matrices.Size() == 1)
+			{
+				m_draw_items[batch.item_index].instance_batch = -1;
+				continue;
+			}
+
+			batch.uniform_buffer = this->UploadInstances(&batch.matrices[0], batch.matrices.Size());
+		}
+	}
+
+	Camera::InstanceBatch& Camera::AddInstanceBatch()
+	{
+		if (m_instance_batch_count >= m_instance_batches.Size())
+		{
+			m_instance_batches.Add(InstanceBatch());
+		}
+
+		auto& batch = m_instance_batches[m_instance_batch_count];
+		batch.lights.Clear();
+		batch.matrices.Clear();
+		m_instance_batch_count += 1;
+
+		return batch;
+	}
+
+	filament::backend::UniformBufferHandle Camera::UploadInstances(const Matrix4x4* matrices, int count)
+	{
+		auto& driver = Engine::Instance()->GetDriverApi();
+
+		if (m_instance_uniform_buffer_count >= m_instance_uniform_buffers.Size())
+		{
+			m_instance_uniform_buffers.Add(driver.createUniformBuffer(sizeof(InstanceUniforms), filament::backend::BufferUsage::DYNAMIC));
+		}
+
+		const auto& uniform_buffer = m_instance_uniform_buffers[m_instance_uniform_buffer_count];
+		m_instance_uniform_buffer_count += 1;
+
+		int size = sizeof(Matrix4x4) * count;
+		void* buffer = Memory::Alloc<void>(size);
+		Memory::Copy(buffer, matrices, size);
+		driver.loadUniformBuffer(uniform_buffer, filament::backend::BufferDescriptor(buffer, size, FreeBufferCallback));
+		RenderStats::AddUniformUpload(size);
+
+		return uniform_buffer;
+	}
 
 	void Camera::UpdateViewUniforms()
 	{
@@ -167,10 +585,47 @@ namespace Viry3D
 		void* buffer = driver.allocate(sizeof(ViewUniforms));
 		Memory::Copy(buffer, &m_view_uniforms, sizeof(ViewUniforms));
 		driver.loadUniformBuffer(m_view_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(ViewUniforms)));
+		RenderStats::AddUniformUpload(sizeof(ViewUniforms));
+	}
+
+	bool Camera::IsClusterLightActive() const
+	{
+		// no uniform buffer on gles 2.0, use light passes
+		return m_cluster_light_enable &&
+			!(Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
+			Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20);
+	}
+
+	void Camera::UpdateLightClusters()
+	{
+		PROFILE_SCOPE("Camera::UpdateLightClusters");
+
+		if (!this->IsClusterLightActive())
+		{
+			return;
+		}
+
+		if (!m_light_clusters)
+		{
+			m_light_clusters = RefMake<LightClusters>();
+		}
+
+		LightClusters::CollectLights(m_cluster_lights);
+		m_light_clusters->Build(
+			this->GetViewMatrix(),
+			this->GetProjectionMatrix(),
+			m_near_clip,
+			m_far_clip,
+			m_orthographic,
+			m_cluster_lights,
+			Engine::Instance()->GetJobSystem());
+		m_light_clusters->Upload();
 	}
 
 	void Camera::Draw(const List<Renderer*>& renderers)
 	{
+		PROFILE_SCOPE("Camera::Draw");
+
 		auto& driver = Engine::Instance()->GetDriverApi();
 
 		int target_width = this->GetTargetWidth();
@@ -334,13 +789,86 @@ namespace Viry3D
 		params.viewport.height = (uint32_t) (m_viewport_rect.h * target_height);
 		params.clearColor = filament::math::float4(m_clear_color.r, m_clear_color.g, m_clear_color.b, m_clear_color.a);
 
-		driver.beginRenderPass(target, params);
+		// instance buffers are uploaded here, outside of render pass
+		this->BuildDrawItems(renderers);
 
-		driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerView, m_view_uniform_buffer);
+		BindingCache::BeginRenderPass(target, params);
 
-        for (auto i : renderers)
+		BindingCache::BindUniformBuffer(Shader::BindingPoint::PerView, m_view_uniform_buffer);
+
+		if (this->IsClusterLightActive())
+		{
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerViewLights, m_light_clusters->GetLightUniformBuffer());
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerViewLightIndices, m_light_clusters->GetIndexUniformBuffer());
+		}
+
+        // draw items are recorded in chunks on job system, gles 2.0 sets uniforms
+        // per draw with allocated command data so it records serially
+        int chunk_count = 1;
+        if (Engine::Instance()->GetBackend() != filament::backend::Backend::OPENGL ||
+            Engine::Instance()->GetShaderModel() != filament::backend::ShaderModel::GL_ES_20)
+        {
+            chunk_count = Engine::Instance()->GetRecordChunkCount(m_draw_items.Size());
+        }
+        if (m_draw_chunks.Size() < chunk_count)
         {
-            this->DrawRenderer(i);
+            m_draw_chunks.Resize(chunk_count);
+        }
+        for (int i = 0; i < chunk_count; ++i)
+        {
+            m_draw_chunks[i].parallel = chunk_count > 1;
+        }
+
+        Engine::Instance()->RecordParallel(m_draw_items.Size(), chunk_count, [this](int chunk, int begin, int end) {
+            auto& draw_chunk = m_draw_chunks[chunk];
+            // chunk is recorded again on main thread when it needed unmovable commands
+            draw_chunk.counters.Reset();
+            draw_chunk.shader_requests.Clear();
+            for (int i = begin; i < end; ++i)
+            {
+                const auto& item = m_draw_items[i];
+                const InstanceBatch* batch = item.instance_batch >= 0 ? &m_instance_batches[item.instance_batch] : nullptr;
+                this->DrawRenderer(&item, batch, draw_chunk);
+                Engine::Instance()->FlushCommandsIfNeeded();
+            }
+        });
+
+        // variants missed by chunks start compiling here and are drawn once ready
+        for (int i = 0; i < chunk_count; ++i)
+        {
+            auto& draw_chunk = m_draw_chunks[i];
+            for (const auto& j : draw_chunk.shader_requests)
+            {
+                j.material->GetShaderAsync(j.keywords);
+            }
+            draw_chunk.shader_requests.Clear();
+            draw_chunk.parallel = false;
+        }
+
+        // instances from DrawMeshInstanced are drawn after scene renderers
+        for (int i = 0; i < m_instance_batch_count; ++i)
+        {
+            if (m_instance_batches[i].item_index < 0)
+            {
+                this->DrawRenderer(nullptr, &m_instance_batches[i], m_draw_chunks[0]);
+                Engine::Instance()->FlushCommandsIfNeeded();
+            }
+        }
+
+        for (int i = 0; i < chunk_count; ++i)
+        {
+            RenderStats::GetCounters().Add(m_draw_chunks[i].counters);
+        }
+
+        if (Engine::Instance()->GetEditor()->IsInEditorMode())
+        {
+            for (auto i : renderers)
+            {
+                if (i->GetLocalBounds().GetSize().SqrMagnitude() > 0)
+                {
+                    this->DrawRendererBounds(i);
+                }
+            }
         }
         
 		driver.endRenderPass();
@@ -348,134 +876,218 @@ namespace Viry3D
 		driver.flush();
 	}
 
-    void Camera::DrawRenderer(Renderer* renderer)
+    void Camera::DrawRenderer(const DrawItem* item, const InstanceBatch* batch, DrawChunk& chunk)
     {
-        auto& driver = Engine::Instance()->GetDriverApi();
-		
-		driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerRenderer, renderer->GetTransformUniformBuffer());
+		Renderer* renderer = item ? item->renderer : nullptr;
+		int material_index = item ? item->material_index : 0;
+
+		PROFILE_SCOPE("Camera::DrawRenderer");
+
+		if (batch)
+		{
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerRendererInstances, batch->uniform_buffer);
+		}
+		else
+		{
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerRenderer, renderer->GetTransformUniformBuffer());
+		}
 
         SkinnedMeshRenderer* skin = dynamic_cast<SkinnedMeshRenderer*>(renderer);
         if (skin && skin->GetBonesUniformBuffer())
         {
-            driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerRendererBones, skin->GetBonesUniformBuffer());
+            BindingCache::BindUniformBuffer(Shader::BindingPoint::PerRendererBones, skin->GetBonesUniformBuffer());
+        }
+        if (skin && skin->GetBonesSamplerGroup())
+        {
+            BindingCache::BindSamplers(Shader::BindingPoint::PerRenderer, skin->GetBonesSamplerGroup());
         }
         if (skin && skin->GetBlendShapeSamplerGroup())
         {
-            driver.bindSamplers((size_t) Shader::BindingPoint::PerRendererBones, skin->GetBlendShapeSamplerGroup());
+            BindingCache::BindSamplers(Shader::BindingPoint::PerRendererBones, skin->GetBlendShapeSamplerGroup());
         }
 
-		bool lighted = false;
+		if (this->IsClusterLightActive())
+		{
+			const auto& material = batch ? batch->material : renderer->GetMaterials()[material_index];
+			if (material && material->GetShader()->IsClusterLight())
+			{
+				this->DoDraw(item, false, false, true, batch, chunk);
+				return;
+			}
+		}
+
+		// renderer lights are culled when building draw items, instance batch lights when merging
+		const Vector<Light*>& lights = batch ? batch->lights : m_item_lights;
+		int light_begin = batch ? 0 : item->light_begin;
+		int light_count = batch ? batch->lights.Size() : item->light_count;
+
 		bool light_add = false;
-		const auto& lights = Light::GetLights();
-		for (auto i : lights)
+		for (int j = light_begin; j < light_begin + light_count; ++j)
 		{
-			if ((1 << renderer->GetGameObject()->GetLayer()) & i->GetCullingMask())
+			Light* i = lights[j];
+			if (i->IsShadowEnable())
 			{
-				if (i->IsShadowEnable())
+				if (i->GetViewUniformBuffer())
 				{
-					if (i->GetViewUniformBuffer())
-					{
-						driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerLightVertex, i->GetViewUniformBuffer());
-					}
-					
-					if (i->GetSamplerGroup())
-					{
-						driver.bindSamplers((size_t) Shader::BindingPoint::PerLightFragment, i->GetSamplerGroup());
-					}
+					BindingCache::BindUniformBuffer(Shader::BindingPoint::PerLightVertex, i->GetViewUniformBuffer());
+				}
+				
+				if (i->GetSamplerGroup())
+				{
+					BindingCache::BindSamplers(Shader::BindingPoint::PerLightFragment, i->GetSamplerGroup());
 				}
-				driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerLightFragment, i->GetLightUniformBuffer());
+			}
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerLightFragment, i->GetLightUniformBuffer());
 
-                this->DoDraw(renderer, i->IsShadowEnable(), light_add);
+            this->DoDraw(item, i->IsShadowEnable(), light_add, false, batch, chunk);
 
-				lighted = true;
-				light_add = true;
-			}
+			light_add = true;
 		}
 
-		if (!lighted)
+		// light fragment uniforms of last drawn light would still be bound
+		if (light_count == 0)
 		{
-            this->DoDraw(renderer);
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerLightFragment, Light::GetAmbientUniformBuffer());
+            this->DoDraw(item, false, false, false, batch, chunk);
 		}
-
-        if (Engine::Instance()->GetEditor()->IsInEditorMode())
-        {
-            if (renderer->GetLocalBounds().GetSize().SqrMagnitude() > 0)
-            {
-                this->DrawRendererBounds(renderer);
-            }
-        }
     }
 
-    void Camera::DoDraw(Renderer* renderer, bool shadow_enable, bool light_add)
+    void Camera::DoDraw(const DrawItem* item, bool shadow_enable, bool light_add, bool cluster_light, const InstanceBatch* batch, DrawChunk& chunk)
     {
         auto& driver = Engine::Instance()->GetDriverApi();
 
+        Renderer* renderer = item ? item->renderer : nullptr;
+        int material_index = item ? item->material_index : 0;
+
         SkinnedMeshRenderer* skin = dynamic_cast<SkinnedMeshRenderer*>(renderer);
 
-        const auto& materials = renderer->GetMaterials();
-        for (int i = 0; i < materials.Size(); ++i)
+        const auto& material = batch ? batch->material : renderer->GetMaterials()[material_index];
+        if (!material)
+        {
+            return;
+        }
+
+        if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
+            Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
         {
-            auto& material = materials[i];
-            if (material)
+            material->SetMatrix(ViewUniforms::VIEW_MATRIX, m_view_uniforms.view_matrix);
+            material->SetMatrix(ViewUniforms::PROJECTION_MATRIX, m_view_uniforms.projection_matrix);
+            material->SetVector(ViewUniforms::CAMERA_POS, m_view_uniforms.camera_pos);
+            material->SetVector(ViewUniforms::TIME, m_view_uniforms.time);
+            material->SetMatrix(RendererUniforms::MODEL_MATRIX, renderer->GetRendererUniforms().model_matrix);
+
+            if (skin && skin->GetBonesUniformBuffer())
+            {
+                material->SetVectorArray(SkinnedMeshRendererUniforms::BONES, skin->GetBoneVectors());
+            }
+        }
+
+        filament::backend::RenderPrimitiveHandle primitive;
+        int index_count;
+        uint32_t vertex_max = 0;
+        if (batch)
+        {
+            primitive = batch->primitive;
+            index_count = batch->index_count;
+        }
+        else if (item->range_count > 0)
+        {
+            MeshRenderer* root = static_cast<MeshRenderer*>(renderer);
+            primitive = root->m_static_range_primitive;
+            index_count = 0;
+            vertex_max = root->GetMesh()->GetVertices().Size() - 1;
+        }
+        else
+        {
+            primitive = GetRendererPrimitive(renderer, material_index, &index_count);
+        }
+
+        if (primitive)
+        {
+            static const Shader::KeywordMask RECIEVE_SHADOW_ON = Shader::KeywordToMask("RECIEVE_SHADOW_ON");
+            static const Shader::KeywordMask LIGHT_ADD_ON = Shader::KeywordToMask("LIGHT_ADD_ON");
+            static const Shader::KeywordMask CLUSTER_LIGHT_ON = Shader::KeywordToMask("CLUSTER_LIGHT_ON");
+            static const Shader::KeywordMask INSTANCING_ON = Shader::KeywordToMask("INSTANCING_ON");
+
+            Shader::KeywordMask keywords = batch ? batch->keywords : renderer->GetShaderKeywordMask();
+            bool recieve_shadow = batch ? batch->recieve_shadow : renderer->IsRecieveShadow();
+            if (shadow_enable && recieve_shadow)
+            {
+                keywords |= RECIEVE_SHADOW_ON;
+            }
+            if (light_add)
+            {
+                keywords |= LIGHT_ADD_ON;
+            }
+            if (cluster_light)
             {
-                if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
-                    Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
+                keywords |= CLUSTER_LIGHT_ON;
+            }
+            if (batch)
+            {
+                keywords |= INSTANCING_ON;
+            }
+
+            uint32_t instance_count = batch ? (uint32_t) batch->matrices.Size() : 1;
+            
+            // skip draw until variant compiled on worker threads
+            Ref<Shader> shader;
+            if (chunk.parallel)
+            {
+                shader = material->PeekShader(keywords);
+                if (!shader)
                 {
-                    material->SetMatrix(ViewUniforms::VIEW_MATRIX, m_view_uniforms.view_matrix);
-                    material->SetMatrix(ViewUniforms::PROJECTION_MATRIX, m_view_uniforms.projection_matrix);
-                    material->SetVector(ViewUniforms::CAMERA_POS, m_view_uniforms.camera_pos);
-                    material->SetVector(ViewUniforms::TIME, m_view_uniforms.time);
-                    material->SetMatrix(RendererUniforms::MODEL_MATRIX, renderer->GetTransform()->GetLocalToWorldMatrix());
+                    chunk.shader_requests.Add({ material.get(), keywords });
+                }
+            }
+            else
+            {
+                shader = material->GetShaderAsync(keywords);
+            }
+            if (!shader)
+            {
+                return;
+            }
 
-                    if (skin && skin->GetBonesUniformBuffer())
-                    {
-                        material->SetVectorArray(SkinnedMeshRendererUniforms::BONES, skin->GetBoneVectors());
-                    }
+            material->SetScissor(this->GetTargetWidth(), this->GetTargetHeight());
+
+            for (int j = 0; j < shader->GetPassCount(); ++j)
+            {
+                bool has_light = shader->GetPass(j).light_mode == Shader::LightMode::Forward;
+                if (!has_light && light_add)
+                {
+                    continue;
                 }
 
-                filament::backend::RenderPrimitiveHandle primitive;
+                material->Bind(shader, j);
+                chunk.counters.AddMaterialBind();
 
-                auto primitives = renderer->GetPrimitives();
-                if (i < primitives.Size())
+                if (!batch && renderer->HasPropertyBlock())
                 {
-                    primitive = primitives[i];
+                    renderer->BindPropertyBlock(material_index, shader, j);
                 }
-                else if (primitives.Size() > 0)
+                else if (batch && batch->block_renderer)
                 {
-                    primitive = primitives[0];
+                    batch->block_renderer->BindPropertyBlock(batch->block_material_index, shader, j);
                 }
 
-                if (primitive)
+                const auto& pipeline = shader->GetPass(j).pipeline;
+                if (item && item->range_count > 0)
                 {
-                    auto keywords = renderer->GetShaderKeywords();
-                    if (shadow_enable && renderer->IsRecieveShadow())
+                    // static batch root draws index ranges of visible members on one primitive
+                    for (int k = item->range_begin; k < item->range_begin + item->range_count; ++k)
                     {
-                        keywords.Add("RECIEVE_SHADOW_ON");
-                    }
-                    if (light_add)
-                    {
-                        keywords.Add("LIGHT_ADD_ON");
-                    }
-                    
-                    const auto& shader = material->GetShader(keywords);
-
-                    material->SetScissor(this->GetTargetWidth(), this->GetTargetHeight());
-
-                    for (int j = 0; j < shader->GetPassCount(); ++j)
-                    {
-                        bool has_light = shader->GetPass(j).light_mode == Shader::LightMode::Forward;
-                        if (!has_light && light_add)
-                        {
-                            continue;
-                        }
-
-                        material->Bind(shader, j);
-
-                        const auto& pipeline = shader->GetPass(j).pipeline;
-                        driver.draw(pipeline, primitive);
-                        Time::SetDrawCall(Time::GetDrawCall() + 1);
+                        const auto& range = m_static_batch_ranges[k];
+                        driver.setRenderPrimitiveRange(primitive, filament::backend::PrimitiveType::TRIANGLES, range.index_first, 0, vertex_max, range.index_count);
+                        driver.draw(pipeline, primitive, 1);
+                        chunk.counters.AddDraw(pipeline, range.index_count, 1);
                     }
                 }
+                else
+                {
+                    driver.draw(pipeline, primitive, instance_count);
+                    chunk.counters.AddDraw(pipeline, index_count, (int) instance_count);
+                }
             }
         }
     }
@@ -510,7 +1122,7 @@ namespace Viry3D
                 material->Bind(shader, j);
 
                 const auto& pipeline = shader->GetPass(j).pipeline;
-                driver.draw(pipeline, primitive);
+                driver.draw(pipeline, primitive, 1);
             }
         }
     }
@@ -523,6 +1135,8 @@ namespace Viry3D
 
 	void Camera::PostProcessing()
 	{
+		PROFILE_SCOPE("Camera::PostProcessing");
+
 		Vector<Ref<Viry3D::PostProcessing>> coms = this->GetGameObject()->GetComponents<Viry3D::PostProcessing>();
 		if (coms.Size() == 0)
 		{
@@ -705,7 +1319,7 @@ namespace Viry3D
 			material->Prepare(pass);
 
 			auto& driver = Engine::Instance()->GetDriverApi();
-			driver.beginRenderPass(dst->target, params);
+			BindingCache::BeginRenderPass(dst->target, params);
 
 			const auto& shader = material->GetShader();
 			material->SetScissor(target_width, target_height);
@@ -721,10 +1335,11 @@ namespace Viry3D
 			for (int i = pass_begin; i < pass_end; ++i)
 			{
 				material->Bind(shader, i);
+				RenderStats::GetCounters().AddMaterialBind();
 
 				const auto& pipeline = shader->GetPass(i).pipeline;
-				driver.draw(pipeline, primitive);
-				Time::SetDrawCall(Time::GetDrawCall() + 1);
+				driver.draw(pipeline, primitive, 1);
+				RenderStats::GetCounters().AddDraw(pipeline, m_quad_mesh->GetSubmeshes()[0].index_count, 1);
 			}
 
 			driver.endRenderPass();
@@ -747,7 +1362,11 @@ namespace Viry3D
 		m_view_matrix_dirty(true),
 		m_projection_matrix_dirty(true),
 		m_view_matrix_external(false),
-		m_projection_matrix_external(false)
+		m_projection_matrix_external(false),
+		m_cluster_light_enable(false),
+		m_instancing_enable(true),
+		m_instance_batch_count(0),
+		m_instance_uniform_buffer_count(0)
     {
 		m_cameras.AddLast(this);
 		m_cameras_order_dirty = true;
@@ -763,6 +1382,12 @@ namespace Viry3D
 			m_view_uniform_buffer.clear();
 		}
 
+		for (int i = 0; i < m_instance_uniform_buffers.Size(); ++i)
+		{
+			driver.destroyUniformBuffer(m_instance_uniform_buffers[i]);
+		}
+		m_instance_uniform_buffers.Clear();
+
 		if (m_render_target)
 		{
 			driver.destroyRenderTarget(m_render_target);
@@ -922,6 +1547,16 @@ namespace Viry3D
 		return m_projection_matrix;
 	}
 
+	void Camera::EnableClusterLight(bool enable)
+	{
+		m_cluster_light_enable = enable;
+	}
+
+	void Camera::EnableInstancing(bool enable)
+	{
+		m_instancing_enable = enable;
+	}
+
 	void Camera::SetViewMatrixExternal(const Matrix4x4& mat)
 	{
 		m_view_matrix = mat;
@@ -21,6 +21,9 @@
 #include "CameraClearFlags.h"
 #include "Color.h"
 #include "Material.h"
+#include "DrawItem.h"
+#include "LightClusters.h"
+#include "RenderStats.h"
 #include "math/Rect.h"
 #include "math/Matrix4x4.h"
 #include "container/List.h"
@@ -30,8 +33,10 @@ namespace Viry3D
 {
 	class Texture;
     class Renderer;
+    class MeshRenderer;
 	class RenderTarget;
 	class Mesh;
+	class Light;
 
     class Camera : public Component
     {
@@ -43,6 +48,9 @@ namespace Viry3D
 		static void RenderAll();
         static void OnResizeAll(int width, int height);
 		static void Blit(const Ref<RenderTarget>& src, const Ref<RenderTarget>& dst, const Ref<Material>& mat = Ref<Material>(), int pass = -1);
+		// draw mesh instances in next render by cameras whose culling mask contains layer,
+		// material shader must support instancing, not drawn on gles 2.0
+		static void DrawMeshInstanced(const Ref<Mesh>& mesh, int submesh, const Ref<Material>& material, const Vector<Matrix4x4>& matrices, int layer = 0);
 		Camera();
         virtual ~Camera();
 		int GetDepth() const { return m_depth; }
@@ -81,17 +89,88 @@ namespace Viry3D
         Vector3 ScreenToWorldPoint(const Vector3& position);
         Vector3 WorldToScreenPoint(const Vector3& position);
         Ray ScreenPointToRay(const Vector3& position);
+		// shade cluster light shaders in one pass with lights binned per view froxel
+		bool IsClusterLightEnable() const { return m_cluster_light_enable; }
+		void EnableClusterLight(bool enable);
+		// merge renderers sharing mesh and material into instanced draws
+		bool IsInstancingEnable() const { return m_instancing_enable; }
+		void EnableInstancing(bool enable);
 
 	protected:
 		virtual void OnTransformDirty();
 
+	private:
+		// renderers or mesh instances drawn in one instanced draw,
+		// item index is -1 for instances from DrawMeshInstanced
+		struct InstanceBatch
+		{
+			Ref<Material> material;
+			filament::backend::RenderPrimitiveHandle primitive;
+			int index_count;
+			Shader::KeywordMask keywords;
+			bool recieve_shadow;
+			Vector<Light*> lights;
+			Vector<Matrix4x4> matrices;
+			int item_index;
+			filament::backend::UniformBufferHandle uniform_buffer;
+			// instances have identical property blocks, first renderer binds its block for all
+			Renderer* block_renderer;
+			int block_material_index;
+		};
+
+		struct InstancedMesh
+		{
+			Ref<Mesh> mesh;
+			int submesh;
+			Ref<Material> material;
+			Vector<Matrix4x4> matrices;
+			int layer;
+		};
+
+		// visible member of a static batch, drawn by its root as part of an index range
+		struct StaticBatchMember
+		{
+			MeshRenderer* root;
+			int index;
+		};
+
+		struct IndexRange
+		{
+			int index_first;
+			int index_count;
+		};
+
+		struct ShaderRequest
+		{
+			Material* material;
+			Shader::KeywordMask keywords;
+		};
+
+		// state of one chunk of draw items, chunks may be recorded in parallel on job system.
+		// shader variants not ready are looked up on main thread after recording
+		struct DrawChunk
+		{
+			bool parallel = false;
+			Vector<ShaderRequest> shader_requests;
+			RenderCounters counters;
+		};
+
 	private:
         void OnResize(int width, int height);
-        void CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result);
+        // returns renderers outside of frustum
+        int CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result);
 		void UpdateViewUniforms();
+		bool IsClusterLightActive() const;
+		void UpdateLightClusters();
+		void BuildDrawItems(const List<Renderer*>& renderers);
+		void AddStaticBatchRanges(MeshRenderer* root, int material_index, const StaticBatchMember* members, int member_count);
+		bool IsInstancingActive() const;
+		void BuildInstanceBatches();
+		InstanceBatch& AddInstanceBatch();
+		filament::backend::UniformBufferHandle UploadInstances(const Matrix4x4* matrices, int count);
 		void Draw(const List<Renderer*>& renderers);
-        void DrawRenderer(Renderer* renderer);
-        void DoDraw(Renderer* renderer, bool shadow_enable = false, bool light_add = false);
+        void DrawRenderer(const DrawItem* item, const InstanceBatch* batch, DrawChunk& chunk);
+        void DoDraw(const DrawItem* item, bool shadow_enable, bool light_add, bool cluster_light, const InstanceBatch* batch, DrawChunk& chunk);
         void DrawRendererBounds(Renderer* renderer);
 		bool HasPostProcessing();
 		void PostProcessing();
@@ -103,6 +182,7 @@ namespace Viry3D
 		static bool m_cameras_order_dirty;
 		static Ref<Mesh> m_quad_mesh;
 		static Ref<Material> m_blit_material;
+		static Vector<InstancedMesh> m_instanced_meshes;
 		int m_depth;
         uint32_t m_culling_mask;
 		CameraClearFlags m_clear_flags;
@@ -126,5 +206,20 @@ namespace Viry3D
 		ViewUniforms m_view_uniforms;
 		filament::backend::UniformBufferHandle m_view_uniform_buffer;
 		filament::backend::RenderTargetHandle m_render_target;
+		Vector<DrawItem> m_draw_items;
+		Vector<DrawItem> m_draw_items_temp;
+		Vector<Light*> m_renderer_lights;
+		Vector<Light*> m_item_lights;
+		Vector<StaticBatchMember> m_static_batch_members;
+		Vector<IndexRange> m_static_batch_ranges;
+		bool m_cluster_light_enable;
+		Ref<LightClusters> m_light_clusters;
+		Vector<LightClusters::ClusterLight> m_cluster_lights;
+		bool m_instancing_enable;
+		Vector<InstanceBatch> m_instance_batches;
+		int m_instance_batch_count;
+		Vector<filament::backend::UniformBufferHandle> m_instance_uniform_buffers;
+		int m_instance_uniform_buffer_count;
+		Vector<DrawChunk> m_draw_chunks;
     };
 }
@@ -0,0 +1,104 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "DrawItem.h"
+#include "Shader.h"
+#include "math/Mathf.h"
+#include "memory/Memory.h"
+
+namespace Viry3D
+{
+    uint64_t DrawItem::MakeKey(int queue, uint32_t shader_id, uint32_t material_id, float depth)
+    {
+        const uint64_t depth_max = (1 << 24) - 1;
+
+        uint64_t queue_bits = (uint64_t) Mathf::Clamp(queue, 0, (1 << 14) - 1);
+        uint64_t shader_bits = shader_id & ((1 << 12) - 1);
+        uint64_t material_bits = material_id & ((1 << 14) - 1);
+        uint64_t depth_bits = (uint64_t) (Mathf::Clamp01(depth) * depth_max);
+
+        uint64_t key = queue_bits << 50;
+        if (queue <= (int) Shader::Queue::AlphaTest)
+        {
+            // front to back, grouped by state first
+            key |= shader_bits << 38;
+            key |= material_bits << 24;
+            key |= depth_bits;
+        }
+        else
+        {
+            // back to front
+            key |= (depth_max - depth_bits) << 26;
+            key |= shader_bits << 14;
+            key |= material_bits;
+        }
+
+        return key;
+    }
+
+    void DrawItem::Sort(Vector<DrawItem>& items, Vector<DrawItem>& temp)
+    {
+        int count = items.Size();
+        if (count <= 1)
+        {
+            return;
+        }
+
+        temp.Resize(count);
+
+        DrawItem* src = &items[0];
+        DrawItem* dst = &temp[0];
+        int offsets[256];
+
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            Memory::Zero(offsets, sizeof(offsets));
+            for (int i = 0; i < count; ++i)
+            {
+                offsets[(src[i].key >> shift) & 0xff]++;
+            }
+
+            // all keys have same byte, nothing to do in this pass
+            if (offsets[(src[0].key >> shift) & 0xff] == count)
+            {
+                continue;
+            }
+
+            int sum = 0;
+            for (int i = 0; i < 256; ++i)
+            {
+                int n = offsets[i];
+                offsets[i] = sum;
+                sum += n;
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+            }
+
+            DrawItem* swap = src;
+            src = dst;
+            dst = swap;
+        }
+
+        if (src != &items[0])
+        {
+            Memory::Copy(&items[0], src, count * sizeof(DrawItem));
+        }
+    }
+}
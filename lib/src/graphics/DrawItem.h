@@ -0,0 +1,49 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "container/Vector.h"
+#include <stdint.h>
+
+namespace Viry3D
+{
+    class Renderer;
+
+    // one material of a renderer, sorted by a packed 64 bit key
+    // opaque:      queue 14 | shader 12 | material 14 | depth 24
+    // transparent: queue 14 | inverse depth 24 | shader 12 | material 14
+    struct DrawItem
+    {
+        uint64_t key;
+        Renderer* renderer;
+        int material_index;
+        // camera instance batch drawn in place of this item, -1 if not instanced
+        int instance_batch;
+        // range of camera light list, culled once per renderer
+        int light_begin;
+        int light_count;
+        // range of camera index ranges drawn in place of whole submesh, static batch root only
+        int range_begin;
+        int range_count;
+
+        // depth is view depth normalized to 0 ~ 1
+        static uint64_t MakeKey(int queue, uint32_t shader_id, uint32_t material_id, float depth);
+        // stable radix sort by key, temp is scratch space reused between frames
+        static void Sort(Vector<DrawItem>& items, Vector<DrawItem>& temp);
+    };
+}
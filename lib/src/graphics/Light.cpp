@@ -17,29 +17,75 @@
 
 #include "Light.h"
 #include "Engine.h"
+#include "Profiler.h"
 #include "Material.h"
 #include "GameObject.h"
 #include "Renderer.h"
 #include "SkinnedMeshRenderer.h"
 #include "Texture.h"
-#include "time/Time.h"
+#include "BindingCache.h"
+#include "RenderStats.h"
+#include <algorithm>
 
 namespace Viry3D
 {
 	List<Light*> Light::m_lights;
 	Color Light::m_ambient_color(0, 0, 0, 0);
+	filament::backend::UniformBufferHandle Light::m_ambient_uniform_buffer;
+	bool Light::m_ambient_dirty = true;
 
 	void Light::SetAmbientColor(const Color& color)
 	{
 		m_ambient_color = color;
+		m_ambient_dirty = true;
 		for (auto i : m_lights)
 		{
 			i->m_dirty = true;
 		}
 	}
 
+	void Light::PrepareAmbient()
+	{
+		auto& driver = Engine::Instance()->GetDriverApi();
+		if (!m_ambient_uniform_buffer)
+		{
+			m_ambient_uniform_buffer = driver.createUniformBuffer(sizeof(LightFragmentUniforms), filament::backend::BufferUsage::DYNAMIC);
+			m_ambient_dirty = true;
+		}
+
+		if (!m_ambient_dirty)
+		{
+			return;
+		}
+		m_ambient_dirty = false;
+
+		// directional light with black color adds nothing over ambient
+		LightFragmentUniforms light_uniforms = { };
+		light_uniforms.ambient_color = m_ambient_color;
+		light_uniforms.light_pos = Vector4(0, 1, 0, 0);
+		light_uniforms.light_color = Color(0, 0, 0, (float) LightType::Directional);
+
+		void* buffer = driver.allocate(sizeof(LightFragmentUniforms));
+		Memory::Copy(buffer, &light_uniforms, sizeof(LightFragmentUniforms));
+		driver.loadUniformBuffer(m_ambient_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(LightFragmentUniforms)));
+		RenderStats::AddUniformUpload(sizeof(LightFragmentUniforms));
+	}
+
+	void Light::Done()
+	{
+		if (m_ambient_uniform_buffer)
+		{
+			auto& driver = Engine::Instance()->GetDriverApi();
+			driver.destroyUniformBuffer(m_ambient_uniform_buffer);
+			m_ambient_uniform_buffer.clear();
+		}
+		m_ambient_dirty = true;
+	}
+
 	void Light::RenderShadowMaps()
 	{
+		PROFILE_SCOPE("Light::RenderShadowMaps");
+
 		for (auto i : m_lights)
 		{
 			if (i->GetGameObject()->IsActiveInTree() &&
@@ -51,10 +97,61 @@ namespace Viry3D
 				i->CullRenderers(Renderer::GetRenderers(), renderers);
 				i->UpdateViewUniforms();
 				i->Draw(renderers);
+				RenderStats::AddShadowCasters(renderers.Size());
 			}
 		}
 	}
 
+	void Light::CullLights(Renderer* renderer, Vector<Light*>& result)
+	{
+		Light::CullLights(renderer->GetWorldBounds(), renderer->GetGameObject()->GetLayer(), renderer->GetMaxLightCount(), result);
+	}
+
+	void Light::CullLights(const Bounds& bounds, int layer, int max_count, Vector<Light*>& result)
+	{
+		struct LightInfluence
+		{
+			Light* light;
+			float influence;
+		};
+		static thread_local Vector<LightInfluence> influences;
+		influences.Clear();
+
+		result.Clear();
+
+		bool has_bounds = bounds.GetSize().SqrMagnitude() > 0;
+
+		for (auto i : m_lights)
+		{
+			if (((1 << layer) & i->GetCullingMask()) == 0 ||
+				!i->GetGameObject()->IsActiveInTree() ||
+				!i->IsEnable())
+			{
+				continue;
+			}
+
+			// renderers without bounds are lighted by all lights
+			float influence = has_bounds ? i->GetInfluence(bounds) : i->GetIntensity();
+			if (influence > 0)
+			{
+				influences.Add({ i, influence });
+			}
+		}
+
+		if (max_count >= 0 && influences.Size() > max_count)
+		{
+			std::stable_sort(influences.begin(), influences.end(), [](const LightInfluence& a, const LightInfluence& b) {
+				return a.influence > b.influence;
+			});
+			influences.Resize(max_count);
+		}
+
+		for (const auto& i : influences)
+		{
+			result.Add(i.light);
+		}
+	}
+
 	void Light::CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result)
 	{
 		for (auto i : renderers)
@@ -65,29 +162,44 @@ namespace Viry3D
 				result.AddLast(i);
 			}
 		}
-		result.Sort([](Renderer* a, Renderer* b) {
-			const auto& materials_a = a->GetMaterials();
-			int queue_a = 0;
-			for (int i = 0; i < materials_a.Size(); ++i)
+	}
+
+	void Light::BuildDrawItems(const List<Renderer*>& renderers)
+	{
+		m_draw_items.Clear();
+
+		Vector3 light_pos = this->GetTransform()->GetPosition();
+		Vector3 light_forward = this->GetTransform()->GetForward();
+		float depth_scale = 1.0f / m_far_clip;
+
+		for (auto i : renderers)
+		{
+			// static batch root casts shadow of all members with whole submeshes
+			if (i->IsStaticBatched() && static_cast<MeshRenderer*>(i)->IsStaticBatchMember())
 			{
-				int queue = materials_a[i]->GetQueue();
-				if (queue_a < queue)
-				{
-					queue_a = queue;
-				}
+				continue;
 			}
-			const auto& materials_b = b->GetMaterials();
-			int queue_b = 0;
-			for (int i = 0; i < materials_b.Size(); ++i)
+
+			Bounds bounds = i->GetWorldBounds();
+			Vector3 center = bounds.GetSize().SqrMagnitude() > 0 ? bounds.GetCenter() : i->GetTransform()->GetPosition();
+			float depth = (center - light_pos).Dot(light_forward) * depth_scale;
+
+			const auto& materials = i->GetMaterials();
+			for (int j = 0; j < materials.Size(); ++j)
 			{
-				int queue = materials_b[i]->GetQueue();
-				if (queue_b < queue)
+				const auto& material = materials[j];
+				if (material)
 				{
-					queue_b = queue;
+					DrawItem item;
+					item.key = DrawItem::MakeKey(material->GetQueue(), material->GetShader()->GetId(), material->GetId(), depth);
+					item.renderer = i;
+					item.material_index = j;
+					m_draw_items.Add(item);
 				}
 			}
-			return queue_a < queue_b;
-		});
+		}
+
+		DrawItem::Sort(m_draw_items, m_draw_items_temp);
 	}
 
 	void Light::UpdateViewUniforms()
@@ -112,6 +224,7 @@ namespace Viry3D
 		void* buffer = driver.allocate(sizeof(ViewUniforms));
 		Memory::Copy(buffer, &view_uniforms, sizeof(ViewUniforms));
 		driver.loadUniformBuffer(m_view_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(ViewUniforms)));
+		RenderStats::AddUniformUpload(sizeof(ViewUniforms));
 	}
 
 	void Light::Draw(const List<Renderer*>& renderers)
@@ -156,13 +269,16 @@ namespace Viry3D
 		params.viewport.width = (uint32_t) target_width;
 		params.viewport.height = (uint32_t) target_height;
 
-		driver.beginRenderPass(target, params);
+		BindingCache::BeginRenderPass(target, params);
 
-		driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerView, m_view_uniform_buffer);
+		BindingCache::BindUniformBuffer(Shader::BindingPoint::PerView, m_view_uniform_buffer);
 
-		for (auto i : renderers)
+		this->BuildDrawItems(renderers);
+
+		for (const auto& i : m_draw_items)
 		{
-			this->DrawRenderer(i);
+			this->DrawRenderer(i.renderer, i.material_index);
+			Engine::Instance()->FlushCommandsIfNeeded();
 		}
 
 		driver.endRenderPass();
@@ -170,63 +286,70 @@ namespace Viry3D
 		driver.flush();
 	}
 
-	void Light::DrawRenderer(Renderer* renderer)
+	void Light::DrawRenderer(Renderer* renderer, int material_index)
 	{
 		auto& driver = Engine::Instance()->GetDriverApi();
 
-		driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerRenderer, renderer->GetTransformUniformBuffer());
+		BindingCache::BindUniformBuffer(Shader::BindingPoint::PerRenderer, renderer->GetTransformUniformBuffer());
 
 		SkinnedMeshRenderer* skin = dynamic_cast<SkinnedMeshRenderer*>(renderer);
 		if (skin && skin->GetBonesUniformBuffer())
 		{
-			driver.bindUniformBuffer((size_t) Shader::BindingPoint::PerRendererBones, skin->GetBonesUniformBuffer());
+			BindingCache::BindUniformBuffer(Shader::BindingPoint::PerRendererBones, skin->GetBonesUniformBuffer());
+		}
+		if (skin && skin->GetBonesSamplerGroup())
+		{
+			BindingCache::BindSamplers(Shader::BindingPoint::PerRenderer, skin->GetBonesSamplerGroup());
 		}
 
-		const auto& materials = renderer->GetMaterials();
-		for (int i = 0; i < materials.Size(); ++i)
+		const auto& material = renderer->GetMaterials()[material_index];
+		if (material)
 		{
-			auto& material = materials[i];
-			if (material)
+			filament::backend::RenderPrimitiveHandle primitive;
+			int index_count = 0;
+
+			auto primitives = renderer->GetPrimitives();
+			if (material_index < primitives.Size())
 			{
-				filament::backend::RenderPrimitiveHandle primitive;
+				primitive = primitives[material_index];
+				index_count = renderer->GetPrimitiveIndexCount(material_index);
+			}
 
-				auto primitives = renderer->GetPrimitives();
-				if (i < primitives.Size())
-				{
-					primitive = primitives[i];
-				}
-				else
+			if (primitive)
+			{
+				const auto& shader = material->GetShaderAsync(renderer->GetShaderKeywordMask());
+				if (!shader)
 				{
-					break;
+					return;
 				}
 
-				if (primitive)
-				{
-					const auto& shader = material->GetShader(renderer->GetShaderKey(i));
-
-					material->SetScissor(m_shadow_texture_size, m_shadow_texture_size);
+				material->SetScissor(m_shadow_texture_size, m_shadow_texture_size);
 
-					for (int j = 0; j < shader->GetPassCount(); ++j)
+				for (int j = 0; j < shader->GetPassCount(); ++j)
+				{
+					if (shader->GetPass(j).queue <= (int) Shader::Queue::AlphaTest &&
+						shader->GetPass(j).pipeline.rasterState.depthWrite)
 					{
-						if (shader->GetPass(j).queue <= (int) Shader::Queue::AlphaTest &&
-							shader->GetPass(j).pipeline.rasterState.depthWrite)
+						material->Bind(shader, j);
+						RenderStats::GetCounters().AddMaterialBind();
+
+						Ref<Shader> shadow_shader;
+						if (skin && skin->IsBonesTextureEnable())
 						{
-							material->Bind(shader, j);
-
-							Ref<Shader> shadow_shader;
-							if (skin && skin->GetBonePaths().Size() > 0)
-							{
-								shadow_shader = Shader::Find("ShadowMap", { "SKIN_ON" });
-							}
-							else
-							{
-								shadow_shader = Shader::Find("ShadowMap");
-							}
-
-							const auto& pipeline = shadow_shader->GetPass(0).pipeline;
-							driver.draw(pipeline, primitive);
-							Time::SetDrawCall(Time::GetDrawCall() + 1);
+							shadow_shader = Shader::Find("ShadowMap", { "SKIN_ON", "SKIN_TEXTURE_ON" });
 						}
+						else if (skin && skin->GetBonePaths().Size() > 0)
+						{
+							shadow_shader = Shader::Find("ShadowMap", { "SKIN_ON" });
+						}
+						else
+						{
+							shadow_shader = Shader::Find("ShadowMap");
+						}
+
+						const auto& pipeline = shadow_shader->GetPass(0).pipeline;
+						driver.draw(pipeline, primitive, 1);
+						RenderStats::GetCounters().AddDraw(pipeline, index_count, 1);
 					}
 				}
 			}
@@ -470,6 +593,50 @@ namespace Viry3D
 		return m_projection_matrix;
 	}
 
+	float Light::GetInfluence(const Bounds& bounds) const
+	{
+		if (m_type == LightType::Directional)
+		{
+			return m_intensity;
+		}
+
+		const Vector3& light_pos = this->GetTransform()->GetPosition();
+		const Vector3& min = bounds.Min();
+		const Vector3& max = bounds.Max();
+
+		// squared distance from light to closest point of bounds
+		Vector3 closest(
+			Mathf::Clamp(light_pos.x, min.x, max.x),
+			Mathf::Clamp(light_pos.y, min.y, max.y),
+			Mathf::Clamp(light_pos.z, min.z, max.z));
+		float sqr_distance = (closest - light_pos).SqrMagnitude();
+		float sqr_range = m_range * m_range;
+		if (sqr_distance > sqr_range)
+		{
+			return 0;
+		}
+
+		if (m_type == LightType::Spot)
+		{
+			// cone against bounding sphere of bounds
+			Vector3 center = bounds.GetCenter();
+			float radius = bounds.GetSize().Magnitude() * 0.5f;
+			Vector3 dir = this->GetTransform()->GetForward();
+			Vector3 v = center - light_pos;
+			float v_sqr_len = v.SqrMagnitude();
+			float v_dir_len = v.Dot(dir);
+			float half_angle = m_spot_angle * 0.5f * Mathf::Deg2Rad;
+			float closest_distance = cos(half_angle) * sqrt(Mathf::Max(v_sqr_len - v_dir_len * v_dir_len, 0.0f)) - v_dir_len * sin(half_angle);
+
+			if (closest_distance > radius || v_dir_len < -radius)
+			{
+				return 0;
+			}
+		}
+
+		return m_intensity * (1.0f - sqr_distance / sqr_range);
+	}
+
 	void Light::SetCullingMask(uint32_t mask)
 	{
 		m_culling_mask = mask;
@@ -519,5 +686,6 @@ namespace Viry3D
 		void* buffer = driver.allocate(sizeof(LightFragmentUniforms));
 		Memory::Copy(buffer, &light_uniforms, sizeof(LightFragmentUniforms));
 		driver.loadUniformBuffer(m_light_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(LightFragmentUniforms)));
+		RenderStats::AddUniformUpload(sizeof(LightFragmentUniforms));
 	}
 }
@@ -21,6 +21,8 @@
 #include "container/List.h"
 #include "Color.h"
 #include "math/Matrix4x4.h"
+#include "math/Bounds.h"
+#include "DrawItem.h"
 #include "private/backend/DriverApi.h"
 
 namespace Viry3D
@@ -41,7 +43,15 @@ namespace Viry3D
 		static const List<Light*>& GetLights() { return m_lights; }
 		static const Color& GetAmbientColor() { return m_ambient_color; }
 		static void SetAmbientColor(const Color& color);
+		// ambient only light uniforms, bound for renderers reached by no light
+		static const filament::backend::UniformBufferHandle& GetAmbientUniformBuffer() { return m_ambient_uniform_buffer; }
+		static void PrepareAmbient();
+		static void Done();
 		static void RenderShadowMaps();
+		// collect active lights whose range reaches renderer, most important first if count is limited
+		static void CullLights(Renderer* renderer, Vector<Light*>& result);
+		// cull by world bounds and layer, empty bounds are lighted by all lights
+		static void CullLights(const Bounds& bounds, int layer, int max_count, Vector<Light*>& result);
 		Light();
         virtual ~Light();
 		LightType GetType() const { return m_type; }
@@ -69,6 +79,8 @@ namespace Viry3D
 		const filament::backend::UniformBufferHandle& GetViewUniformBuffer() const { return m_view_uniform_buffer; }
 		const filament::backend::UniformBufferHandle& GetLightUniformBuffer() const { return m_light_uniform_buffer; }
 		const filament::backend::SamplerGroupHandle& GetSamplerGroup() const { return m_sampler_group; }
+		// estimated light contribution to world bounds, 0 if out of range
+		float GetInfluence(const Bounds& bounds) const;
 
 	protected:
 		virtual void OnTransformDirty();
@@ -78,8 +90,9 @@ namespace Viry3D
 		const Matrix4x4& GetProjectionMatrix();
 		void CullRenderers(const List<Renderer*>& renderers, List<Renderer*>& result);
 		void UpdateViewUniforms();
+		void BuildDrawItems(const List<Renderer*>& renderers);
 		void Draw(const List<Renderer*>& renderers);
-		void DrawRenderer(Renderer* renderer);
+		void DrawRenderer(Renderer* renderer, int material_index);
 		void Prepare();
 
 	private:
@@ -88,6 +101,8 @@ namespace Viry3D
     private:
 		static List<Light*> m_lights;
 		static Color m_ambient_color;
+		static filament::backend::UniformBufferHandle m_ambient_uniform_buffer;
+		static bool m_ambient_dirty;
 		bool m_dirty;
         LightType m_type;
 		Color m_color;
@@ -112,5 +127,7 @@ namespace Viry3D
 		filament::backend::UniformBufferHandle m_light_uniform_buffer;
 		filament::backend::SamplerGroupHandle m_sampler_group;
 		filament::backend::RenderTargetHandle m_render_target;
+		Vector<DrawItem> m_draw_items;
+		Vector<DrawItem> m_draw_items_temp;
     };
 }
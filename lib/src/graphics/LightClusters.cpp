@@ -0,0 +1,445 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "LightClusters.h"
+#include "RenderStats.h"
+#include "Engine.h"
+#include "GameObject.h"
+#include "math/Mathf.h"
+#include "memory/Memory.h"
+#include "thread/JobSystem.h"
+
+namespace Viry3D
+{
+    void LightClusters::CollectLights(Vector<ClusterLight>& lights)
+    {
+        lights.Clear();
+
+        for (auto i : Light::GetLights())
+        {
+            if (i->GetGameObject()->IsActiveInTree() && i->IsEnable())
+            {
+                ClusterLight light;
+                light.type = i->GetType();
+                light.position = i->GetTransform()->GetPosition();
+                light.direction = i->GetTransform()->GetForward();
+                light.color = i->GetColor();
+                light.intensity = i->GetIntensity();
+                light.range = i->GetRange();
+                light.spot_angle = i->GetSpotAngle();
+                lights.Add(light);
+            }
+        }
+    }
+
+    LightClusters::LightClusters():
+        m_near_clip(0),
+        m_far_clip(0),
+        m_orthographic(false),
+        m_directional_count(0),
+        m_light_count(0),
+        m_dropped_index_count(0)
+    {
+        m_cluster_bounds.Resize(CLUSTER_COUNT);
+        m_cluster_masks.Resize(CLUSTER_COUNT);
+        m_projection_matrix = Matrix4x4::Identity();
+        Memory::Zero(&m_light_uniforms, sizeof(m_light_uniforms));
+        Memory::Zero(&m_index_uniforms, sizeof(m_index_uniforms));
+    }
+
+    LightClusters::~LightClusters()
+    {
+        if (m_light_uniform_buffer || m_index_uniform_buffer)
+        {
+            auto& driver = Engine::Instance()->GetDriverApi();
+
+            if (m_light_uniform_buffer)
+            {
+                driver.destroyUniformBuffer(m_light_uniform_buffer);
+                m_light_uniform_buffer.clear();
+            }
+            if (m_index_uniform_buffer)
+            {
+                driver.destroyUniformBuffer(m_index_uniform_buffer);
+                m_index_uniform_buffer.clear();
+            }
+        }
+    }
+
+    float LightClusters::GetSliceDepth(int slice) const
+    {
+        float t = slice / (float) CLUSTER_Z;
+
+        if (m_orthographic)
+        {
+            return m_near_clip + (m_far_clip - m_near_clip) * t;
+        }
+        else
+        {
+            return m_near_clip * pow(m_far_clip / m_near_clip, t);
+        }
+    }
+
+    int LightClusters::GetDepthSlice(float depth) const
+    {
+        const Vector4& cluster_depth = m_light_uniforms.cluster_depth;
+        float z = cluster_depth.z > 0 ? log(Mathf::Max(depth, m_near_clip)) : depth;
+        int slice = (int) floor(z * cluster_depth.x + cluster_depth.y);
+        return Mathf::Clamp(slice, 0, CLUSTER_Z - 1);
+    }
+
+    void LightClusters::UpdateClusterBounds(const Matrix4x4& projection_matrix, float near_clip, float far_clip, bool orthographic)
+    {
+        if (memcmp(&m_projection_matrix, &projection_matrix, sizeof(Matrix4x4)) == 0 &&
+            m_near_clip == near_clip &&
+            m_far_clip == far_clip &&
+            m_orthographic == orthographic)
+        {
+            return;
+        }
+
+        m_projection_matrix = projection_matrix;
+        m_near_clip = near_clip;
+        m_far_clip = far_clip;
+        m_orthographic = orthographic;
+
+        Vector4& cluster_depth = m_light_uniforms.cluster_depth;
+        if (m_orthographic)
+        {
+            cluster_depth.x = CLUSTER_Z / (m_far_clip - m_near_clip);
+            cluster_depth.y = -m_near_clip * cluster_depth.x;
+            cluster_depth.z = 0;
+        }
+        else
+        {
+            cluster_depth.x = CLUSTER_Z / log(m_far_clip / m_near_clip);
+            cluster_depth.y = -log(m_near_clip) * cluster_depth.x;
+            cluster_depth.z = 1;
+        }
+        cluster_depth.w = 0;
+
+        Matrix4x4 inverse_projection = m_projection_matrix.Inverse();
+
+        for (int z = 0; z < CLUSTER_Z; ++z)
+        {
+            // view looks at -z, find ndc depth of slice planes
+            float ndc_z[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                ndc_z[i] = m_projection_matrix.MultiplyPoint(Vector3(0, 0, -this->GetSliceDepth(z + i))).z;
+            }
+
+            for (int y = 0; y < CLUSTER_Y; ++y)
+            {
+                float ndc_y[2] = { y * 2.0f / CLUSTER_Y - 1, (y + 1) * 2.0f / CLUSTER_Y - 1 };
+
+                for (int x = 0; x < CLUSTER_X; ++x)
+                {
+                    float ndc_x[2] = { x * 2.0f / CLUSTER_X - 1, (x + 1) * 2.0f / CLUSTER_X - 1 };
+
+                    Vector3 min(Mathf::MaxFloatValue, Mathf::MaxFloatValue, Mathf::MaxFloatValue);
+                    Vector3 max(-Mathf::MaxFloatValue, -Mathf::MaxFloatValue, -Mathf::MaxFloatValue);
+
+                    for (int i = 0; i < 8; ++i)
+                    {
+                        Vector3 corner = inverse_projection.MultiplyPoint(Vector3(ndc_x[i & 1], ndc_y[(i >> 1) & 1], ndc_z[(i >> 2) & 1]));
+                        min = Vector3::Min(min, corner);
+                        max = Vector3::Max(max, corner);
+                    }
+
+                    auto& bounds = m_cluster_bounds[(z * CLUSTER_Y + y) * CLUSTER_X + x];
+                    bounds.min = min;
+                    bounds.max = max;
+                }
+            }
+        }
+    }
+
+    void LightClusters::Build(
+        const Matrix4x4& view_matrix,
+        const Matrix4x4& projection_matrix,
+        float near_clip,
+        float far_clip,
+        bool orthographic,
+        const Vector<ClusterLight>& lights,
+        JobSystem* job_system)
+    {
+        this->UpdateClusterBounds(projection_matrix, near_clip, far_clip, orthographic);
+
+        m_light_uniforms.ambient_color = Light::GetAmbientColor();
+        m_light_count = 0;
+        m_directional_count = 0;
+        m_light_volumes.Clear();
+
+        // directional lights first, then local lights
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int i = 0; i < lights.Size(); ++i)
+            {
+                const auto& light = lights[i];
+                bool directional = light.type == LightType::Directional;
+
+                if ((pass == 0) != directional || m_light_count >= ClusterLightUniforms::LIGHT_MAX_COUNT)
+                {
+                    continue;
+                }
+
+                Vector4* uniforms = &m_light_uniforms.lights[m_light_count * 4];
+                Vector4& light_pos = uniforms[0];
+                Vector4& light_color = uniforms[1];
+                Vector4& light_atten = uniforms[2];
+                Vector4& spot_light_dir = uniforms[3];
+
+                if (directional)
+                {
+                    light_pos = Vector4(-light.direction, 0.0f);
+                }
+                else
+                {
+                    light_pos = Vector4(light.position, 1.0f);
+                }
+                Color color = light.color * light.intensity;
+                light_color = Vector4(color.r, color.g, color.b, (float) light.type);
+                light_atten = Vector4(0, 0, 0, 0);
+                spot_light_dir = Vector4(0, 0, 0, 0);
+                if (!directional)
+                {
+                    light_atten.z = 1.0f / (light.range * light.range);
+                }
+                if (light.type == LightType::Spot)
+                {
+                    light_atten.x = cos(light.spot_angle / 2 * Mathf::Deg2Rad);
+                    light_atten.y = 1.0f / (light_atten.x - cos(light.spot_angle / 4 * Mathf::Deg2Rad));
+                    spot_light_dir = Vector4(-light.direction, 0.0f);
+                }
+
+                if (directional)
+                {
+                    m_directional_count += 1;
+                }
+                else
+                {
+                    LightVolume volume;
+                    volume.center = view_matrix.MultiplyPoint3x4(light.position);
+                    volume.radius = light.range;
+                    volume.direction = view_matrix.MultiplyDirection(light.direction);
+                    volume.cos_angle = cos(light.spot_angle / 2 * Mathf::Deg2Rad);
+                    volume.sin_angle = sin(light.spot_angle / 2 * Mathf::Deg2Rad);
+                    volume.spot = light.type == LightType::Spot;
+
+                    float depth_min = -volume.center.z - volume.radius;
+                    float depth_max = -volume.center.z + volume.radius;
+                    if (depth_max < m_near_clip || depth_min > m_far_clip)
+                    {
+                        volume.z_begin = 0;
+                        volume.z_end = 0;
+                    }
+                    else
+                    {
+                        volume.z_begin = this->GetDepthSlice(depth_min);
+                        volume.z_end = this->GetDepthSlice(depth_max) + 1;
+                    }
+
+                    volume.x_begin = 0;
+                    volume.x_end = CLUSTER_X;
+                    volume.y_begin = 0;
+                    volume.y_end = CLUSTER_Y;
+
+                    // screen rect of sphere box, keep full screen if it crosses near plane
+                    if (m_orthographic || depth_min > m_near_clip)
+                    {
+                        float ndc_min_x = Mathf::MaxFloatValue;
+                        float ndc_min_y = Mathf::MaxFloatValue;
+                        float ndc_max_x = -Mathf::MaxFloatValue;
+                        float ndc_max_y = -Mathf::MaxFloatValue;
+
+                        for (int j = 0; j < 8; ++j)
+                        {
+                            Vector3 corner = volume.center + Vector3(
+                                (j & 1) ? volume.radius : -volume.radius,
+                                (j & 2) ? volume.radius : -volume.radius,
+                                (j & 4) ? volume.radius : -volume.radius);
+                            Vector3 ndc = m_projection_matrix.MultiplyPoint(corner);
+                            ndc_min_x = Mathf::Min(ndc_min_x, ndc.x);
+                            ndc_min_y = Mathf::Min(ndc_min_y, ndc.y);
+                            ndc_max_x = Mathf::Max(ndc_max_x, ndc.x);
+                            ndc_max_y = Mathf::Max(ndc_max_y, ndc.y);
+                        }
+
+                        volume.x_begin = Mathf::Clamp((int) floor((ndc_min_x * 0.5f + 0.5f) * CLUSTER_X), 0, CLUSTER_X);
+                        volume.x_end = Mathf::Clamp((int) floor((ndc_max_x * 0.5f + 0.5f) * CLUSTER_X) + 1, 0, CLUSTER_X);
+                        volume.y_begin = Mathf::Clamp((int) floor((ndc_min_y * 0.5f + 0.5f) * CLUSTER_Y), 0, CLUSTER_Y);
+                        volume.y_end = Mathf::Clamp((int) floor((ndc_max_y * 0.5f + 0.5f) * CLUSTER_Y) + 1, 0, CLUSTER_Y);
+                    }
+
+                    m_light_volumes.Add(volume);
+                }
+
+                m_light_count += 1;
+            }
+        }
+
+        m_light_uniforms.cluster_size = Vector4((float) CLUSTER_X, (float) CLUSTER_Y, (float) CLUSTER_Z, (float) m_directional_count);
+
+        if (job_system)
+        {
+            job_system->ParallelFor(0, CLUSTER_Z, 1, [this](int begin, int end) {
+                this->BinSlices(begin, end);
+            });
+        }
+        else
+        {
+            this->BinSlices(0, CLUSTER_Z);
+        }
+
+        this->PackIndices();
+    }
+
+    void LightClusters::BinSlices(int slice_begin, int slice_end)
+    {
+        for (int z = slice_begin; z < slice_end; ++z)
+        {
+            uint64_t* masks = &m_cluster_masks[z * CLUSTER_Y * CLUSTER_X];
+            Memory::Zero(masks, sizeof(uint64_t) * CLUSTER_Y * CLUSTER_X);
+
+            for (int i = 0; i < m_light_volumes.Size(); ++i)
+            {
+                const auto& volume = m_light_volumes[i];
+                if (z < volume.z_begin || z >= volume.z_end)
+                {
+                    continue;
+                }
+
+                uint64_t bit = ((uint64_t) 1) << (m_directional_count + i);
+                float sqr_radius = volume.radius * volume.radius;
+
+                for (int y = volume.y_begin; y < volume.y_end; ++y)
+                {
+                    for (int x = volume.x_begin; x < volume.x_end; ++x)
+                    {
+                        int index = (z * CLUSTER_Y + y) * CLUSTER_X + x;
+                        const auto& bounds = m_cluster_bounds[index];
+
+                        // sphere against cluster box
+                        Vector3 closest(
+                            Mathf::Clamp(volume.center.x, bounds.min.x, bounds.max.x),
+                            Mathf::Clamp(volume.center.y, bounds.min.y, bounds.max.y),
+                            Mathf::Clamp(volume.center.z, bounds.min.z, bounds.max.z));
+                        if ((closest - volume.center).SqrMagnitude() > sqr_radius)
+                        {
+                            continue;
+                        }
+
+                        // cone against cluster bounding sphere
+                        if (volume.spot)
+                        {
+                            Vector3 center = (bounds.min + bounds.max) * 0.5f;
+                            float radius = (bounds.max - bounds.min).Magnitude() * 0.5f;
+                            Vector3 v = center - volume.center;
+                            float v_dir_len = v.Dot(volume.direction);
+                            float closest_distance = volume.cos_angle * sqrt(Mathf::Max(v.SqrMagnitude() - v_dir_len * v_dir_len, 0.0f)) - v_dir_len * volume.sin_angle;
+
+                            if (closest_distance > radius || v_dir_len < -radius)
+                            {
+                                continue;
+                            }
+                        }
+
+                        masks[y * CLUSTER_X + x] |= bit;
+                    }
+                }
+            }
+        }
+    }
+
+    void LightClusters::PackIndices()
+    {
+        uint32_t* records = m_index_uniforms.indices;
+        uint32_t* words = &m_index_uniforms.indices[CLUSTER_COUNT];
+        int offset = 0;
+
+        m_dropped_index_count = 0;
+        Memory::Zero(words, sizeof(uint32_t) * (ClusterLightIndexUniforms::INDEX_MAX_COUNT - CLUSTER_COUNT));
+
+        for (int i = 0; i < CLUSTER_COUNT; ++i)
+        {
+            uint64_t mask = m_cluster_masks[i];
+            int begin = offset;
+
+            for (int j = m_directional_count; mask != 0 && j < m_light_count; ++j)
+            {
+                uint64_t bit = ((uint64_t) 1) << j;
+                if ((mask & bit) == 0)
+                {
+                    continue;
+                }
+                mask &= ~bit;
+
+                if (offset < LIGHT_INDEX_MAX_COUNT)
+                {
+                    words[offset >> 2] |= ((uint32_t) j) << ((offset & 3) * 8);
+                    offset += 1;
+                }
+                else
+                {
+                    m_dropped_index_count += 1;
+                }
+            }
+
+            records[i] = ((uint32_t) begin) | (((uint32_t) (offset - begin)) << 16);
+        }
+    }
+
+    void LightClusters::GetClusterLights(int x, int y, int z, Vector<int>& lights) const
+    {
+        lights.Clear();
+
+        uint32_t record = m_index_uniforms.indices[(z * CLUSTER_Y + y) * CLUSTER_X + x];
+        int offset = (int) (record & 0xffff);
+        int count = (int) (record >> 16);
+        const uint32_t* words = &m_index_uniforms.indices[CLUSTER_COUNT];
+
+        for (int i = offset; i < offset + count; ++i)
+        {
+            lights.Add((int) ((words[i >> 2] >> ((i & 3) * 8)) & 0xff));
+        }
+    }
+
+    void LightClusters::Upload()
+    {
+        auto& driver = Engine::Instance()->GetDriverApi();
+
+        if (!m_light_uniform_buffer)
+        {
+            m_light_uniform_buffer = driver.createUniformBuffer(sizeof(ClusterLightUniforms), filament::backend::BufferUsage::DYNAMIC);
+        }
+        if (!m_index_uniform_buffer)
+        {
+            m_index_uniform_buffer = driver.createUniformBuffer(sizeof(ClusterLightIndexUniforms), filament::backend::BufferUsage::DYNAMIC);
+        }
+
+        void* buffer = Memory::Alloc<void>(sizeof(ClusterLightUniforms));
+        Memory::Copy(buffer, &m_light_uniforms, sizeof(ClusterLightUniforms));
+        driver.loadUniformBuffer(m_light_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(ClusterLightUniforms), FreeBufferCallback));
+        RenderStats::AddUniformUpload(sizeof(ClusterLightUniforms));
+
+        buffer = Memory::Alloc<void>(sizeof(ClusterLightIndexUniforms));
+        Memory::Copy(buffer, &m_index_uniforms, sizeof(ClusterLightIndexUniforms));
+        driver.loadUniformBuffer(m_index_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(ClusterLightIndexUniforms), FreeBufferCallback));
+        RenderStats::AddUniformUpload(sizeof(ClusterLightIndexUniforms));
+    }
+}
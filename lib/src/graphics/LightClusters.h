@@ -0,0 +1,123 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "Light.h"
+#include "Material.h"
+#include "container/Vector.h"
+#include "math/Matrix4x4.h"
+#include "private/backend/DriverApi.h"
+
+namespace Viry3D
+{
+    class JobSystem;
+
+    // bins point and spot lights into view space froxels for clustered forward lighting,
+    // directional lights are stored first in light list and applied everywhere.
+    // index buffer holds one record per cluster (index offset | light count << 16),
+    // followed by light indices packed 4 bytes per uint
+    class LightClusters
+    {
+    public:
+        static constexpr int CLUSTER_X = 16;
+        static constexpr int CLUSTER_Y = 8;
+        static constexpr int CLUSTER_Z = 16;
+        static constexpr int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+        static constexpr int LIGHT_INDEX_MAX_COUNT = (ClusterLightIndexUniforms::INDEX_MAX_COUNT - CLUSTER_COUNT) * 4;
+
+        struct ClusterLight
+        {
+            LightType type;
+            Vector3 position;
+            Vector3 direction;
+            Color color;
+            float intensity;
+            float range;
+            float spot_angle;
+        };
+
+        // collect active and enabled scene lights
+        static void CollectLights(Vector<ClusterLight>& lights);
+        LightClusters();
+        ~LightClusters();
+        // cpu only, job system is optional and runs depth slices in parallel
+        void Build(
+            const Matrix4x4& view_matrix,
+            const Matrix4x4& projection_matrix,
+            float near_clip,
+            float far_clip,
+            bool orthographic,
+            const Vector<ClusterLight>& lights,
+            JobSystem* job_system = nullptr);
+        // lights in list order, directional lights are not included
+        void GetClusterLights(int x, int y, int z, Vector<int>& lights) const;
+        int GetLightCount() const { return m_light_count; }
+        // light indices not written because index buffer is full
+        int GetDroppedIndexCount() const { return m_dropped_index_count; }
+        const ClusterLightUniforms& GetLightUniforms() const { return m_light_uniforms; }
+        const ClusterLightIndexUniforms& GetIndexUniforms() const { return m_index_uniforms; }
+        void Upload();
+        const filament::backend::UniformBufferHandle& GetLightUniformBuffer() const { return m_light_uniform_buffer; }
+        const filament::backend::UniformBufferHandle& GetIndexUniformBuffer() const { return m_index_uniform_buffer; }
+
+    private:
+        struct ClusterBounds
+        {
+            Vector3 min;
+            Vector3 max;
+        };
+
+        struct LightVolume
+        {
+            Vector3 center;
+            float radius;
+            Vector3 direction;
+            float cos_angle;
+            float sin_angle;
+            bool spot;
+            int x_begin;
+            int x_end;
+            int y_begin;
+            int y_end;
+            int z_begin;
+            int z_end;
+        };
+
+        void UpdateClusterBounds(const Matrix4x4& projection_matrix, float near_clip, float far_clip, bool orthographic);
+        float GetSliceDepth(int slice) const;
+        int GetDepthSlice(float depth) const;
+        void BinSlices(int slice_begin, int slice_end);
+        void PackIndices();
+
+    private:
+        Vector<ClusterBounds> m_cluster_bounds;
+        Vector<uint64_t> m_cluster_masks;
+        Vector<LightVolume> m_light_volumes;
+        Matrix4x4 m_projection_matrix;
+        float m_near_clip;
+        float m_far_clip;
+        bool m_orthographic;
+        int m_directional_count;
+        int m_light_count;
+        int m_dropped_index_count;
+        ClusterLightUniforms m_light_uniforms;
+        ClusterLightIndexUniforms m_index_uniforms;
+        filament::backend::UniformBufferHandle m_light_uniform_buffer;
+        filament::backend::UniformBufferHandle m_index_uniform_buffer;
+    };
+}
@@ -17,7 +17,11 @@
 
 #include "Material.h"
 #include "Engine.h"
+#include "Profiler.h"
 #include "Camera.h"
+#include "BindingCache.h"
+#include "MaterialPropertyBlock.h"
+#include "math/Mathf.h"
 
 namespace Viry3D
 {
@@ -44,13 +48,13 @@ namespace Viry3D
     }
 
     Material::Material(const Ref<Shader>& shader):
-        m_scissor_rect(0, 0, 1, 1)
+        m_scissor_rect(0, 0, 1, 1),
+        m_uniform_version(0)
     {
         ShaderVariant variant;
-        variant.key = shader->GetShaderKey();
-        variant.keywords = shader->GetKeywords();
+        variant.keywords = shader->GetKeywordMask();
         variant.shader = shader;
-        m_shader_variants.Add(variant.key, variant);
+        this->AddShaderVariant(variant);
 
         m_unifrom_buffers.Resize(shader->GetPassCount());
         for (int i = 0; i < m_unifrom_buffers.Size(); ++i)
@@ -77,11 +81,7 @@ namespace Viry3D
         {
             for (int j = 0; j < m_unifrom_buffers[i].Size(); ++j)
             {
-                if (m_unifrom_buffers[i][j].uniform_buffer)
-                {
-                    driver.destroyUniformBuffer(m_unifrom_buffers[i][j].uniform_buffer);
-					m_unifrom_buffers[i][j].uniform_buffer.clear();
-                }
+                UniformBufferPool::Free(m_unifrom_buffers[i][j].slice);
             }
         }
         m_unifrom_buffers.Clear();
@@ -102,30 +102,145 @@ namespace Viry3D
 
     const String& Material::GetShaderName()
     {
-        return m_shader_variants.begin()->second.shader->GetName();
+        return m_shader_variants[0].shader->GetName();
     }
 
     const Ref<Shader>& Material::GetShader()
     {
-        return m_shader_variants.begin()->second.shader;
+        return m_shader_variants[0].shader;
     }
 
-    const Ref<Shader>& Material::GetShader(const String& key)
+    const Ref<Shader>& Material::GetShader(Shader::KeywordMask keywords)
     {
-        assert(m_shader_variants.Contains(key));
-        return m_shader_variants[key].shader;
+        int index = this->FindShaderVariant(keywords);
+        if (index >= 0 && !m_shader_variants[index].compiling)
+        {
+            return m_shader_variants[index].shader;
+        }
+
+        // shaders created from passes have no source to compile variants
+        if (this->GetShaderName().Size() == 0)
+        {
+            return this->GetShader();
+        }
+
+        this->EnableKeywords(keywords);
+        return m_shader_variants[this->FindShaderVariant(keywords)].shader;
+    }
+
+    const Ref<Shader>& Material::GetShaderAsync(Shader::KeywordMask keywords)
+    {
+        if (this->GetShaderName().Size() == 0 || Engine::Instance()->GetThreadPool() == nullptr)
+        {
+            return this->GetShader(keywords);
+        }
+
+        int index = this->FindShaderVariant(keywords);
+        if (index < 0)
+        {
+            ShaderVariant variant;
+            variant.keywords = keywords;
+            variant.compiling = true;
+            this->AddShaderVariant(variant);
+            index = this->FindShaderVariant(keywords);
+        }
+
+        // compiling variants share one future per shader key
+        auto& variant = m_shader_variants[index];
+        if (variant.compiling)
+        {
+            auto future = Shader::FindAsync(this->GetShaderName(), keywords);
+            if (future.IsReady())
+            {
+                variant.shader = future.Get();
+                variant.compiling = false;
+            }
+        }
+
+        return variant.shader;
+    }
+
+    Ref<Shader> Material::PeekShader(Shader::KeywordMask keywords) const
+    {
+        // shaders created from passes have no source to compile variants
+        if (m_shader_variants[0].shader->GetName().Size() == 0)
+        {
+            return m_shader_variants[0].shader;
+        }
+
+        int index = this->FindShaderVariant(keywords);
+        if (index >= 0 && !m_shader_variants[index].compiling)
+        {
+            return m_shader_variants[index].shader;
+        }
+
+        return Ref<Shader>();
     }
 
     const Ref<Shader>& Material::GetShader(const Vector<String>& keywords)
     {
-        if (this->GetShaderName().Size() > 0)
+        return this->GetShader(Shader::KeywordsToMask(keywords));
+    }
+
+    static inline uint32_t HashKeywordMask(Shader::KeywordMask keywords)
+    {
+        uint64_t h = keywords * 0x9E3779B97F4A7C15ULL;
+        return (uint32_t) (h >> 32);
+    }
+
+    int Material::FindShaderVariant(Shader::KeywordMask keywords) const
+    {
+        int mask = m_shader_variant_table.Size() - 1;
+        int slot = (int) (HashKeywordMask(keywords) & mask);
+
+        while (true)
+        {
+            int index = m_shader_variant_table[slot];
+            if (index < 0)
+            {
+                return -1;
+            }
+            if (m_shader_variants[index].keywords == keywords)
+            {
+                return index;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    void Material::AddShaderVariant(const ShaderVariant& variant)
+    {
+        m_shader_variants.Add(variant);
+
+        // keep load factor under half, rehash on grow
+        if (m_shader_variant_table.Size() < m_shader_variants.Size() * 2)
         {
-            auto key = this->EnableKeywords(keywords);
-            return this->GetShader(key);
+            int size = Mathf::Max(m_shader_variant_table.Size() * 2, 8);
+            m_shader_variant_table.Resize(size);
+            for (int i = 0; i < size; ++i)
+            {
+                m_shader_variant_table[i] = -1;
+            }
+
+            for (int i = 0; i < m_shader_variants.Size(); ++i)
+            {
+                int slot = (int) (HashKeywordMask(m_shader_variants[i].keywords) & (size - 1));
+                while (m_shader_variant_table[slot] >= 0)
+                {
+                    slot = (slot + 1) & (size - 1);
+                }
+                m_shader_variant_table[slot] = i;
+            }
         }
         else
         {
-            return this->GetShader();
+            int mask = m_shader_variant_table.Size() - 1;
+            int slot = (int) (HashKeywordMask(variant.keywords) & mask);
+            while (m_shader_variant_table[slot] >= 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_shader_variant_table[slot] = m_shader_variants.Size() - 1;
         }
     }
 
@@ -136,7 +251,7 @@ namespace Viry3D
             return *m_queue;
         }
         
-        return m_shader_variants.begin()->second.shader->GetQueue();
+        return m_shader_variants[0].shader->GetQueue();
     }
     
     void Material::SetQueue(int queue)
@@ -144,113 +259,105 @@ namespace Viry3D
         m_queue = RefMake<int>(queue);
     }
     
-    const Matrix4x4* Material::GetMatrix(const String& name) const
+    const MaterialProperty* Material::FindProperty(int id) const
     {
-        return this->GetProperty<Matrix4x4>(name, MaterialProperty::Type::Matrix);
+        if (id < m_property_indices.Size() && m_property_indices[id] >= 0)
+        {
+            return &m_properties[m_property_indices[id]];
+        }
+        return nullptr;
+    }
+
+    MaterialProperty* Material::SetPropertyDirty(int id, MaterialProperty::Type type)
+    {
+        if (id >= m_property_indices.Size())
+        {
+            m_property_indices.Resize(id + 1, -1);
+        }
+
+        if (m_property_indices[id] < 0)
+        {
+            MaterialProperty property;
+            property.name = Shader::IDToProperty(id);
+            property.id = id;
+            property.dirty = false;
+            m_property_indices[id] = m_properties.Size();
+            m_properties.Add(property);
+        }
+
+        int index = m_property_indices[id];
+        MaterialProperty* property_ptr = &m_properties[index];
+        property_ptr->type = type;
+        if (!property_ptr->dirty)
+        {
+            property_ptr->dirty = true;
+            m_dirty_properties.Add(index);
+        }
+        return property_ptr;
+    }
+    
+    const Matrix4x4* Material::GetMatrix(int id) const
+    {
+        return this->GetProperty<Matrix4x4>(id, MaterialProperty::Type::Matrix);
     }
     
-    void Material::SetMatrix(const String& name, const Matrix4x4& value)
+    void Material::SetMatrix(int id, const Matrix4x4& value)
     {
-        this->SetProperty(name, value, MaterialProperty::Type::Matrix);
+        this->SetProperty(id, value, MaterialProperty::Type::Matrix);
     }
     
-    const Vector4* Material::GetVector(const String& name) const
+    const Vector4* Material::GetVector(int id) const
     {
-        return this->GetProperty<Vector4>(name, MaterialProperty::Type::Vector);
+        return this->GetProperty<Vector4>(id, MaterialProperty::Type::Vector);
     }
     
-    void Material::SetVector(const String& name, const Vector4& value)
+    void Material::SetVector(int id, const Vector4& value)
     {
-        this->SetProperty(name, value, MaterialProperty::Type::Vector);
+        this->SetProperty(id, value, MaterialProperty::Type::Vector);
     }
     
-    void Material::SetColor(const String& name, const Color& value)
+    void Material::SetColor(int id, const Color& value)
     {
-        this->SetProperty(name, value, MaterialProperty::Type::Color);
+        this->SetProperty(id, value, MaterialProperty::Type::Color);
     }
     
-    void Material::SetFloat(const String& name, float value)
+    void Material::SetFloat(int id, float value)
     {
-        this->SetProperty(name, value, MaterialProperty::Type::Float);
+        this->SetProperty(id, value, MaterialProperty::Type::Float);
     }
     
-    void Material::SetInt(const String& name, int value)
+    void Material::SetInt(int id, int value)
     {
-        this->SetProperty(name, value, MaterialProperty::Type::Int);
+        this->SetProperty(id, value, MaterialProperty::Type::Int);
     }
     
-    Ref<Texture> Material::GetTexture(const String& name) const
+    Ref<Texture> Material::GetTexture(int id) const
     {
         Ref<Texture> texture;
-        const MaterialProperty* property_ptr;
-        if (m_properties.TryGet(name, &property_ptr))
+        const MaterialProperty* property_ptr = this->FindProperty(id);
+        if (property_ptr && property_ptr->type == MaterialProperty::Type::Texture)
         {
-            if (property_ptr->type == MaterialProperty::Type::Texture)
-            {
-                texture = property_ptr->texture;
-            }
+            texture = property_ptr->texture;
         }
         return texture;
     }
     
-    void Material::SetTexture(const String& name, const Ref<Texture>& texture)
+    void Material::SetTexture(int id, const Ref<Texture>& texture)
     {
-        MaterialProperty* property_ptr;
-        if (m_properties.TryGet(name, &property_ptr))
-        {
-            property_ptr->type = MaterialProperty::Type::Texture;
-            property_ptr->texture = texture;
-            property_ptr->dirty = true;
-        }
-        else
-        {
-            MaterialProperty property;
-            property.name = name;
-            property.type = MaterialProperty::Type::Texture;
-            property.texture = texture;
-            property.dirty = true;
-            m_properties.Add(name, property);
-        }
+        MaterialProperty* property_ptr = this->SetPropertyDirty(id, MaterialProperty::Type::Texture);
+        property_ptr->texture = texture;
     }
     
-    void Material::SetVectorArray(const String& name, const Vector<Vector4>& array)
+    void Material::SetVectorArray(int id, const Vector<Vector4>& array)
     {
-        MaterialProperty* property_ptr;
-        if (m_properties.TryGet(name, &property_ptr))
-        {
-            property_ptr->type = MaterialProperty::Type::VectorArray;
-            property_ptr->vector_array = array;
-            property_ptr->dirty = true;
-        }
-        else
-        {
-            MaterialProperty property;
-            property.name = name;
-            property.type = MaterialProperty::Type::VectorArray;
-            property.vector_array = array;
-            property.dirty = true;
-            m_properties.Add(name, property);
-        }
+        MaterialProperty* property_ptr = this->SetPropertyDirty(id, MaterialProperty::Type::VectorArray);
+        property_ptr->vector_array = array;
     }
     
-    void Material::SetMatrixArray(const String& name, const Vector<Matrix4x4>& array)
+    void Material::SetMatrixArray(int id, const Vector<Matrix4x4>& array)
     {
-        MaterialProperty* property_ptr;
-        if (m_properties.TryGet(name, &property_ptr))
-        {
-            property_ptr->type = MaterialProperty::Type::MatrixArray;
-            property_ptr->matrix_array = array;
-            property_ptr->dirty = true;
-        }
-        else
-        {
-            MaterialProperty property;
-            property.name = name;
-            property.type = MaterialProperty::Type::MatrixArray;
-            property.matrix_array = array;
-            property.dirty = true;
-            m_properties.Add(name, property);
-        }
+        MaterialProperty* property_ptr = this->SetPropertyDirty(id, MaterialProperty::Type::MatrixArray);
+        property_ptr->matrix_array = array;
     }
     
     void Material::SetScissorRect(const Rect& rect)
@@ -258,47 +365,102 @@ namespace Viry3D
         m_scissor_rect = rect;
     }
 
-    String Material::EnableKeywords(const Vector<String>& keywords)
+    void Material::EnableKeywords(Shader::KeywordMask keywords)
 	{
-        String key = Shader::MakeKey(this->GetShaderName(), keywords);
-        if (!m_shader_variants.Contains(key))
+        int index = this->FindShaderVariant(keywords);
+        if (index < 0)
         {
             auto shader = Shader::Find(this->GetShaderName(), keywords);
 
             ShaderVariant variant;
-            variant.key = shader->GetShaderKey();
-            variant.keywords = shader->GetKeywords();
+            variant.keywords = keywords;
             variant.shader = shader;
-            m_shader_variants.Add(variant.key, variant);
+            this->AddShaderVariant(variant);
+        }
+        else if (m_shader_variants[index].compiling)
+        {
+            m_shader_variants[index].shader = Shader::Find(this->GetShaderName(), keywords);
+            m_shader_variants[index].compiling = false;
         }
-        return key;
 	}
 
+    // buffers uploaded again in the same or next frame move to frame ring,
+    // a new ring slice each time so draws already recorded keep their data
+    static void UploadUniformBuffer(UniformBuffer& unifrom_buffer)
+    {
+        uint32_t frame = UniformBufferPool::GetFrame();
+        bool dynamic = UniformBufferPool::IsRingEnable() && unifrom_buffer.upload_frame != 0 && unifrom_buffer.upload_frame + 1 >= frame;
+        int size = unifrom_buffer.buffer.Size();
+
+        unifrom_buffer.dirty = false;
+        unifrom_buffer.upload_frame = frame;
+
+        if (dynamic)
+        {
+            UniformBufferPool::Free(unifrom_buffer.slice);
+            unifrom_buffer.slice = UniformBufferPool::AllocFrame(size);
+        }
+        else if (!unifrom_buffer.slice.uniform_buffer || unifrom_buffer.slice.frame != 0)
+        {
+            UniformBufferPool::Free(unifrom_buffer.slice);
+            unifrom_buffer.slice = UniformBufferPool::Alloc(size);
+        }
+
+        UniformBufferPool::Write(unifrom_buffer.slice, unifrom_buffer.buffer.Bytes(), size);
+    }
+
+    // ring slice of an earlier frame is gone, move unchanged buffer back to a pooled slice
+    static void KeepUniformBuffer(UniformBuffer& unifrom_buffer)
+    {
+        if (unifrom_buffer.slice.frame != 0 && unifrom_buffer.slice.frame != UniformBufferPool::GetFrame())
+        {
+            unifrom_buffer.slice = UniformBufferPool::Alloc(unifrom_buffer.buffer.Size());
+            UniformBufferPool::Write(unifrom_buffer.slice, unifrom_buffer.buffer.Bytes(), unifrom_buffer.buffer.Size());
+        }
+    }
+
+    static void UploadSamplerGroup(filament::backend::DriverApi& driver, SamplerGroup& sampler_group)
+    {
+        sampler_group.dirty = false;
+
+        filament::backend::SamplerGroup samplers(sampler_group.samplers.Size());
+        for (int k = 0; k < sampler_group.samplers.Size(); ++k)
+        {
+            const auto& sampler = sampler_group.samplers[k];
+            if (sampler.texture)
+            {
+                samplers.setSampler(k, sampler.texture->GetTexture(), sampler.texture->GetSampler());
+            }
+        }
+        driver.updateSamplerGroup(sampler_group.sampler_group, std::move(samplers));
+    }
+
     void Material::Prepare(int pass)
     {
-        for (auto& i : m_properties)
+        PROFILE_SCOPE("Material::Prepare");
+
+        for (int i = 0; i < m_dirty_properties.Size(); ++i)
         {
-            if (i.second.dirty)
+            auto& property = m_properties[m_dirty_properties[i]];
+            property.dirty = false;
+            
+            switch (property.type)
             {
-                i.second.dirty = false;
-                
-                switch (i.second.type)
-                {
-                    case MaterialProperty::Type::Texture:
-                        this->UpdateUniformTexture(i.first, i.second.texture);
-                        break;
-                    case MaterialProperty::Type::VectorArray:
-                        this->UpdateUniformMember(i.first, i.second.vector_array.Bytes(), i.second.vector_array.SizeInBytes());
-                        break;
-                    case MaterialProperty::Type::MatrixArray:
-                        this->UpdateUniformMember(i.first, i.second.matrix_array.Bytes(), i.second.matrix_array.SizeInBytes());
-                        break;
-                    default:
-                        this->UpdateUniformMember(i.first, &i.second.data, i.second.size);
-                        break;
-                }
+                case MaterialProperty::Type::Texture:
+                    this->UpdateUniformTexture(property.id, property.texture);
+                    break;
+                case MaterialProperty::Type::VectorArray:
+                    this->UpdateUniformMember(property.id, property.vector_array.Bytes(), property.vector_array.SizeInBytes());
+                    break;
+                case MaterialProperty::Type::MatrixArray:
+                    this->UpdateUniformMember(property.id, property.matrix_array.Bytes(), property.matrix_array.SizeInBytes());
+                    break;
+                default:
+                    this->UpdateUniformMember(property.id, &property.data, property.size);
+                    break;
             }
         }
+        m_dirty_properties.Clear();
         
         auto& driver = Engine::Instance()->GetDriverApi();
         
@@ -317,11 +479,12 @@ namespace Viry3D
                 
                 if (unifrom_buffer.dirty)
                 {
-                    unifrom_buffer.dirty = false;
-                    
-                    void* buffer = Memory::Alloc<void>(unifrom_buffer.buffer.Size());
-                    Memory::Copy(buffer, unifrom_buffer.buffer.Bytes(), unifrom_buffer.buffer.Size());
-                    driver.loadUniformBuffer(unifrom_buffer.uniform_buffer, filament::backend::BufferDescriptor(buffer, unifrom_buffer.buffer.Size(), FreeBufferCallback));
+                    ++m_uniform_version;
+                    UploadUniformBuffer(unifrom_buffer);
+                }
+                else
+                {
+                    KeepUniformBuffer(unifrom_buffer);
                 }
             }
         }
@@ -341,104 +504,69 @@ namespace Viry3D
 
                 if (sampler_group.dirty)
                 {
-                    sampler_group.dirty = false;
-
-                    filament::backend::SamplerGroup samplers(sampler_group.samplers.Size());
-                    for (int k = 0; k < sampler_group.samplers.Size(); ++k)
-                    {
-                        const auto& sampler = sampler_group.samplers[k];
-                        if (sampler.texture)
-                        {
-                            samplers.setSampler(k, sampler.texture->GetTexture(), sampler.texture->GetSampler());
-                        }
-                    }
-                    driver.updateSamplerGroup(sampler_group.sampler_group, std::move(samplers));
+                    ++m_uniform_version;
+                    UploadSamplerGroup(driver, sampler_group);
                 }
             }
         }
     }
     
-    void Material::UpdateUniformMember(const String& name, const void* data, int size)
+    void Material::UpdateUniformMember(int id, const void* data, int size)
     {
-        auto& driver = Engine::Instance()->GetDriverApi();
-        const auto& shader = m_shader_variants.begin()->second.shader;
+        const auto& shader = m_shader_variants[0].shader;
 
-        for (int i = 0; i < shader->GetPassCount(); ++i)
+        int count;
+        const Shader::PropertyLocation* locations = shader->GetPropertyLocations(id, &count);
+        for (int i = 0; i < count; ++i)
         {
-            const auto& pass = shader->GetPass(i);
-            
-            for (int j = 0; j < pass.uniforms.Size(); ++j)
+            const auto& location = locations[i];
+            if (location.sampler)
             {
-                const auto& uniform = pass.uniforms[j];
-				bool find = false;
-                
-                for (int k = 0; k < uniform.members.Size(); ++k)
-                {
-                    const auto& member = uniform.members[k];
-                    
-                    if (name == member.name)
-                    {
-                        auto& unifrom_buffer = m_unifrom_buffers[i][uniform.binding];
-                        
-                        if (!unifrom_buffer.uniform_buffer)
-                        {
-                            unifrom_buffer.uniform_buffer = driver.createUniformBuffer(uniform.size, filament::backend::BufferUsage::DYNAMIC);
-                            unifrom_buffer.buffer = ByteBuffer(uniform.size);
-                        }
-                        
-                        assert(size <= member.size);
-                        
-                        Memory::Copy(&unifrom_buffer.buffer[member.offset], data, size);
-                        
-                        unifrom_buffer.dirty = true;
-
-						find = true;
-						break;
-                    }
-                }
+                continue;
+            }
 
-				if (find)
-				{
-					break;
-				}
+            auto& unifrom_buffer = m_unifrom_buffers[location.pass][location.binding];
+            
+            if (unifrom_buffer.buffer.Size() == 0)
+            {
+                unifrom_buffer.buffer = ByteBuffer(location.block_size);
             }
+            
+            assert(size <= location.size);
+            
+            Memory::Copy(&unifrom_buffer.buffer[location.offset], data, size);
+            
+            unifrom_buffer.dirty = true;
         }
     }
     
-    void Material::UpdateUniformTexture(const String& name, const Ref<Texture>& texture)
+    void Material::UpdateUniformTexture(int id, const Ref<Texture>& texture)
     {
         auto& driver = Engine::Instance()->GetDriverApi();
-        const auto& shader = m_shader_variants.begin()->second.shader;
+        const auto& shader = m_shader_variants[0].shader;
 
-        for (int i = 0; i < shader->GetPassCount(); ++i)
+        int count;
+        const Shader::PropertyLocation* locations = shader->GetPropertyLocations(id, &count);
+        for (int i = 0; i < count; ++i)
         {
-            const auto& pass = shader->GetPass(i);
-            
-            for (int j = 0; j < pass.samplers.Size(); ++j)
+            const auto& location = locations[i];
+            if (!location.sampler)
             {
-                const auto& group = pass.samplers[j];
-                
-                for (int k = 0; k < group.samplers.Size(); ++k)
-                {
-                    const auto& sampler = group.samplers[k];
+                continue;
+            }
 
-                    if (name == sampler.name)
-                    {
-                        auto& sampler_group = m_samplers[i][group.binding];
+            auto& sampler_group = m_samplers[location.pass][location.binding];
 
-                        if (!sampler_group.sampler_group)
-                        {
-                            sampler_group.sampler_group = driver.createSamplerGroup(group.samplers.Size());
-                            sampler_group.samplers.Resize(group.samplers.Size());
-                        }
+            if (!sampler_group.sampler_group)
+            {
+                sampler_group.sampler_group = driver.createSamplerGroup(location.block_size);
+                sampler_group.samplers.Resize(location.block_size);
+            }
 
-                        sampler_group.samplers[k].binding = sampler.binding;
-                        sampler_group.samplers[k].texture = texture;
+            sampler_group.samplers[location.offset].binding = location.size;
+            sampler_group.samplers[location.offset].texture = texture;
 
-                        sampler_group.dirty = true;
-                    }
-                }
-            }
+            sampler_group.dirty = true;
         }
     }
     
@@ -454,6 +582,51 @@ namespace Viry3D
 		driver.setViewportScissor(scissor_left, scissor_bottom, scissor_width, scissor_height);
     }
 
+    // gles 2.0 has no uniform blocks, properties are set on program by name
+    static void SetProgramUniform(filament::backend::DriverApi& driver, const filament::backend::ProgramHandle& program, const MaterialProperty& property)
+    {
+        switch (property.type)
+        {
+            case MaterialProperty::Type::Matrix:
+            {
+                void* buffer = driver.allocate(sizeof(Matrix4x4));
+                Memory::Copy(buffer, &property.data, sizeof(Matrix4x4));
+                driver.setUniformMatrix(
+                    program,
+                    property.name.CString(),
+                    1,
+                    filament::backend::BufferDescriptor(buffer, sizeof(Matrix4x4)));
+                break;
+            }
+            case MaterialProperty::Type::Vector:
+            case MaterialProperty::Type::Color:
+            {
+                void* buffer = driver.allocate(sizeof(Vector4));
+                Memory::Copy(buffer, &property.data, sizeof(Vector4));
+                driver.setUniformVector(
+                    program,
+                    property.name.CString(),
+                    1,
+                    filament::backend::BufferDescriptor(buffer, sizeof(Vector4)));
+                break;
+            }
+            case MaterialProperty::Type::VectorArray:
+            {
+                const auto& array = property.vector_array;
+                void* buffer = driver.allocate(array.SizeInBytes());
+                Memory::Copy(buffer, &array[0], array.SizeInBytes());
+                driver.setUniformVector(
+                    program,
+                    property.name.CString(),
+                    array.Size(),
+                    filament::backend::BufferDescriptor(buffer, array.SizeInBytes()));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
 	void Material::Bind(const Ref<Shader>& shader, int pass)
 	{
 		auto& driver = Engine::Instance()->GetDriverApi();
@@ -463,9 +636,9 @@ namespace Viry3D
 		// bind uniforms
 		for (int i = 0; i < unifrom_buffers.Size(); ++i)
 		{
-			if (unifrom_buffers[i].uniform_buffer)
+			if (unifrom_buffers[i].slice.uniform_buffer)
 			{
-				driver.bindUniformBuffer((size_t) i, unifrom_buffers[i].uniform_buffer);
+				BindingCache::BindUniformBuffer(i, unifrom_buffers[i].slice);
 			}
 		}
 
@@ -474,56 +647,234 @@ namespace Viry3D
         {
             if (samplers[i].sampler_group)
             {
-                driver.bindSamplers((size_t) i, samplers[i].sampler_group);
+                BindingCache::BindSamplers(i, samplers[i].sampler_group);
             }
         }
 
         if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
             Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
         {
-            for (auto& i : m_properties)
+            for (const auto& i : m_properties)
+            {
+                SetProgramUniform(driver, shader->GetPass(pass).pipeline.program, i);
+            }
+        }
+	}
+
+    void Material::CopyUniformBuffer(int pass, int binding, int size, UniformBuffer& dst) const
+    {
+        const auto& src = m_unifrom_buffers[pass][binding];
+        if (src.buffer.Size() == size)
+        {
+            Memory::Copy(dst.buffer.Bytes(), src.buffer.Bytes(), size);
+        }
+        else
+        {
+            Memory::Zero(dst.buffer.Bytes(), size);
+        }
+    }
+
+    void Material::CopySamplerGroup(int pass, int binding, int size, SamplerGroup& dst) const
+    {
+        const auto& src = m_samplers[pass][binding];
+        if (src.samplers.Size() == size)
+        {
+            dst.samplers = src.samplers;
+        }
+        else
+        {
+            dst.samplers.Clear();
+            dst.samplers.Resize(size);
+        }
+    }
+
+    void Material::PreparePropertyBlock(const MaterialPropertyBlock& block, PropertyBlockBuffers& buffers)
+    {
+        if (buffers.material == this &&
+            buffers.material_version == m_uniform_version &&
+            buffers.block_version == block.GetVersion())
+        {
+            for (auto& i : buffers.unifrom_buffers)
             {
-                switch (i.second.type)
+                for (auto& j : i)
                 {
-                    case MaterialProperty::Type::Matrix:
-                    {
-                        void* buffer = driver.allocate(sizeof(Matrix4x4));
-                        Memory::Copy(buffer, &i.second.data, sizeof(Matrix4x4));
-                        driver.setUniformMatrix(
-                            shader->GetPass(pass).pipeline.program,
-                            i.first.CString(),
-                            1,
-                            filament::backend::BufferDescriptor(buffer, sizeof(Matrix4x4)));
-                        break;
-                    }
-                    case MaterialProperty::Type::Vector:
-                    case MaterialProperty::Type::Color:
+                    KeepUniformBuffer(j);
+                }
+            }
+            return;
+        }
+
+        if (buffers.material != this)
+        {
+            ReleasePropertyBlock(buffers);
+
+            buffers.material = this;
+            buffers.unifrom_buffers.Resize(m_unifrom_buffers.Size());
+            for (int i = 0; i < buffers.unifrom_buffers.Size(); ++i)
+            {
+                buffers.unifrom_buffers[i].Resize((int) Shader::BindingPoint::Count);
+            }
+            buffers.samplers.Resize(m_samplers.Size());
+            for (int i = 0; i < buffers.samplers.Size(); ++i)
+            {
+                buffers.samplers[i].Resize((int) Shader::BindingPoint::Count);
+            }
+        }
+        buffers.material_version = m_uniform_version;
+        buffers.block_version = block.GetVersion();
+
+        auto& driver = Engine::Instance()->GetDriverApi();
+        const auto& shader = m_shader_variants[0].shader;
+
+        // start over from material values, properties not in block keep them
+        for (int i = 0; i < buffers.unifrom_buffers.Size(); ++i)
+        {
+            for (int j = 0; j < buffers.unifrom_buffers[i].Size(); ++j)
+            {
+                auto& unifrom_buffer = buffers.unifrom_buffers[i][j];
+                if (unifrom_buffer.buffer.Size() > 0)
+                {
+                    this->CopyUniformBuffer(i, j, unifrom_buffer.buffer.Size(), unifrom_buffer);
+                    unifrom_buffer.dirty = true;
+                }
+            }
+        }
+        for (int i = 0; i < buffers.samplers.Size(); ++i)
+        {
+            for (int j = 0; j < buffers.samplers[i].Size(); ++j)
+            {
+                auto& sampler_group = buffers.samplers[i][j];
+                if (sampler_group.sampler_group)
+                {
+                    this->CopySamplerGroup(i, j, sampler_group.samplers.Size(), sampler_group);
+                    sampler_group.dirty = true;
+                }
+            }
+        }
+
+        for (const auto& property : block.GetProperties())
+        {
+            int count;
+            const Shader::PropertyLocation* locations = shader->GetPropertyLocations(property.id, &count);
+            for (int i = 0; i < count; ++i)
+            {
+                const auto& location = locations[i];
+                bool texture = property.type == MaterialProperty::Type::Texture;
+
+                if (location.sampler && texture)
+                {
+                    auto& sampler_group = buffers.samplers[location.pass][location.binding];
+                    if (!sampler_group.sampler_group)
                     {
-                        void* buffer = driver.allocate(sizeof(Vector4));
-                        Memory::Copy(buffer, &i.second.data, sizeof(Vector4));
-                        driver.setUniformVector(
-                            shader->GetPass(pass).pipeline.program,
-                            i.first.CString(),
-                            1,
-                            filament::backend::BufferDescriptor(buffer, sizeof(Vector4)));
-                        break;
+                        sampler_group.sampler_group = driver.createSamplerGroup(location.block_size);
+                        this->CopySamplerGroup(location.pass, location.binding, location.block_size, sampler_group);
                     }
-                    case MaterialProperty::Type::VectorArray:
+
+                    sampler_group.samplers[location.offset].binding = location.size;
+                    sampler_group.samplers[location.offset].texture = property.texture;
+                    sampler_group.dirty = true;
+                }
+                else if (!location.sampler && !texture)
+                {
+                    auto& unifrom_buffer = buffers.unifrom_buffers[location.pass][location.binding];
+                    if (unifrom_buffer.buffer.Size() == 0)
                     {
-                        const auto& array = i.second.vector_array;
-                        void* buffer = driver.allocate(array.SizeInBytes());
-                        Memory::Copy(buffer, &array[0], array.SizeInBytes());
-                        driver.setUniformVector(
-                            shader->GetPass(pass).pipeline.program,
-                            i.first.CString(),
-                            array.Size(),
-                            filament::backend::BufferDescriptor(buffer, array.SizeInBytes()));
-                        break;
+                        unifrom_buffer.buffer = ByteBuffer(location.block_size);
+                        this->CopyUniformBuffer(location.pass, location.binding, location.block_size, unifrom_buffer);
                     }
-                    default:
-                        break;
+
+                    assert(property.size <= location.size);
+
+                    Memory::Copy(&unifrom_buffer.buffer[location.offset], &property.data, property.size);
+                    unifrom_buffer.dirty = true;
                 }
             }
         }
-	}
+
+        for (auto& i : buffers.unifrom_buffers)
+        {
+            for (auto& j : i)
+            {
+                if (j.dirty)
+                {
+                    UploadUniformBuffer(j);
+                }
+            }
+        }
+        for (auto& i : buffers.samplers)
+        {
+            for (auto& j : i)
+            {
+                if (j.dirty)
+                {
+                    UploadSamplerGroup(driver, j);
+                }
+            }
+        }
+    }
+
+    void Material::BindPropertyBlock(const Ref<Shader>& shader, int pass, const MaterialPropertyBlock& block, const PropertyBlockBuffers& buffers)
+    {
+        if (buffers.material != this)
+        {
+            return;
+        }
+
+        const auto& unifrom_buffers = buffers.unifrom_buffers[pass];
+        for (int i = 0; i < unifrom_buffers.Size(); ++i)
+        {
+            if (unifrom_buffers[i].slice.uniform_buffer)
+            {
+                BindingCache::BindUniformBuffer(i, unifrom_buffers[i].slice);
+            }
+        }
+
+        const auto& samplers = buffers.samplers[pass];
+        for (int i = 0; i < samplers.Size(); ++i)
+        {
+            if (samplers[i].sampler_group)
+            {
+                BindingCache::BindSamplers(i, samplers[i].sampler_group);
+            }
+        }
+
+        if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
+            Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
+        {
+            auto& driver = Engine::Instance()->GetDriverApi();
+            for (const auto& i : block.GetProperties())
+            {
+                SetProgramUniform(driver, shader->GetPass(pass).pipeline.program, i);
+            }
+        }
+    }
+
+    void Material::ReleasePropertyBlock(PropertyBlockBuffers& buffers)
+    {
+        auto& driver = Engine::Instance()->GetDriverApi();
+
+        for (auto& i : buffers.unifrom_buffers)
+        {
+            for (auto& j : i)
+            {
+                UniformBufferPool::Free(j.slice);
+            }
+        }
+        buffers.unifrom_buffers.Clear();
+
+        for (auto& i : buffers.samplers)
+        {
+            for (auto& j : i)
+            {
+                if (j.sampler_group)
+                {
+                    driver.destroySamplerGroup(j.sampler_group);
+                    j.sampler_group.clear();
+                }
+            }
+        }
+        buffers.samplers.Clear();
+
+        buffers.material = nullptr;
+    }
 }
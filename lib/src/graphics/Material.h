@@ -21,6 +21,7 @@
 #include "Shader.h"
 #include "Color.h"
 #include "Texture.h"
+#include "UniformBufferPool.h"
 #include "math/Matrix4x4.h"
 #include "math/Vector4.h"
 #include "math/Rect.h"
@@ -32,6 +33,8 @@
 namespace Viry3D
 {
     class Camera;
+    class Material;
+    class MaterialPropertyBlock;
     
 	// per view uniforms, set by camera
 	struct ViewUniforms
@@ -63,11 +66,25 @@ namespace Viry3D
 		Vector4 lightmap_index; // in x
 	};
 
-	// per renderer bones uniforms, set by skinned mesh renderer
+	// per draw instance model matrices, set by camera for instanced draws
+	struct InstanceUniforms
+	{
+		static constexpr const char* MODEL_MATRICES = "u_model_matrices";
+		static constexpr const int INSTANCE_MAX_COUNT = 256;
+
+		Matrix4x4 model_matrices[INSTANCE_MAX_COUNT];
+	};
+
+	// per renderer bones uniforms, set by skinned mesh renderer,
+	// each bone is packed as 3 rows of its 3x4 affine matrix
 	struct SkinnedMeshRendererUniforms
 	{
 		static constexpr const char* BONES = "u_bones";
 		static constexpr const int BONES_VECTOR_MAX_COUNT = 210;
+		// bones over uniform block budget are stored in a float texture, 3 texels per line for each bone
+		static constexpr const char* BONES_TEXTURE = "u_bones_texture";
+		static constexpr const int BONES_TEXTURE_MAX_COUNT = 1024;
+		static constexpr const int BONES_TEXTURE_WIDTH = 3;
 
 		Vector4 bones[BONES_VECTOR_MAX_COUNT];
 	};
@@ -90,6 +107,25 @@ namespace Viry3D
 		Vector4 shadow_params; // strength, z_bias, slope_bias, filter_radius
 	};
 
+	// per view clustered light list, set by camera
+	struct ClusterLightUniforms
+	{
+		static constexpr const int LIGHT_MAX_COUNT = 64;
+
+		Color ambient_color;
+		Vector4 cluster_size; // x, y, z cluster count, directional light count in w
+		Vector4 cluster_depth; // depth slice scale, bias, log depth in z
+		Vector4 lights[LIGHT_MAX_COUNT * 4]; // pos, color with light type in a, atten, spot dir
+	};
+
+	// per view cluster light indices, set by camera
+	struct ClusterLightIndexUniforms
+	{
+		static constexpr const int INDEX_MAX_COUNT = 4096;
+
+		uint32_t indices[INDEX_MAX_COUNT];
+	};
+
 	// per material uniforms, set by material
     struct MaterialProperty
     {
@@ -120,6 +156,7 @@ namespace Viry3D
         };
         
         String name;
+        int id = -1;
         Type type;
         Data data;
         Ref<Texture> texture;
@@ -129,11 +166,14 @@ namespace Viry3D
         bool dirty;
     };
     
+    // cpu data of a uniform block, uploaded into a pooled slice,
+    // or into frame ring while it changes every frame
     struct UniformBuffer
     {
-        filament::backend::UniformBufferHandle uniform_buffer;
+        UniformBufferSlice slice;
         ByteBuffer buffer;
         bool dirty = false;
+        uint32_t upload_frame = 0;
     };
     
     struct Sampler
@@ -149,11 +189,22 @@ namespace Viry3D
         bool dirty = false;
     };
 
+    // material pass buffers with property block values written over, owned by a renderer,
+    // buffers are only created for bindings the block overrides
+    struct PropertyBlockBuffers
+    {
+        const Material* material = nullptr;
+        uint32_t material_version = 0;
+        uint32_t block_version = 0;
+        Vector<Vector<UniformBuffer>> unifrom_buffers;
+        Vector<Vector<SamplerGroup>> samplers;
+    };
+
     struct ShaderVariant
     {
-        String key;
-        Vector<String> keywords;
+        Shader::KeywordMask keywords;
         Ref<Shader> shader;
+        bool compiling = false;
     };
     
     class Material : public Object
@@ -166,74 +217,90 @@ namespace Viry3D
         virtual ~Material();
         const String& GetShaderName();
         const Ref<Shader>& GetShader();
-        const Ref<Shader>& GetShader(const String& key);
+        const Ref<Shader>& GetShader(Shader::KeywordMask keywords);
         const Ref<Shader>& GetShader(const Vector<String>& keywords);
+        // null until variant is compiled on worker threads, compiles inline without thread pool
+        const Ref<Shader>& GetShaderAsync(Shader::KeywordMask keywords);
+        // read only lookup for recording draws on workers, null until GetShaderAsync has found
+        // variant compiled
+        Ref<Shader> PeekShader(Shader::KeywordMask keywords) const;
         int GetQueue() const;
         void SetQueue(int queue);
-        const Matrix4x4* GetMatrix(const String& name) const;
-        void SetMatrix(const String& name, const Matrix4x4& value);
-        const Vector4* GetVector(const String& name) const;
-        void SetVector(const String& name, const Vector4& value);
-        void SetColor(const String& name, const Color& value);
-        void SetFloat(const String& name, float value);
-        void SetInt(const String& name, int value);
-        Ref<Texture> GetTexture(const String& name) const;
-        void SetTexture(const String& name, const Ref<Texture>& texture);
-        void SetVectorArray(const String& name, const Vector<Vector4>& array);
-        void SetMatrixArray(const String& name, const Vector<Matrix4x4>& array);
+        const Matrix4x4* GetMatrix(const String& name) const { return this->GetMatrix(Shader::PropertyToID(name)); }
+        void SetMatrix(const String& name, const Matrix4x4& value) { this->SetMatrix(Shader::PropertyToID(name), value); }
+        const Vector4* GetVector(const String& name) const { return this->GetVector(Shader::PropertyToID(name)); }
+        void SetVector(const String& name, const Vector4& value) { this->SetVector(Shader::PropertyToID(name), value); }
+        void SetColor(const String& name, const Color& value) { this->SetColor(Shader::PropertyToID(name), value); }
+        void SetFloat(const String& name, float value) { this->SetFloat(Shader::PropertyToID(name), value); }
+        void SetInt(const String& name, int value) { this->SetInt(Shader::PropertyToID(name), value); }
+        Ref<Texture> GetTexture(const String& name) const { return this->GetTexture(Shader::PropertyToID(name)); }
+        void SetTexture(const String& name, const Ref<Texture>& texture) { this->SetTexture(Shader::PropertyToID(name), texture); }
+        void SetVectorArray(const String& name, const Vector<Vector4>& array) { this->SetVectorArray(Shader::PropertyToID(name), array); }
+        void SetMatrixArray(const String& name, const Vector<Matrix4x4>& array) { this->SetMatrixArray(Shader::PropertyToID(name), array); }
+        // property id versions, id from Shader::PropertyToID
+        const Matrix4x4* GetMatrix(int id) const;
+        void SetMatrix(int id, const Matrix4x4& value);
+        const Vector4* GetVector(int id) const;
+        void SetVector(int id, const Vector4& value);
+        void SetColor(int id, const Color& value);
+        void SetFloat(int id, float value);
+        void SetInt(int id, int value);
+        Ref<Texture> GetTexture(int id) const;
+        void SetTexture(int id, const Ref<Texture>& texture);
+        void SetVectorArray(int id, const Vector<Vector4>& array);
+        void SetMatrixArray(int id, const Vector<Matrix4x4>& array);
         const Rect& GetScissorRect() const { return m_scissor_rect; }
         void SetScissorRect(const Rect& rect);
-		String EnableKeywords(const Vector<String>& keywords);
+		void EnableKeywords(Shader::KeywordMask keywords);
+        // upload changes outside render pass, every frame material is drawn in
         void Prepare(int pass = -1);
         void SetScissor(int target_width, int target_height);
 		void Bind(const Ref<Shader>& shader, int pass);
+        // upload block over copies of material buffers outside render pass, bind after Bind
+        void PreparePropertyBlock(const MaterialPropertyBlock& block, PropertyBlockBuffers& buffers);
+        void BindPropertyBlock(const Ref<Shader>& shader, int pass, const MaterialPropertyBlock& block, const PropertyBlockBuffers& buffers);
+        static void ReleasePropertyBlock(PropertyBlockBuffers& buffers);
         
     private:
         template <class T>
-        const T* GetProperty(const String& name, MaterialProperty::Type type) const
+        const T* GetProperty(int id, MaterialProperty::Type type) const
         {
-            const MaterialProperty* property_ptr;
-            if (m_properties.TryGet(name, &property_ptr))
+            const MaterialProperty* property_ptr = this->FindProperty(id);
+            if (property_ptr && property_ptr->type == type)
             {
-                if (property_ptr->type == type)
-                {
-                    return (const T*) &property_ptr->data;
-                }
+                return (const T*) &property_ptr->data;
             }
             
             return nullptr;
         }
         template <class T>
-        void SetProperty(const String& name, const T& v, MaterialProperty::Type type)
+        void SetProperty(int id, const T& v, MaterialProperty::Type type)
         {
-            MaterialProperty* property_ptr;
-            if (m_properties.TryGet(name, &property_ptr))
-            {
-                property_ptr->type = type;
-                Memory::Copy(&property_ptr->data, &v, sizeof(v));
-                property_ptr->dirty = true;
-            }
-            else
-            {
-                MaterialProperty property;
-                property.name = name;
-                property.type = type;
-                Memory::Copy(&property.data, &v, sizeof(v));
-                property.size = sizeof(v);
-                property.dirty = true;
-                m_properties.Add(name, property);
-            }
+            MaterialProperty* property_ptr = this->SetPropertyDirty(id, type);
+            Memory::Copy(&property_ptr->data, &v, sizeof(v));
+            property_ptr->size = sizeof(v);
         }
-        void UpdateUniformMember(const String& name, const void* data, int size);
-        void UpdateUniformTexture(const String& name, const Ref<Texture>& texture);
+        const MaterialProperty* FindProperty(int id) const;
+        MaterialProperty* SetPropertyDirty(int id, MaterialProperty::Type type);
+        int FindShaderVariant(Shader::KeywordMask keywords) const;
+        void AddShaderVariant(const ShaderVariant& variant);
+        void UpdateUniformMember(int id, const void* data, int size);
+        void UpdateUniformTexture(int id, const Ref<Texture>& texture);
+        void CopyUniformBuffer(int pass, int binding, int size, UniformBuffer& dst) const;
+        void CopySamplerGroup(int pass, int binding, int size, SamplerGroup& dst) const;
         
     private:
         static Ref<Material> m_shared_bounds_material;
-        Map<String, ShaderVariant> m_shader_variants;
+        // first variant is the material shader, table is open addressing hash of keyword mask to variant index
+        Vector<ShaderVariant> m_shader_variants;
+        Vector<int> m_shader_variant_table;
         Ref<int> m_queue;
-        Map<String, MaterialProperty> m_properties;
+        Vector<MaterialProperty> m_properties;
+        Vector<int> m_property_indices; // property id to index in properties, -1 if not set
+        Vector<int> m_dirty_properties;
         Rect m_scissor_rect;
         Vector<Vector<UniformBuffer>> m_unifrom_buffers;
         Vector<Vector<SamplerGroup>> m_samplers;
+        uint32_t m_uniform_version; // changes when buffers are uploaded
     };
 }
@@ -0,0 +1,119 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "MaterialPropertyBlock.h"
+
+namespace Viry3D
+{
+    MaterialPropertyBlock::MaterialPropertyBlock():
+        m_version(0)
+    {
+
+    }
+
+    void MaterialPropertyBlock::Clear()
+    {
+        m_properties.Clear();
+        ++m_version;
+    }
+
+    bool MaterialPropertyBlock::IsSame(const MaterialPropertyBlock& block) const
+    {
+        if (m_properties.Size() != block.m_properties.Size())
+        {
+            return false;
+        }
+
+        for (const auto& i : m_properties)
+        {
+            const MaterialProperty* other = nullptr;
+            for (const auto& j : block.m_properties)
+            {
+                if (j.id == i.id)
+                {
+                    other = &j;
+                    break;
+                }
+            }
+
+            if (other == nullptr ||
+                other->type != i.type ||
+                other->size != i.size ||
+                other->texture != i.texture ||
+                Memory::Compare(&other->data, &i.data, i.size) != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    MaterialProperty* MaterialPropertyBlock::SetPropertyDirty(int id, MaterialProperty::Type type)
+    {
+        ++m_version;
+
+        // blocks hold a few properties, linear search
+        for (auto& i : m_properties)
+        {
+            if (i.id == id)
+            {
+                i.type = type;
+                return &i;
+            }
+        }
+
+        MaterialProperty property;
+        property.name = Shader::IDToProperty(id);
+        property.id = id;
+        property.type = type;
+        property.dirty = false;
+        m_properties.Add(property);
+        return &m_properties[m_properties.Size() - 1];
+    }
+
+    void MaterialPropertyBlock::SetMatrix(int id, const Matrix4x4& value)
+    {
+        this->SetProperty(id, value, MaterialProperty::Type::Matrix);
+    }
+
+    void MaterialPropertyBlock::SetVector(int id, const Vector4& value)
+    {
+        this->SetProperty(id, value, MaterialProperty::Type::Vector);
+    }
+
+    void MaterialPropertyBlock::SetColor(int id, const Color& value)
+    {
+        this->SetProperty(id, value, MaterialProperty::Type::Color);
+    }
+
+    void MaterialPropertyBlock::SetFloat(int id, float value)
+    {
+        this->SetProperty(id, value, MaterialProperty::Type::Float);
+    }
+
+    void MaterialPropertyBlock::SetInt(int id, int value)
+    {
+        this->SetProperty(id, value, MaterialProperty::Type::Int);
+    }
+
+    void MaterialPropertyBlock::SetTexture(int id, const Ref<Texture>& texture)
+    {
+        MaterialProperty* property_ptr = this->SetPropertyDirty(id, MaterialProperty::Type::Texture);
+        property_ptr->texture = texture;
+    }
+}
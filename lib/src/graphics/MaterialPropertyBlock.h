@@ -0,0 +1,65 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "Material.h"
+
+namespace Viry3D
+{
+    // material property overrides of one renderer, written over a per renderer copy of
+    // the material buffers at draw so the material itself stays shared
+    class MaterialPropertyBlock
+    {
+    public:
+        MaterialPropertyBlock();
+        bool IsEmpty() const { return m_properties.Size() == 0; }
+        void Clear();
+        // changes whenever a property is set or cleared
+        uint32_t GetVersion() const { return m_version; }
+        const Vector<MaterialProperty>& GetProperties() const { return m_properties; }
+        // same properties with same values in any order
+        bool IsSame(const MaterialPropertyBlock& block) const;
+        void SetMatrix(const String& name, const Matrix4x4& value) { this->SetMatrix(Shader::PropertyToID(name), value); }
+        void SetVector(const String& name, const Vector4& value) { this->SetVector(Shader::PropertyToID(name), value); }
+        void SetColor(const String& name, const Color& value) { this->SetColor(Shader::PropertyToID(name), value); }
+        void SetFloat(const String& name, float value) { this->SetFloat(Shader::PropertyToID(name), value); }
+        void SetInt(const String& name, int value) { this->SetInt(Shader::PropertyToID(name), value); }
+        void SetTexture(const String& name, const Ref<Texture>& texture) { this->SetTexture(Shader::PropertyToID(name), texture); }
+        // property id versions, id from Shader::PropertyToID
+        void SetMatrix(int id, const Matrix4x4& value);
+        void SetVector(int id, const Vector4& value);
+        void SetColor(int id, const Color& value);
+        void SetFloat(int id, float value);
+        void SetInt(int id, int value);
+        void SetTexture(int id, const Ref<Texture>& texture);
+
+    private:
+        template <class T>
+        void SetProperty(int id, const T& v, MaterialProperty::Type type)
+        {
+            MaterialProperty* property_ptr = this->SetPropertyDirty(id, type);
+            Memory::Copy(&property_ptr->data, &v, sizeof(v));
+            property_ptr->size = sizeof(v);
+        }
+        MaterialProperty* SetPropertyDirty(int id, MaterialProperty::Type type);
+
+    private:
+        Vector<MaterialProperty> m_properties;
+        uint32_t m_version;
+    };
+}
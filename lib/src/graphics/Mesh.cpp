@@ -20,6 +20,7 @@
 #include "Engine.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "RenderStats.h"
 #include "io/File.h"
 #include "io/MemoryStream.h"
 #include "memory/Memory.h"
@@ -402,12 +403,14 @@ namespace Viry3D
         void* buffer = Memory::Alloc<void>(m_vertices.SizeInBytes());
         Memory::Copy(buffer, m_vertices.Bytes(), m_vertices.SizeInBytes());
         driver.updateVertexBuffer(m_vb, 0, filament::backend::BufferDescriptor(buffer, m_vertices.SizeInBytes(), FreeBufferCallback), 0);
+        RenderStats::AddBufferUpload(m_vertices.SizeInBytes());
     
         if (m_uint32_index)
         {
             buffer = Memory::Alloc<void>(m_indices.SizeInBytes());
             Memory::Copy(buffer, m_indices.Bytes(), m_indices.SizeInBytes());
             driver.updateIndexBuffer(m_ib, filament::backend::BufferDescriptor(buffer, m_indices.SizeInBytes(), FreeBufferCallback), 0);
+            RenderStats::AddBufferUpload(m_indices.SizeInBytes());
         }
         else
         {
@@ -418,6 +421,7 @@ namespace Viry3D
                 indices_uint16[i] = m_indices[i];
             }
             driver.updateIndexBuffer(m_ib, filament::backend::BufferDescriptor(indices_uint16, size, FreeBufferCallback), 0);
+            RenderStats::AddBufferUpload(size);
         }
         
 		m_enabled_attributes =
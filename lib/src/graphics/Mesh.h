@@ -76,9 +76,11 @@ namespace Viry3D
         const Vector<unsigned int>& GetIndices() const { return m_indices; }
         const Vector<Submesh>& GetSubmeshes() const { return m_submeshes; }
         const Vector<Matrix4x4>& GetBindposes() const { return m_bindposes; }
+        void SetBindposes(Vector<Matrix4x4>&& bindposes) { m_bindposes = std::move(bindposes); }
         const Vector<BlendShape>& GetBlendShapes() const { return m_blend_shapes; }
         const Ref<Texture>& GetBlendShapeTexture() const { return m_blend_shape_texture; }
         const Bounds& GetBounds() const { return m_bounds; }
+        filament::backend::PrimitiveType GetPrimitiveType() const { return m_primitive_type; }
 		const filament::backend::AttributeArray& GetAttributes() const { return m_attributes; }
 		uint32_t GetEnabledAttributes() const { return m_enabled_attributes; }
 		const filament::backend::VertexBufferHandle& GetVertexBuffer() const { return m_vb; }
@@ -86,7 +88,6 @@ namespace Viry3D
 		const Vector<filament::backend::RenderPrimitiveHandle>& GetPrimitives() const { return m_primitives; }
 
     private:
-        void SetBindposes(Vector<Matrix4x4>&& bindposes) { m_bindposes = std::move(bindposes); }
         void SetBlendShapes(Vector<BlendShape>&& blend_shapes);
         
     private:
@@ -16,29 +16,83 @@
 */
 
 #include "MeshRenderer.h"
+#include "Engine.h"
 
 namespace Viry3D
 {
-    MeshRenderer::MeshRenderer()
+    MeshRenderer::MeshRenderer():
+        m_static_batch_index(-1),
+        m_static_member_count(0)
     {
 
     }
     
     MeshRenderer::~MeshRenderer()
     {
-
+        this->ClearStaticBatch();
     }
     
     void MeshRenderer::SetMesh(const Ref<Mesh>& mesh)
     {
         m_mesh = mesh;
+        this->ClearStaticBatch();
+    }
+
+    void MeshRenderer::SetStaticBatchRoot(const Ref<Mesh>& mesh, Vector<Mesh::Submesh>&& member_ranges, int member_count)
+    {
+        auto& driver = Engine::Instance()->GetDriverApi();
+
+        this->SetMesh(mesh);
+        m_static_batched = true;
+        m_static_member_ranges = std::move(member_ranges);
+        m_static_member_count = member_count;
+
+        m_static_range_primitive = driver.createRenderPrimitive();
+        driver.setRenderPrimitiveBuffer(m_static_range_primitive, mesh->GetVertexBuffer(), mesh->GetIndexBuffer(), mesh->GetEnabledAttributes());
+        this->MarkUniformsDirty();
+    }
+
+    void MeshRenderer::SetStaticBatchMember(const Ref<MeshRenderer>& root, int index, const Bounds& bounds)
+    {
+        m_static_batched = true;
+        m_static_batch_root = root;
+        m_static_batch_index = index;
+        m_static_bounds = bounds;
+    }
+
+    void MeshRenderer::ClearStaticBatch()
+    {
+        if (m_static_range_primitive)
+        {
+            auto& driver = Engine::Instance()->GetDriverApi();
+            driver.destroyRenderPrimitive(m_static_range_primitive);
+            m_static_range_primitive.clear();
+        }
+
+        m_static_batched = false;
+        m_static_batch_root.reset();
+        m_static_batch_index = -1;
+        m_static_member_ranges.Clear();
+        m_static_member_count = 0;
+        this->MarkUniformsDirty();
+    }
+
+    void MeshRenderer::Prepare()
+    {
+        // members are drawn by root with its identity uniform buffer
+        if (this->IsStaticBatchMember())
+        {
+            return;
+        }
+
+        Renderer::Prepare();
     }
     
     Vector<filament::backend::RenderPrimitiveHandle> MeshRenderer::GetPrimitives()
     {
         Vector<filament::backend::RenderPrimitiveHandle> primitives;
         
-        if (m_mesh)
+        if (m_mesh && !this->IsStaticBatchMember())
         {
             primitives = m_mesh->GetPrimitives();
         }
@@ -46,11 +100,29 @@ namespace Viry3D
         return primitives;
     }
 
+    int MeshRenderer::GetPrimitiveIndexCount(int index)
+    {
+        if (m_mesh && !this->IsStaticBatchMember())
+        {
+            const auto& submeshes = m_mesh->GetSubmeshes();
+            if (index >= 0 && index < submeshes.Size())
+            {
+                return submeshes[index].index_count;
+            }
+        }
+
+        return 0;
+    }
+
     Bounds MeshRenderer::GetLocalBounds() const
     {
         Bounds bounds;
 
-        if (m_mesh)
+        if (this->IsStaticBatchMember())
+        {
+            bounds = m_static_bounds;
+        }
+        else if (m_mesh)
         {
             bounds = m_mesh->GetBounds();
         }
@@ -32,9 +32,34 @@ namespace Viry3D
         const Ref<Mesh>& GetMesh() const { return m_mesh; }
 		virtual void SetMesh(const Ref<Mesh>& mesh);
         virtual Vector<filament::backend::RenderPrimitiveHandle> GetPrimitives();
+        virtual int GetPrimitiveIndexCount(int index);
         virtual Bounds GetLocalBounds() const;
+        // root draws combined mesh of a static batch, members are culled one by one and draw nothing themselves
+        bool IsStaticBatchRoot() const { return m_static_member_count > 0; }
+        bool IsStaticBatchMember() const { return m_static_batch_index >= 0; }
+        Ref<MeshRenderer> GetStaticBatchRoot() const { return m_static_batch_root.lock(); }
+
+	protected:
+		virtual void Prepare();
+
+	private:
+        friend class StaticBatchingUtility;
+        friend class Camera;
+        // combined mesh has one submesh per material, member ranges are in member order inside each submesh
+        void SetStaticBatchRoot(const Ref<Mesh>& mesh, Vector<Mesh::Submesh>&& member_ranges, int member_count);
+        // bounds in world space
+        void SetStaticBatchMember(const Ref<MeshRenderer>& root, int index, const Bounds& bounds);
+        const Mesh::Submesh& GetStaticMemberRange(int material_index, int member) const { return m_static_member_ranges[material_index * m_static_member_count + member]; }
+        void ClearStaticBatch();
 
 	private:
         Ref<Mesh> m_mesh;
+        WeakRef<MeshRenderer> m_static_batch_root;
+        int m_static_batch_index;
+        Bounds m_static_bounds;
+        Vector<Mesh::Submesh> m_static_member_ranges;
+        int m_static_member_count;
+        // root only, index range is set before each draw of visible members
+        filament::backend::RenderPrimitiveHandle m_static_range_primitive;
     };
 }
@@ -0,0 +1,103 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "RenderStats.h"
+#include "BindingCache.h"
+#include "time/Time.h"
+
+namespace Viry3D
+{
+    RenderStats::Frame RenderStats::m_frame;
+    RenderStats::Frame RenderStats::m_last_frame;
+
+    void RenderCounters::AddDraw(const filament::backend::PipelineState& pipeline, int index_count, int instance_count)
+    {
+        ++draw_calls;
+        if (instance_count > 1)
+        {
+            ++instanced_draws;
+        }
+        instances += instance_count;
+        triangles += (int64_t) index_count / 3 * instance_count;
+
+        if (!(pipeline.program == program))
+        {
+            ++program_changes;
+            program = pipeline.program;
+        }
+    }
+
+    void RenderCounters::Add(const RenderCounters& counters)
+    {
+        draw_calls += counters.draw_calls;
+        instanced_draws += counters.instanced_draws;
+        instances += counters.instances;
+        triangles += counters.triangles;
+        material_binds += counters.material_binds;
+        program_changes += counters.program_changes;
+    }
+
+    void RenderStats::BeginFrame()
+    {
+        m_frame = Frame();
+        m_frame.frame_count = Time::GetFrameCount();
+    }
+
+    void RenderStats::EndFrame()
+    {
+        m_frame.binds = BindingCache::GetBindCount();
+        m_frame.bind_skips = BindingCache::GetSkipCount();
+
+        m_last_frame = m_frame;
+
+        Time::SetDrawCall(m_frame.draws.draw_calls);
+    }
+
+    void RenderStats::AddUniformUpload(int size)
+    {
+        ++m_frame.uniform_uploads;
+        m_frame.uniform_upload_bytes += size;
+    }
+
+    void RenderStats::AddTextureUpload(int size)
+    {
+        ++m_frame.texture_uploads;
+        m_frame.texture_upload_bytes += size;
+    }
+
+    void RenderStats::AddBufferUpload(int size)
+    {
+        ++m_frame.buffer_uploads;
+        m_frame.buffer_upload_bytes += size;
+    }
+
+    void RenderStats::AddCamera(const String& name, int visible_renderers, int culled_renderers, int draw_calls)
+    {
+        m_frame.visible_renderers += visible_renderers;
+        m_frame.culled_renderers += culled_renderers;
+        m_frame.cameras.Add({ name, visible_renderers, culled_renderers, draw_calls });
+    }
+
+    void RenderStats::AddTemporaryTarget(bool created)
+    {
+        ++m_frame.temporary_targets;
+        if (created)
+        {
+            ++m_frame.temporary_targets_created;
+        }
+    }
+}
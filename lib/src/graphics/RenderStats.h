@@ -0,0 +1,103 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "string/String.h"
+#include "container/Vector.h"
+#include "private/backend/DriverApi.h"
+
+namespace Viry3D
+{
+    // draw counts of one recording, draw chunks recorded on workers count into their own
+    struct RenderCounters
+    {
+        int draw_calls = 0;
+        // draws with more than one instance, and instances in all draws
+        int instanced_draws = 0;
+        int instances = 0;
+        int64_t triangles = 0;
+        int material_binds = 0;
+        // draws with a program other than previous draw in same recording
+        int program_changes = 0;
+        filament::backend::ProgramHandle program;
+
+        void AddDraw(const filament::backend::PipelineState& pipeline, int index_count, int instance_count);
+        void AddMaterialBind() { ++material_binds; }
+        void Add(const RenderCounters& counters);
+        void Reset() { *this = RenderCounters(); }
+    };
+
+    // render statistics of last frame, counted from begin of engine render to end of frame.
+    // counting is main thread only, except counters of draw chunks merged after recording
+    class RenderStats
+    {
+    public:
+        struct CameraStats
+        {
+            String name;
+            int visible_renderers;
+            int culled_renderers;
+            int draw_calls;
+        };
+
+        struct Frame
+        {
+            int frame_count = 0;
+            RenderCounters draws;
+            // uniform buffer and sampler binds issued and skipped by binding cache
+            int binds = 0;
+            int bind_skips = 0;
+            int uniform_uploads = 0;
+            int64_t uniform_upload_bytes = 0;
+            int texture_uploads = 0;
+            int64_t texture_upload_bytes = 0;
+            // vertex and index buffers
+            int buffer_uploads = 0;
+            int64_t buffer_upload_bytes = 0;
+            int visible_renderers = 0;
+            int culled_renderers = 0;
+            // renderers drawn into shadow maps, once per light
+            int shadow_casters = 0;
+            // variants cross compiled from source, and loaded from disk cache instead
+            int shader_variants_compiled = 0;
+            int shader_variant_cache_hits = 0;
+            // temporary render targets taken, and created because no idle one matched
+            int temporary_targets = 0;
+            int temporary_targets_created = 0;
+            Vector<CameraStats> cameras;
+        };
+
+        static void BeginFrame();
+        static void EndFrame();
+        static const Frame& GetLastFrame() { return m_last_frame; }
+        // draws recorded on main thread
+        static RenderCounters& GetCounters() { return m_frame.draws; }
+        static void AddUniformUpload(int size);
+        static void AddTextureUpload(int size);
+        static void AddBufferUpload(int size);
+        static void AddCamera(const String& name, int visible_renderers, int culled_renderers, int draw_calls);
+        static void AddShadowCasters(int count) { m_frame.shadow_casters += count; }
+        static void AddShaderVariantCompiled() { ++m_frame.shader_variants_compiled; }
+        static void AddShaderVariantCacheHit() { ++m_frame.shader_variant_cache_hits; }
+        static void AddTemporaryTarget(bool created);
+
+    private:
+        static Frame m_frame;
+        static Frame m_last_frame;
+    };
+}
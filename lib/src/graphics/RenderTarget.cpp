@@ -17,6 +17,7 @@
 
 #include "RenderTarget.h"
 #include "Engine.h"
+#include "RenderStats.h"
 
 namespace Viry3D
 {
@@ -135,6 +136,8 @@ namespace Viry3D
 				stencil);
 		}
 
+		RenderStats::AddTemporaryTarget(create);
+
 		if (m_temporary_render_targets_using.TryGet(key.u, &p))
 		{
 			p->targets.Add(target);
@@ -18,6 +18,7 @@
 #include "Renderer.h"
 #include "Engine.h"
 #include "Editor.h"
+#include "Profiler.h"
 #include "GameObject.h"
 
 namespace Viry3D
@@ -26,11 +27,14 @@ namespace Viry3D
 
 	void Renderer::PrepareAll()
 	{
+		PROFILE_SCOPE("Renderer::PrepareAll");
+
 		for (auto i : m_renderers)
 		{
             if (i->GetGameObject()->IsActiveInTree() && i->IsEnable())
             {
                 i->Prepare();
+                Engine::Instance()->FlushCommandsIfNeeded();
             }
 		}
 	}
@@ -39,20 +43,20 @@ namespace Viry3D
 		m_cast_shadow(false),
 		m_recieve_shadow(false),
         m_lightmap_scale_offset(1, 1, 0, 0),
-        m_lightmap_index(-1)
+        m_lightmap_index(-1),
+        m_max_light_count(-1),
+        m_shader_keyword_mask(0),
+        m_uniforms_dirty(true),
+        m_static_batched(false)
     {
         m_renderers.AddLast(this);
     }
     
     Renderer::~Renderer()
     {
-		auto& driver = Engine::Instance()->GetDriverApi();
+		this->ReleasePropertyBlockBuffers();
 
-		if (m_transform_uniform_buffer)
-		{
-			driver.destroyUniformBuffer(m_transform_uniform_buffer);
-			m_transform_uniform_buffer.clear();
-		}
+		UniformBufferPool::Free(m_transform_uniform_buffer);
 
         m_renderers.Remove(this);
     }
@@ -93,12 +97,39 @@ namespace Viry3D
 
     void Renderer::SetLightmapIndex(int index)
     {
-        m_lightmap_index = index;
+        if (m_lightmap_index != index)
+        {
+            m_lightmap_index = index;
+            m_uniforms_dirty = true;
+        }
     }
     
     void Renderer::SetLightmapScaleOffset(const Vector4& vec)
     {
-        m_lightmap_scale_offset = vec;
+        if (m_lightmap_scale_offset != vec)
+        {
+            m_lightmap_scale_offset = vec;
+            m_uniforms_dirty = true;
+        }
+    }
+
+    void Renderer::OnTransformDirty()
+    {
+        m_uniforms_dirty = true;
+    }
+
+    void Renderer::OnEnable(bool enable)
+    {
+        // transform changes are not sent to disabled components
+        if (enable)
+        {
+            m_uniforms_dirty = true;
+        }
+    }
+
+    void Renderer::SetMaxLightCount(int count)
+    {
+        m_max_light_count = count;
     }
 
     void Renderer::SetShaderKeywords(const Vector<String>& keywords)
@@ -118,9 +149,14 @@ namespace Viry3D
         }
     }
 
-    const String& Renderer::GetShaderKey(int material_index) const
+    void Renderer::DisableShaderKeyword(const String& keyword)
     {
-        return m_shader_keys[material_index];
+        if (m_shader_keywords.Contains(keyword))
+        {
+            m_shader_keywords.Remove(keyword);
+
+            this->UpdateShaderKeywords();
+        }
     }
 
     const Vector<String>& Renderer::GetShaderKeywords() const
@@ -130,13 +166,13 @@ namespace Viry3D
 
     void Renderer::UpdateShaderKeywords()
     {
-        m_shader_keys.Resize(m_materials.Size());
+        m_shader_keyword_mask = Shader::KeywordsToMask(m_shader_keywords);
 
         for (int i = 0; i < m_materials.Size(); ++i)
         {
             if (m_materials[i] && m_materials[i]->GetShaderName().Size() > 0)
             {
-                m_shader_keys[i] = m_materials[i]->EnableKeywords(m_shader_keywords);
+                m_materials[i]->EnableKeywords(m_shader_keyword_mask);
             }
         }
     }
@@ -146,9 +182,51 @@ namespace Viry3D
         return Vector<filament::backend::RenderPrimitiveHandle>();
     }
 
+    Bounds Renderer::GetWorldBounds() const
+    {
+        Bounds bounds = this->GetLocalBounds();
+        if (bounds.GetSize().SqrMagnitude() <= 0)
+        {
+            return bounds;
+        }
+
+        if (m_static_batched)
+        {
+            return bounds;
+        }
+
+        return bounds.Transform(this->GetTransform()->GetLocalToWorldMatrix());
+    }
+
+	void Renderer::SetPropertyBlock(const Ref<MaterialPropertyBlock>& block)
+	{
+		if (m_property_block != block)
+		{
+			m_property_block = block;
+			this->ReleasePropertyBlockBuffers();
+		}
+	}
+
+	void Renderer::BindPropertyBlock(int material_index, const Ref<Shader>& shader, int pass)
+	{
+		if (material_index < m_property_block_buffers.Size())
+		{
+			const auto& material = m_materials[material_index];
+			material->BindPropertyBlock(shader, pass, *m_property_block, m_property_block_buffers[material_index]);
+		}
+	}
+
+	void Renderer::ReleasePropertyBlockBuffers()
+	{
+		for (auto& i : m_property_block_buffers)
+		{
+			Material::ReleasePropertyBlock(i);
+		}
+		m_property_block_buffers.Clear();
+	}
+
 	void Renderer::Prepare()
 	{
-		auto& driver = Engine::Instance()->GetDriverApi();
 		const auto& materials = this->GetMaterials();
 
 		for (int i = 0; i < materials.Size(); ++i)
@@ -160,24 +238,52 @@ namespace Viry3D
 			}
 		}
 
-		if (!m_transform_uniform_buffer)
+		if (this->HasPropertyBlock())
+		{
+			m_property_block_buffers.Resize(materials.Size());
+			for (int i = 0; i < materials.Size(); ++i)
+			{
+				if (materials[i])
+				{
+					materials[i]->PreparePropertyBlock(*m_property_block, m_property_block_buffers[i]);
+				}
+			}
+		}
+
+		if (!m_transform_uniform_buffer.uniform_buffer)
 		{
-			m_transform_uniform_buffer = driver.createUniformBuffer(sizeof(RendererUniforms), filament::backend::BufferUsage::DYNAMIC);
+			m_transform_uniform_buffer = UniformBufferPool::Alloc(sizeof(RendererUniforms));
+			m_uniforms_dirty = true;
 		}
 
+        // transform and lightmap changes mark uniforms dirty, bounds and editor selection are checked here
         Bounds bounds = this->GetLocalBounds();
+        auto selected_obj = Engine::Instance()->GetEditor()->GetSelectedGameObject();
+        Color bounds_color = (selected_obj == this->GetGameObject() || selected_obj == this->GetTransform()->GetRoot()->GetGameObject()) ? Color(1, 0, 0, 1) : Color(0, 1, 0, 1);
+
+        if (bounds_color != m_renderer_uniforms.bounds_color ||
+            bounds.Min() != m_uniforms_bounds.Min() ||
+            bounds.Max() != m_uniforms_bounds.Max())
+        {
+            m_uniforms_dirty = true;
+        }
+
+        if (!m_uniforms_dirty)
+        {
+            return;
+        }
+        m_uniforms_dirty = false;
+        m_uniforms_bounds = bounds;
+
         Vector3 bounds_position = bounds.GetCenter();
         Vector3 bounds_size = bounds.GetSize();
-        auto selected_obj = Engine::Instance()->GetEditor()->GetSelectedGameObject();
 
-        m_renderer_uniforms.model_matrix = this->GetTransform()->GetLocalToWorldMatrix();
+        m_renderer_uniforms.model_matrix = m_static_batched ? Matrix4x4::Identity() : this->GetTransform()->GetLocalToWorldMatrix();
         m_renderer_uniforms.bounds_matrix = Matrix4x4::TRS(bounds_position, Quaternion::Identity(), bounds_size);
-        m_renderer_uniforms.bounds_color = (selected_obj == this->GetGameObject() || selected_obj == this->GetTransform()->GetRoot()->GetGameObject()) ? Color(1, 0, 0, 1) : Color(0, 1, 0, 1);
+        m_renderer_uniforms.bounds_color = bounds_color;
         m_renderer_uniforms.lightmap_scale_offset = m_lightmap_scale_offset;
         m_renderer_uniforms.lightmap_index = Vector4((float) m_lightmap_index);
 
-		void* buffer = driver.allocate(sizeof(RendererUniforms));
-		Memory::Copy(buffer, &m_renderer_uniforms, sizeof(RendererUniforms));
-		driver.loadUniformBuffer(m_transform_uniform_buffer, filament::backend::BufferDescriptor(buffer, sizeof(RendererUniforms)));
+		UniformBufferPool::Write(m_transform_uniform_buffer, &m_renderer_uniforms, sizeof(RendererUniforms));
 	}
 }
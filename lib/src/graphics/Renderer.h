@@ -19,6 +19,8 @@
 
 #include "Component.h"
 #include "Material.h"
+#include "MaterialPropertyBlock.h"
+#include "UniformBufferPool.h"
 #include "container/List.h"
 #include "container/Vector.h"
 #include "math/Vector4.h"
@@ -48,22 +50,42 @@ namespace Viry3D
         void SetLightmapIndex(int index);
         const Vector4& GetLightmapScaleOffset() const { return m_lightmap_scale_offset; }
         void SetLightmapScaleOffset(const Vector4& vec);
+        // max lights drawn on this renderer, -1 is unlimited
+        int GetMaxLightCount() const { return m_max_light_count; }
+        void SetMaxLightCount(int count);
         void SetShaderKeywords(const Vector<String>& keywords);
         void EnableShaderKeyword(const String& keyword);
-        const String& GetShaderKey(int material_index) const;
+        void DisableShaderKeyword(const String& keyword);
         const Vector<String>& GetShaderKeywords() const;
+        // overrides material properties on this renderer only, materials stay shared. null to remove
+        const Ref<MaterialPropertyBlock>& GetPropertyBlock() const { return m_property_block; }
+        void SetPropertyBlock(const Ref<MaterialPropertyBlock>& block);
+        bool HasPropertyBlock() const { return m_property_block && !m_property_block->IsEmpty(); }
+        Shader::KeywordMask GetShaderKeywordMask() const { return m_shader_keyword_mask; }
         const RendererUniforms& GetRendererUniforms() const { return m_renderer_uniforms; }
-        const filament::backend::UniformBufferHandle& GetTransformUniformBuffer() const { return m_transform_uniform_buffer; }
+        // pooled slice, written when dirty and uploaded with its page before next render pass
+        const UniformBufferSlice& GetTransformUniformBuffer() const { return m_transform_uniform_buffer; }
         virtual Vector<filament::backend::RenderPrimitiveHandle> GetPrimitives();
+        // indices drawn by primitive at index of GetPrimitives
+        virtual int GetPrimitiveIndexCount(int index) { return 0; }
         virtual Bounds GetLocalBounds() const { return Bounds(); }
+        virtual Bounds GetWorldBounds() const;
+        // vertices are pre-transformed to world space by static batching, model matrix is identity
+        bool IsStaticBatched() const { return m_static_batched; }
 
 	protected:
 		virtual void Prepare();
 		virtual void OnResize(int width, int height) { }
+		virtual void OnTransformDirty();
+		virtual void OnEnable(bool enable);
+		// upload renderer uniforms in next prepare
+		void MarkUniformsDirty() { m_uniforms_dirty = true; }
 
 	private:
 		friend class Camera;
         void UpdateShaderKeywords();
+        void BindPropertyBlock(int material_index, const Ref<Shader>& shader, int pass);
+        void ReleasePropertyBlockBuffers();
 
 	private:
         static List<Renderer*> m_renderers;
@@ -72,9 +94,17 @@ namespace Viry3D
 		bool m_recieve_shadow;
         Vector4 m_lightmap_scale_offset;
         int m_lightmap_index;
+        int m_max_light_count;
         Vector<String> m_shader_keywords;
-        Vector<String> m_shader_keys;
+        Shader::KeywordMask m_shader_keyword_mask;
         RendererUniforms m_renderer_uniforms;
-		filament::backend::UniformBufferHandle m_transform_uniform_buffer;
+		UniformBufferSlice m_transform_uniform_buffer;
+		bool m_uniforms_dirty;
+		Bounds m_uniforms_bounds;
+        Ref<MaterialPropertyBlock> m_property_block;
+        Vector<PropertyBlockBuffers> m_property_block_buffers; // per material
+
+	protected:
+		bool m_static_batched;
     };
 }
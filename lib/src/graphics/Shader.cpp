@@ -18,9 +18,13 @@
 #include "Shader.h"
 #include "Debug.h"
 #include "Engine.h"
+#include "RenderStats.h"
 #include "io/File.h"
 #include "lua/lua.hpp"
+#include "crypto/md5/md5.h"
+#include <utils/ThreadLocal.h>
 #include "memory/Memory.h"
+#include <algorithm>
 
 #if VR_VULKAN || VR_D3D
 #include "vulkan/spirv_shader_compiler.h"
@@ -37,7 +41,30 @@
 
 namespace Viry3D
 {
+	// bump when cache layout or compile defines change
+	static constexpr int SHADER_CACHE_MAGIC = 0x48435356; // VSCH
+	static constexpr int SHADER_CACHE_VERSION = 1;
+
 	Map<String, Ref<Shader>> Shader::m_shaders;
+	Map<String, Future<Ref<Shader>>> Shader::m_compiling_shaders;
+	Map<String, Ref<Shader::Source>> Shader::m_sources;
+	Mutex Shader::m_sources_mutex;
+
+	struct Shader::Source
+	{
+		Mutex mutex;
+		bool loaded = false;
+		bool exist = false;
+		String path;
+		String src;
+		String hash; // of src and required modules
+		bool parsed = false;
+		Vector<Pass> passes;
+	};
+	Map<String, int> Shader::m_keyword_ids;
+	Vector<String> Shader::m_keyword_names;
+	Map<String, int> Shader::m_property_ids;
+	Vector<String> Shader::m_property_names;
 
 #if VR_VULKAN || VR_D3D
     static void GlslToSpirv(const String& glsl, ShaderCompiler::ShaderType shader_type, Vector<unsigned int>& spirv)
@@ -98,7 +125,9 @@ namespace Viry3D
     
     void Shader::Done()
     {
+		m_compiling_shaders.Clear();
 		m_shaders.Clear();
+		m_sources.Clear();
 
 #if VR_VULKAN || VR_D3D
 		ShaderCompiler::DeinitShaderCompiler();
@@ -127,46 +156,269 @@ namespace Viry3D
         return key;
     }
 
+    int Shader::KeywordToID(const String& keyword)
+    {
+        int* find;
+        if (m_keyword_ids.TryGet(keyword, &find))
+        {
+            return *find;
+        }
+
+        int id = m_keyword_names.Size();
+        if (id >= KEYWORD_MAX_COUNT)
+        {
+            // kept as -1 so it is logged once
+            Log("shader keyword count exceeds %d, keyword ignored: %s", KEYWORD_MAX_COUNT, keyword.CString());
+            m_keyword_ids.Add(keyword, -1);
+            return -1;
+        }
+
+        m_keyword_ids.Add(keyword, id);
+        m_keyword_names.Add(keyword);
+        return id;
+    }
+
+    Shader::KeywordMask Shader::KeywordToMask(const String& keyword)
+    {
+        int id = KeywordToID(keyword);
+        if (id < 0)
+        {
+            return 0;
+        }
+        return ((KeywordMask) 1) << id;
+    }
+
+    Shader::KeywordMask Shader::KeywordsToMask(const Vector<String>& keywords)
+    {
+        KeywordMask mask = 0;
+        for (int i = 0; i < keywords.Size(); ++i)
+        {
+            mask |= KeywordToMask(keywords[i]);
+        }
+        return mask;
+    }
+
+    int Shader::PropertyToID(const String& name)
+    {
+        int* find;
+        if (m_property_ids.TryGet(name, &find))
+        {
+            return *find;
+        }
+
+        int id = m_property_names.Size();
+        m_property_ids.Add(name, id);
+        m_property_names.Add(name);
+        return id;
+    }
+
 	Ref<Shader> Shader::Find(const String& name, const Vector<String>& keywords)
 	{
-		Ref<Shader> shader;
+		return Find(name, KeywordsToMask(keywords));
+	}
 
-        String key = MakeKey(name, keywords);
+	Vector<String> Shader::MaskToKeywords(KeywordMask keyword_mask)
+	{
+		Vector<String> keywords;
+		for (int i = 0; i < m_keyword_names.Size(); ++i)
+		{
+			if (keyword_mask & (((KeywordMask) 1) << i))
+			{
+				keywords.Add(m_keyword_names[i]);
+			}
+		}
+		return keywords;
+	}
+
+	Ref<Shader> Shader::CreateVariant(const String& name, KeywordMask keyword_mask, const Vector<String>& keywords, const String& key)
+	{
+		Ref<Shader> shader = Ref<Shader>(new Shader(name));
+		shader->m_shader_key = key;
+		shader->m_keywords = keywords;
+		shader->m_keyword_mask = keyword_mask;
+		return shader;
+	}
+
+	Ref<Shader> Shader::Find(const String& name, KeywordMask keyword_mask)
+	{
+		Vector<String> keywords = MaskToKeywords(keyword_mask);
+		String key = MakeKey(name, keywords);
 
 		Ref<Shader>* find;
 		if (m_shaders.TryGet(key, &find))
 		{
-			shader = *find;
+			return *find;
 		}
-		else
+
+		Ref<Shader> shader = CreateVariant(name, keyword_mask, keywords, key);
+
+		Vector<Binary> binaries;
+		if (!shader->Build(binaries))
 		{
-			String path = Engine::Instance()->GetDataPath() + "/shader/" + name + ".lua";
+			return Ref<Shader>();
+		}
 
-			if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
-                Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
+		shader->UpdatePropertyLocations();
+		shader->CreatePrograms(binaries);
+
+		m_shaders.Add(key, shader);
+
+		return shader;
+	}
+
+	Future<Ref<Shader>> Shader::FindAsync(const String& name, KeywordMask keyword_mask)
+	{
+		Vector<String> keywords = MaskToKeywords(keyword_mask);
+		String key = MakeKey(name, keywords);
+
+		Ref<Shader>* find;
+		if (m_shaders.TryGet(key, &find))
+		{
+			Future<Ref<Shader>> future;
+			future.SetValue(*find);
+			return future;
+		}
+
+		Future<Ref<Shader>>* compiling;
+		if (m_compiling_shaders.TryGet(key, &compiling))
+		{
+			return *compiling;
+		}
+
+		Ref<Shader> shader = CreateVariant(name, keyword_mask, keywords, key);
+		auto binaries = RefMake<Vector<Binary>>();
+
+		// continuation is posted to main thread, so it runs after future is registered
+		auto future = Task::Run([=]() {
+			return shader->Build(*binaries);
+		}).Then([=](const bool& success) -> Ref<Shader> {
+			m_compiling_shaders.Remove(key);
+
+			// Find compiled it synchronously meanwhile
+			Ref<Shader>* find;
+			if (m_shaders.TryGet(key, &find))
 			{
-				path = Engine::Instance()->GetDataPath() + "/shader/" + name + ".100.lua";
+				return *find;
 			}
 
-			if (File::Exist(path))
+			if (!success)
 			{
-				String lua_src = File::ReadAllText(path);
+				return Ref<Shader>();
+			}
+
+			shader->UpdatePropertyLocations();
+			shader->CreatePrograms(*binaries);
+
+			m_shaders.Add(key, shader);
 
-				shader = Ref<Shader>(new Shader(name));
-                shader->m_shader_key = key;
-                shader->m_keywords = keywords;
-				shader->Load(lua_src);
-				shader->Compile();
+			return shader;
+		}, TaskContext::MainThread);
+
+		m_compiling_shaders.Add(key, future);
+
+		return future;
+	}
 
-				m_shaders.Add(key, shader);
+	Ref<Shader> Shader::FindLoaded(const String& name, KeywordMask keyword_mask)
+	{
+		Ref<Shader>* find;
+		if (m_shaders.TryGet(MakeKey(name, MaskToKeywords(keyword_mask)), &find))
+		{
+			return *find;
+		}
+		return Ref<Shader>();
+	}
+
+	Ref<Shader::Source> Shader::GetSource(const String& name)
+	{
+		Ref<Source> source;
+
+		{
+			std::lock_guard<Mutex> lock(m_sources_mutex);
+
+			Ref<Source>* find;
+			if (m_sources.TryGet(name, &find))
+			{
+				source = *find;
 			}
 			else
 			{
-				Log("shader %s not exist: %s", name.CString(), path.CString());
+				source = RefMake<Source>();
+				m_sources.Add(name, source);
 			}
 		}
 
-		return shader;
+		// fields below parsed are immutable once loaded
+		std::lock_guard<Mutex> lock(source->mutex);
+		if (!source->loaded)
+		{
+			source->path = Engine::Instance()->GetDataPath() + "/shader/" + name + ".lua";
+
+			if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL &&
+				Engine::Instance()->GetShaderModel() == filament::backend::ShaderModel::GL_ES_20)
+			{
+				source->path = Engine::Instance()->GetDataPath() + "/shader/" + name + ".100.lua";
+			}
+
+			source->exist = File::Exist(source->path);
+			if (source->exist)
+			{
+				source->src = File::ReadAllText(source->path);
+				source->hash = HashSource(source->path, source->src);
+			}
+			source->loaded = true;
+		}
+
+		return source;
+	}
+
+	bool Shader::Build(Vector<Binary>& binaries)
+	{
+		Ref<Source> source = GetSource(this->GetName());
+		if (!source->exist)
+		{
+			Log("shader %s not exist: %s", this->GetName().CString(), source->path.CString());
+			return false;
+		}
+
+		String cache_path = GetCachePath(source->hash, m_shader_key);
+
+		// cache hit skips lua and glsl cross compilation
+		m_cache_hit = this->LoadCache(cache_path, binaries);
+		if (!m_cache_hit)
+		{
+			// lua runs once per shader name, variants copy parsed passes
+			{
+				std::lock_guard<Mutex> lock(source->mutex);
+				if (!source->parsed)
+				{
+					Load(this->GetName(), source->src, source->passes);
+					source->parsed = true;
+				}
+				m_passes = source->passes;
+			}
+
+			bool light_add = m_keywords.Contains("LIGHT_ADD_ON");
+			for (auto& pass : m_passes)
+			{
+				if (m_queue < pass.queue)
+				{
+					m_queue = pass.queue;
+				}
+
+				if (pass.light_mode == LightMode::Forward && light_add)
+				{
+					pass.pipeline.rasterState.depthWrite = false;
+					pass.pipeline.rasterState.blendFunctionDstRGB = filament::backend::BlendFunction::ONE;
+					pass.pipeline.rasterState.blendFunctionDstAlpha = filament::backend::BlendFunction::ONE;
+				}
+			}
+
+			this->CompileBinaries(binaries);
+			this->SaveCache(cache_path, binaries);
+		}
+
+		return true;
 	}
 
     Ref<Shader> Shader::Create(const Vector<Pass>& passes, const Vector<String>& keywords)
@@ -178,6 +430,7 @@ namespace Viry3D
         shader = Ref<Shader>(new Shader(""));
         shader->m_shader_key = MakeKey(shader->GetName(), keywords);;
         shader->m_keywords = keywords;
+        shader->m_keyword_mask = KeywordsToMask(keywords);
         shader->m_passes = passes;
         for (const auto& pass : shader->m_passes)
         {
@@ -186,13 +439,16 @@ namespace Viry3D
                 shader->m_queue = pass.queue;
             }
         }
+        shader->UpdatePropertyLocations();
         shader->Compile();
 
         return shader;
     }
     
     Shader::Shader(const String& name):
-		m_queue(0)
+		m_keyword_mask(0),
+		m_queue(0),
+		m_cache_hit(false)
     {
         this->SetName(name);
     }
@@ -226,24 +482,125 @@ namespace Viry3D
         return false;
     }
 
+    void Shader::UpdatePropertyLocations()
+    {
+        struct Entry
+        {
+            int id;
+            PropertyLocation location;
+        };
+        Vector<Entry> entries;
+
+        for (int i = 0; i < m_passes.Size(); ++i)
+        {
+            const auto& pass = m_passes[i];
+
+            // first uniform having the member in each pass
+            Map<int, bool> pass_members;
+            for (int j = 0; j < pass.uniforms.Size(); ++j)
+            {
+                const auto& uniform = pass.uniforms[j];
+                for (int k = 0; k < uniform.members.Size(); ++k)
+                {
+                    const auto& member = uniform.members[k];
+                    int id = PropertyToID(member.name);
+                    if (pass_members.Add(id, true))
+                    {
+                        Entry entry;
+                        entry.id = id;
+                        entry.location.pass = i;
+                        entry.location.binding = uniform.binding;
+                        entry.location.sampler = false;
+                        entry.location.offset = member.offset;
+                        entry.location.size = member.size;
+                        entry.location.block_size = uniform.size;
+                        entries.Add(entry);
+                    }
+                }
+            }
+
+            for (int j = 0; j < pass.samplers.Size(); ++j)
+            {
+                const auto& group = pass.samplers[j];
+                for (int k = 0; k < group.samplers.Size(); ++k)
+                {
+                    Entry entry;
+                    entry.id = PropertyToID(group.samplers[k].name);
+                    entry.location.pass = i;
+                    entry.location.binding = group.binding;
+                    entry.location.sampler = true;
+                    entry.location.offset = k;
+                    entry.location.size = group.samplers[k].binding;
+                    entry.location.block_size = group.samplers.Size();
+                    entries.Add(entry);
+                }
+            }
+        }
+
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.id < b.id;
+        });
+
+        m_property_locations.Clear();
+        m_property_location_ranges.Clear();
+        m_property_location_ranges.Resize(m_property_names.Size() * 2, 0);
+
+        for (int i = 0; i < entries.Size(); ++i)
+        {
+            int id = entries[i].id;
+            if (m_property_location_ranges[id * 2 + 1] == 0)
+            {
+                m_property_location_ranges[id * 2] = m_property_locations.Size();
+            }
+            m_property_location_ranges[id * 2 + 1] += 1;
+            m_property_locations.Add(entries[i].location);
+        }
+    }
+
+    const Shader::PropertyLocation* Shader::GetPropertyLocations(int id, int* count) const
+    {
+        // ids interned after this shader loaded are not used by it
+        if (id * 2 >= m_property_location_ranges.Size() || m_property_location_ranges[id * 2 + 1] == 0)
+        {
+            *count = 0;
+            return nullptr;
+        }
+
+        *count = m_property_location_ranges[id * 2 + 1];
+        return &m_property_locations[m_property_location_ranges[id * 2]];
+    }
+
+    bool Shader::IsClusterLight() const
+    {
+        return this->HasUniformBinding(BindingPoint::PerViewLights);
+    }
+
+    bool Shader::IsInstancing() const
+    {
+        return this->HasUniformBinding(BindingPoint::PerRendererInstances);
+    }
+
+    bool Shader::HasUniformBinding(BindingPoint binding) const
+    {
+        for (int i = 0; i < m_passes.Size(); ++i)
+        {
+            for (int j = 0; j < m_passes[i].uniforms.Size(); ++j)
+            {
+                if (m_passes[i].uniforms[j].binding == (int) binding)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
 	static void SetGlobalInt(lua_State* L, const char* key, int value)
 	{
 		lua_pushinteger(L, value);
 		lua_setglobal(L, key);
 	}
 
-	static void AddLuaPath(lua_State* L, const String& path)
-	{
-		lua_getglobal(L, "package");
-		lua_getfield(L, -1, "path"); // get field "path" from table at top of stack (-1)
-		String cur_path = lua_tostring(L, -1); // grab path string from top of stack
-		cur_path += ";" + path; // do your path magic here
-		lua_pop(L, 1); // get rid of the string on the stack we just pushed on line 5
-		lua_pushstring(L, cur_path.CString()); // push the new one
-		lua_setfield(L, -2, "path"); // set the field "path" in table at -2 with value at top of stack
-		lua_pop(L, 1); // get rid of package table from top of stack
-	}
-
 	static void GetTableString(lua_State* L, const char* key, String& str)
 	{
 		lua_pushstring(L, key);
@@ -267,48 +624,121 @@ namespace Viry3D
 		lua_pop(L, 1);
 	}
 
-	void Shader::Load(const String& src)
+	// lua state kept per thread, shader constants are set once
+	class ShaderLuaState
 	{
-		lua_State* L = luaL_newstate();
-		luaL_openlibs(L);
+	public:
+		ShaderLuaState()
+		{
+			L = luaL_newstate();
+			luaL_openlibs(L);
 
-		SetGlobalInt(L, "Off", 0);
-		SetGlobalInt(L, "On", 1);
+			SetGlobalInt(L, "Off", 0);
+			SetGlobalInt(L, "On", 1);
 
-		SetGlobalInt(L, "Back", (int) filament::backend::CullingMode::BACK);
-		SetGlobalInt(L, "Front", (int) filament::backend::CullingMode::FRONT);
-		
-		SetGlobalInt(L, "Less", (int) filament::backend::SamplerCompareFunc::L);
-		SetGlobalInt(L, "Greater", (int) filament::backend::SamplerCompareFunc::G);
-		SetGlobalInt(L, "LEqual", (int) filament::backend::SamplerCompareFunc::LE);
-		SetGlobalInt(L, "GEqual", (int) filament::backend::SamplerCompareFunc::GE);
-		SetGlobalInt(L, "Equal", (int) filament::backend::SamplerCompareFunc::E);
-		SetGlobalInt(L, "NotEqual", (int) filament::backend::SamplerCompareFunc::NE);
-		SetGlobalInt(L, "Always", (int) filament::backend::SamplerCompareFunc::A);
-
-		SetGlobalInt(L, "Zero", (int) filament::backend::BlendFunction::ZERO);
-		SetGlobalInt(L, "One", (int) filament::backend::BlendFunction::ONE);
-		SetGlobalInt(L, "SrcColor", (int) filament::backend::BlendFunction::SRC_COLOR);
-		SetGlobalInt(L, "SrcAlpha", (int) filament::backend::BlendFunction::SRC_ALPHA);
-		SetGlobalInt(L, "DstColor", (int) filament::backend::BlendFunction::DST_COLOR);
-		SetGlobalInt(L, "DstAlpha", (int) filament::backend::BlendFunction::DST_ALPHA);
-		SetGlobalInt(L, "OneMinusSrcColor", (int) filament::backend::BlendFunction::ONE_MINUS_SRC_COLOR);
-		SetGlobalInt(L, "OneMinusSrcAlpha", (int) filament::backend::BlendFunction::ONE_MINUS_SRC_ALPHA);
-		SetGlobalInt(L, "OneMinusDstColor", (int) filament::backend::BlendFunction::ONE_MINUS_DST_COLOR);
-		SetGlobalInt(L, "OneMinusDstAlpha", (int) filament::backend::BlendFunction::ONE_MINUS_DST_ALPHA);
-
-		SetGlobalInt(L, "Background", (int) Queue::Background);
-		SetGlobalInt(L, "Geometry", (int) Queue::Geometry);
-		SetGlobalInt(L, "AlphaTest", (int) Queue::AlphaTest);
-		SetGlobalInt(L, "Transparent", (int) Queue::Transparent);
-		SetGlobalInt(L, "Overlay", (int) Queue::Overlay);
-
-		SetGlobalInt(L, "None", (int) LightMode::None);
-		SetGlobalInt(L, "Forward", (int) LightMode::Forward);
-
-		String dir = Engine::Instance()->GetDataPath() + "/shader/" + this->GetName();
+			SetGlobalInt(L, "Back", (int) filament::backend::CullingMode::BACK);
+			SetGlobalInt(L, "Front", (int) filament::backend::CullingMode::FRONT);
+			
+			SetGlobalInt(L, "Less", (int) filament::backend::SamplerCompareFunc::L);
+			SetGlobalInt(L, "Greater", (int) filament::backend::SamplerCompareFunc::G);
+			SetGlobalInt(L, "LEqual", (int) filament::backend::SamplerCompareFunc::LE);
+			SetGlobalInt(L, "GEqual", (int) filament::backend::SamplerCompareFunc::GE);
+			SetGlobalInt(L, "Equal", (int) filament::backend::SamplerCompareFunc::E);
+			SetGlobalInt(L, "NotEqual", (int) filament::backend::SamplerCompareFunc::NE);
+			SetGlobalInt(L, "Always", (int) filament::backend::SamplerCompareFunc::A);
+
+			SetGlobalInt(L, "Zero", (int) filament::backend::BlendFunction::ZERO);
+			SetGlobalInt(L, "One", (int) filament::backend::BlendFunction::ONE);
+			SetGlobalInt(L, "SrcColor", (int) filament::backend::BlendFunction::SRC_COLOR);
+			SetGlobalInt(L, "SrcAlpha", (int) filament::backend::BlendFunction::SRC_ALPHA);
+			SetGlobalInt(L, "DstColor", (int) filament::backend::BlendFunction::DST_COLOR);
+			SetGlobalInt(L, "DstAlpha", (int) filament::backend::BlendFunction::DST_ALPHA);
+			SetGlobalInt(L, "OneMinusSrcColor", (int) filament::backend::BlendFunction::ONE_MINUS_SRC_COLOR);
+			SetGlobalInt(L, "OneMinusSrcAlpha", (int) filament::backend::BlendFunction::ONE_MINUS_SRC_ALPHA);
+			SetGlobalInt(L, "OneMinusDstColor", (int) filament::backend::BlendFunction::ONE_MINUS_DST_COLOR);
+			SetGlobalInt(L, "OneMinusDstAlpha", (int) filament::backend::BlendFunction::ONE_MINUS_DST_ALPHA);
+
+			SetGlobalInt(L, "Background", (int) Shader::Queue::Background);
+			SetGlobalInt(L, "Geometry", (int) Shader::Queue::Geometry);
+			SetGlobalInt(L, "AlphaTest", (int) Shader::Queue::AlphaTest);
+			SetGlobalInt(L, "Transparent", (int) Shader::Queue::Transparent);
+			SetGlobalInt(L, "Overlay", (int) Shader::Queue::Overlay);
+
+			SetGlobalInt(L, "None", (int) Shader::LightMode::None);
+			SetGlobalInt(L, "Forward", (int) Shader::LightMode::Forward);
+
+			lua_getglobal(L, "package");
+			lua_getfield(L, -1, "path");
+			m_package_path = lua_tostring(L, -1);
+			lua_pop(L, 1);
+
+			lua_getfield(L, -1, "loaded");
+			lua_pushnil(L);
+			while (lua_next(L, -2))
+			{
+				lua_pop(L, 1);
+				if (lua_type(L, -1) == LUA_TSTRING)
+				{
+					m_lib_modules.Add(lua_tostring(L, -1));
+				}
+			}
+			lua_pop(L, 2);
+		}
+
+		~ShaderLuaState()
+		{
+			lua_close(L);
+		}
+
+		// requires search dir, modules required by previous shaders are unloaded
+		lua_State* Begin(const String& dir)
+		{
+			lua_settop(L, 0);
+
+			lua_getglobal(L, "package");
+			lua_pushstring(L, (m_package_path + ";" + dir + "/?.lua").CString());
+			lua_setfield(L, -2, "path");
+
+			Vector<String> modules;
+			lua_getfield(L, -1, "loaded");
+			lua_pushnil(L);
+			while (lua_next(L, -2))
+			{
+				lua_pop(L, 1);
+				if (lua_type(L, -1) == LUA_TSTRING && !m_lib_modules.Contains(lua_tostring(L, -1)))
+				{
+					modules.Add(lua_tostring(L, -1));
+				}
+			}
+			for (const auto& i : modules)
+			{
+				lua_pushnil(L);
+				lua_setfield(L, -2, i.CString());
+			}
+			lua_pop(L, 2);
+
+			return L;
+		}
+
+	private:
+		lua_State* L;
+		String m_package_path;
+		Vector<String> m_lib_modules;
+	};
+
+	static UTILS_DEFINE_TLS(Ref<ShaderLuaState>) g_lua_state;
+
+	void Shader::Load(const String& name, const String& src, Vector<Pass>& passes)
+	{
+		Ref<ShaderLuaState>& state = g_lua_state;
+		if (!state)
+		{
+			state = RefMake<ShaderLuaState>();
+		}
+
+		String dir = Engine::Instance()->GetDataPath() + "/shader/" + name;
 		dir = dir.Substring(0, dir.LastIndexOf("/"));
-		AddLuaPath(L, dir + "/?.lua");
+		lua_State* L = state->Begin(dir);
 
 		if (luaL_dostring(L, src.CString()) != 0)
 		{
@@ -370,22 +800,7 @@ namespace Viry3D
 						pass.pipeline.rasterState.colorWrite = color_write;
 
 						GetTableInt(L, "Queue", pass.queue);
-
-						if (m_queue < pass.queue)
-						{
-							m_queue = pass.queue;
-						}
-
 						GetTableInt(L, "LightMode", pass.light_mode);
-
-						if (pass.light_mode == LightMode::Forward && m_keywords.Contains("LIGHT_ADD_ON"))
-						{
-							pass.pipeline.rasterState.depthWrite = false;
-							pass.pipeline.rasterState.blendFunctionSrcRGB = src_color_blend;
-							pass.pipeline.rasterState.blendFunctionSrcAlpha = src_alpha_blend;
-							pass.pipeline.rasterState.blendFunctionDstRGB = filament::backend::BlendFunction::ONE;
-							pass.pipeline.rasterState.blendFunctionDstAlpha = filament::backend::BlendFunction::ONE;
-						}
 					}
 					lua_pop(L, 1);
 
@@ -476,20 +891,25 @@ namespace Viry3D
 					}
 					lua_pop(L, 1);
 
-					m_passes.Add(pass);
+					passes.Add(pass);
 				}
 				lua_pop(L, 1);
 			}
 			lua_pop(L, 1);
 		}
 
-		lua_close(L);
+		lua_settop(L, 0);
 	}
 
 	void Shader::Compile()
 	{
-		auto& driver = Engine::Instance()->GetDriverApi();
+		Vector<Binary> binaries;
+		this->CompileBinaries(binaries);
+		this->CreatePrograms(binaries);
+	}
 
+	void Shader::CompileBinaries(Vector<Binary>& binaries)
+	{
 #if VR_WINDOWS || VR_MAC
 		String version = "#version 410\n";
 #else
@@ -519,7 +939,8 @@ namespace Viry3D
 				"#extension GL_ARB_shading_language_420pack : enable\n"
 				"#define VK_LAYOUT_LOCATION(i) layout(location = i)\n"
 				"#define VK_UNIFORM_BINDING(i) layout(std140, set = 0, binding = i)\n"
-				"#define VK_SAMPLER_BINDING(i) layout(set = 1, binding = i)\n";
+				"#define VK_SAMPLER_BINDING(i) layout(set = 1, binding = i)\n"
+				"#define VK_INSTANCE_INDEX gl_InstanceIndex\n";
 			if (Engine::Instance()->GetBackend() == filament::backend::Backend::VULKAN ||
 				Engine::Instance()->GetBackend() == filament::backend::Backend::METAL)
 			{
@@ -533,12 +954,15 @@ namespace Viry3D
 				vk_convert = "void vk_convert() { }\n";
 			}
 		}
-		else if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL)
+		else if (Engine::Instance()->GetBackend() == filament::backend::Backend::OPENGL ||
+			Engine::Instance()->GetBackend() == filament::backend::Backend::NOOP)
 		{
+			// noop driver ignores programs, gl source keeps loading path same as a real backend
 			define = "#define VR_GLES 1\n"
 				"#define VK_LAYOUT_LOCATION(i)\n"
 				"#define VK_UNIFORM_BINDING(i) layout(std140)\n"
-				"#define VK_SAMPLER_BINDING(i)\n";
+				"#define VK_SAMPLER_BINDING(i)\n"
+				"#define VK_INSTANCE_INDEX gl_InstanceID\n";
 			vk_convert = "void vk_convert() { }\n";
 		}
 		else
@@ -551,15 +975,17 @@ namespace Viry3D
 			define += "#define " + i + " 1\n";
 		}
 
+		binaries.Resize(m_passes.Size());
+
 		for (int i = 0; i < m_passes.Size(); ++i)
 		{
-			auto& pass = m_passes[i];
+			const auto& pass = m_passes[i];
 
 			String vs = version + define + vk_convert + pass.vs;
 			String fs = version + define + pass.fs;
 			
-			Vector<char> vs_data;
-			Vector<char> fs_data;
+			Vector<char>& vs_data = binaries[i].vs;
+			Vector<char>& fs_data = binaries[i].fs;
 
             if (Engine::Instance()->GetBackend() == filament::backend::Backend::VULKAN)
             {
@@ -677,6 +1103,27 @@ namespace Viry3D
 				fs_data.Resize(fs.Size());
 				memcpy(&fs_data[0], &fs[0], fs_data.Size());
 			}
+		}
+	}
+
+	void Shader::CreatePrograms(const Vector<Binary>& binaries)
+	{
+		auto& driver = Engine::Instance()->GetDriverApi();
+
+		if (m_cache_hit)
+		{
+			RenderStats::AddShaderVariantCacheHit();
+		}
+		else
+		{
+			RenderStats::AddShaderVariantCompiled();
+		}
+
+		for (int i = 0; i < m_passes.Size(); ++i)
+		{
+			auto& pass = m_passes[i];
+			const auto& vs_data = binaries[i].vs;
+			const auto& fs_data = binaries[i].fs;
 
 			filament::backend::Program pb;
 			pb.diagnostics(utils::CString(this->GetName().CString()))
@@ -706,4 +1153,295 @@ namespace Viry3D
 			pass.pipeline.program = driver.createProgram(std::move(pb));
 		}
 	}
+
+	static void CacheWriteInt(Vector<char>& buffer, int value)
+	{
+		buffer.AddRange((const char*) &value, sizeof(value));
+	}
+
+	static void CacheWriteString(Vector<char>& buffer, const String& str)
+	{
+		CacheWriteInt(buffer, str.Size());
+		buffer.AddRange(str.CString(), str.Size());
+	}
+
+	static void CacheWriteBytes(Vector<char>& buffer, const Vector<char>& bytes)
+	{
+		CacheWriteInt(buffer, bytes.Size());
+		if (bytes.Size() > 0)
+		{
+			buffer.AddRange(&bytes[0], bytes.Size());
+		}
+	}
+
+	// bounds checked reads, a truncated or corrupt file sets error
+	struct CacheReader
+	{
+		const byte* bytes;
+		int size;
+		int offset;
+		bool error;
+
+		bool Read(void* data, int count)
+		{
+			if (error || count < 0 || offset + count > size)
+			{
+				error = true;
+				return false;
+			}
+			Memory::Copy(data, &bytes[offset], count);
+			offset += count;
+			return true;
+		}
+
+		int ReadInt()
+		{
+			int value = 0;
+			this->Read(&value, sizeof(value));
+			return value;
+		}
+
+		String ReadString()
+		{
+			int count = this->ReadInt();
+			if (error || count < 0 || offset + count > size)
+			{
+				error = true;
+				return String();
+			}
+			String str((const char*) &bytes[offset], count);
+			offset += count;
+			return str;
+		}
+
+		void ReadBytes(Vector<char>& data)
+		{
+			int count = this->ReadInt();
+			if (error || count < 0 || offset + count > size)
+			{
+				error = true;
+				return;
+			}
+			data.Resize(count);
+			if (count > 0)
+			{
+				this->Read(&data[0], count);
+			}
+		}
+	};
+
+	static String Md5ToString(MD5_CTX& md5_context)
+	{
+		unsigned char hash_bytes[16];
+		MD5_Final(hash_bytes, &md5_context);
+		String md5_str;
+		for (size_t i = 0; i < sizeof(hash_bytes); ++i)
+		{
+			md5_str += String::Format("%02x", hash_bytes[i]);
+		}
+		return md5_str;
+	}
+
+	String Shader::HashSource(const String& path, const String& src)
+	{
+		MD5_CTX md5_context;
+		MD5_Init(&md5_context);
+		MD5_Update(&md5_context, (void*) src.CString(), src.Size());
+
+		// modules included by require are part of the source
+		String dir = path.Substring(0, path.LastIndexOf("/"));
+		String require = "require(\"";
+		int begin = src.IndexOf(require);
+		while (begin >= 0)
+		{
+			begin += require.Size();
+			int end = src.IndexOf("\"", begin);
+			if (end < 0)
+			{
+				break;
+			}
+
+			String module_path = dir + "/" + src.Substring(begin, end - begin) + ".lua";
+			if (File::Exist(module_path))
+			{
+				String module_src = File::ReadAllText(module_path);
+				MD5_Update(&md5_context, (void*) module_src.CString(), module_src.Size());
+			}
+
+			begin = src.IndexOf(require, end);
+		}
+
+		return Md5ToString(md5_context);
+	}
+
+	String Shader::GetCachePath(const String& source_hash, const String& key)
+	{
+		int header[3] = {
+			SHADER_CACHE_VERSION,
+			(int) Engine::Instance()->GetBackend(),
+			(int) Engine::Instance()->GetShaderModel()
+		};
+
+		MD5_CTX md5_context;
+		MD5_Init(&md5_context);
+		MD5_Update(&md5_context, (void*) header, sizeof(header));
+		MD5_Update(&md5_context, (void*) key.CString(), key.Size());
+		MD5_Update(&md5_context, (void*) source_hash.CString(), source_hash.Size());
+
+		return Engine::Instance()->GetSavePath() + "/" + Md5ToString(md5_context) + ".cache";
+	}
+
+	bool Shader::LoadCache(const String& path, Vector<Binary>& binaries)
+	{
+		if (!File::Exist(path))
+		{
+			return false;
+		}
+
+		ByteBuffer buffer = File::ReadAllBytes(path);
+
+		CacheReader reader;
+		reader.bytes = buffer.Bytes();
+		reader.size = buffer.Size();
+		reader.offset = 0;
+		reader.error = false;
+
+		int magic = reader.ReadInt();
+		int version = reader.ReadInt();
+		if (magic != SHADER_CACHE_MAGIC || version != SHADER_CACHE_VERSION)
+		{
+			return false;
+		}
+
+		int pass_count = reader.ReadInt();
+		for (int i = 0; i < pass_count && !reader.error; ++i)
+		{
+			Pass pass;
+			pass.vs = reader.ReadString();
+			pass.fs = reader.ReadString();
+			pass.queue = reader.ReadInt();
+			pass.light_mode = (LightMode) reader.ReadInt();
+			reader.Read(&pass.pipeline.rasterState.u, sizeof(pass.pipeline.rasterState.u));
+
+			int uniform_count = reader.ReadInt();
+			for (int j = 0; j < uniform_count && !reader.error; ++j)
+			{
+				Uniform uniform;
+				uniform.name = reader.ReadString();
+				uniform.binding = reader.ReadInt();
+				uniform.size = reader.ReadInt();
+
+				int member_count = reader.ReadInt();
+				for (int k = 0; k < member_count && !reader.error; ++k)
+				{
+					Member member;
+					member.name = reader.ReadString();
+					member.offset = reader.ReadInt();
+					member.size = reader.ReadInt();
+					uniform.members.Add(member);
+				}
+
+				pass.uniforms.Add(uniform);
+			}
+
+			int group_count = reader.ReadInt();
+			for (int j = 0; j < group_count && !reader.error; ++j)
+			{
+				SamplerGroup group;
+				group.name = reader.ReadString();
+				group.binding = reader.ReadInt();
+
+				int sampler_count = reader.ReadInt();
+				for (int k = 0; k < sampler_count && !reader.error; ++k)
+				{
+					Sampler sampler;
+					sampler.name = reader.ReadString();
+					sampler.binding = reader.ReadInt();
+					group.samplers.Add(sampler);
+				}
+
+				pass.samplers.Add(group);
+			}
+
+			Binary binary;
+			reader.ReadBytes(binary.vs);
+			reader.ReadBytes(binary.fs);
+
+			m_passes.Add(pass);
+			binaries.Add(binary);
+		}
+
+		if (reader.error || reader.offset != reader.size)
+		{
+			Log("shader cache invalid: %s", path.CString());
+
+			m_passes.Clear();
+			binaries.Clear();
+			return false;
+		}
+
+		for (const auto& pass : m_passes)
+		{
+			if (m_queue < pass.queue)
+			{
+				m_queue = pass.queue;
+			}
+		}
+
+		return true;
+	}
+
+	void Shader::SaveCache(const String& path, const Vector<Binary>& binaries)
+	{
+		Vector<char> buffer;
+		CacheWriteInt(buffer, SHADER_CACHE_MAGIC);
+		CacheWriteInt(buffer, SHADER_CACHE_VERSION);
+		CacheWriteInt(buffer, m_passes.Size());
+
+		for (int i = 0; i < m_passes.Size(); ++i)
+		{
+			const auto& pass = m_passes[i];
+			CacheWriteString(buffer, pass.vs);
+			CacheWriteString(buffer, pass.fs);
+			CacheWriteInt(buffer, pass.queue);
+			CacheWriteInt(buffer, (int) pass.light_mode);
+			buffer.AddRange((const char*) &pass.pipeline.rasterState.u, sizeof(pass.pipeline.rasterState.u));
+
+			CacheWriteInt(buffer, pass.uniforms.Size());
+			for (const auto& uniform : pass.uniforms)
+			{
+				CacheWriteString(buffer, uniform.name);
+				CacheWriteInt(buffer, uniform.binding);
+				CacheWriteInt(buffer, uniform.size);
+				CacheWriteInt(buffer, uniform.members.Size());
+				for (const auto& member : uniform.members)
+				{
+					CacheWriteString(buffer, member.name);
+					CacheWriteInt(buffer, member.offset);
+					CacheWriteInt(buffer, member.size);
+				}
+			}
+
+			CacheWriteInt(buffer, pass.samplers.Size());
+			for (const auto& group : pass.samplers)
+			{
+				CacheWriteString(buffer, group.name);
+				CacheWriteInt(buffer, group.binding);
+				CacheWriteInt(buffer, group.samplers.Size());
+				for (const auto& sampler : group.samplers)
+				{
+					CacheWriteString(buffer, sampler.name);
+					CacheWriteInt(buffer, sampler.binding);
+				}
+			}
+
+			CacheWriteBytes(buffer, binaries[i].vs);
+			CacheWriteBytes(buffer, binaries[i].fs);
+		}
+
+		if (!File::WriteAllBytes(path, ByteBuffer((byte*) &buffer[0], buffer.Size())))
+		{
+			Log("shader cache write failed: %s", path.CString());
+		}
+	}
 }
@@ -21,6 +21,7 @@
 #include "container/Vector.h"
 #include "container/List.h"
 #include "container/Map.h"
+#include "thread/Future.h"
 #include "private/backend/DriverApi.h"
 
 namespace Viry3D
@@ -28,6 +29,10 @@ namespace Viry3D
     class Shader : public Object
     {
     public:
+		// keywords are interned to ids, a keyword set is a bit mask of ids
+		typedef uint64_t KeywordMask;
+		static constexpr int KEYWORD_MAX_COUNT = 64;
+
 		enum class BindingPoint
 		{
 			PerView = 0,
@@ -37,6 +42,9 @@ namespace Viry3D
 			PerMaterialFragment = 4,
 			PerLightVertex = 5,
 			PerLightFragment = 6,
+			PerViewLights = 7,
+			PerViewLightIndices = 8,
+			PerRendererInstances = 9,
 
 			Count = filament::backend::CONFIG_UNIFORM_BINDING_COUNT,
 		};
@@ -98,6 +106,17 @@ namespace Viry3D
 			Vector<Sampler> samplers;
 		};
 
+		// where a property is written, uniform member or sampler of a pass
+		struct PropertyLocation
+		{
+			int pass;
+			int binding;
+			bool sampler;
+			int offset; // member offset, sampler index in group
+			int size; // member size, sampler binding
+			int block_size; // uniform block size, sampler count in group
+		};
+
 		struct Pass
 		{
 			String vs;
@@ -112,27 +131,83 @@ namespace Viry3D
         static void Init();
         static void Done();
         static String MakeKey(const String& name, const Vector<String>& keywords);
+		// -1 for keywords past KEYWORD_MAX_COUNT, they are left out of masks and variants
+		static int KeywordToID(const String& keyword);
+		static KeywordMask KeywordToMask(const String& keyword);
+		static KeywordMask KeywordsToMask(const Vector<String>& keywords);
 		static Ref<Shader> Find(const String& name, const Vector<String>& keywords = Vector<String>());
+		static Ref<Shader> Find(const String& name, KeywordMask keywords);
+		// parses and compiles variant on worker threads, programs are created and future is ready on main thread.
+		// value is null if shader not exist, requests for a variant being compiled share one future
+		static Future<Ref<Shader>> FindAsync(const String& name, KeywordMask keywords);
+		// variant already compiled or null, never compiles
+		static Ref<Shader> FindLoaded(const String& name, KeywordMask keywords);
+		// interned property id shared by all shaders and materials
+		static int PropertyToID(const String& name);
+		static const String& IDToProperty(int id) { return m_property_names[id]; }
         static Ref<Shader> Create(const Vector<Pass>& passes, const Vector<String>& keywords = Vector<String>());
 
         virtual ~Shader();
         const String& GetShaderKey() const { return m_shader_key; }
 		const Vector<String>& GetKeywords() const { return m_keywords; }
+		KeywordMask GetKeywordMask() const { return m_keyword_mask; }
 		int GetPassCount() const { return m_passes.Size(); }
 		const Pass& GetPass(int index) const { return m_passes[index]; }
         int GetQueue() const { return m_queue; }
         bool IsForwardLight() const;
+        // shader reads clustered light buffers, lighted in one pass
+        bool IsClusterLight() const;
+        // shader reads model matrices from instance buffer when INSTANCING_ON
+        bool IsInstancing() const;
+		const PropertyLocation* GetPropertyLocations(int id, int* count) const;
 
 	private:
+		// compiled vertex and fragment program data of a pass
+		struct Binary
+		{
+			Vector<char> vs;
+			Vector<char> fs;
+		};
+
+		// file text and parsed passes shared by variants of a shader name
+		struct Source;
+
 		Shader(const String& name);
-		void Load(const String& src);
+		static Vector<String> MaskToKeywords(KeywordMask keywords);
+		static Ref<Shader> CreateVariant(const String& name, KeywordMask keyword_mask, const Vector<String>& keywords, const String& key);
+		// reads source and produces passes and binaries, touches no driver or shared state
+		bool Build(Vector<Binary>& binaries);
+		static Ref<Source> GetSource(const String& name);
+		// keyword independent, keyword tweaks are applied by Build
+		static void Load(const String& name, const String& src, Vector<Pass>& passes);
 		void Compile();
+		void CompileBinaries(Vector<Binary>& binaries);
+		void CreatePrograms(const Vector<Binary>& binaries);
+		// disk cache of parsed passes and program binaries per variant
+		static String HashSource(const String& path, const String& src);
+		static String GetCachePath(const String& source_hash, const String& key);
+		bool LoadCache(const String& path, Vector<Binary>& binaries);
+		void SaveCache(const String& path, const Vector<Binary>& binaries);
+		void UpdatePropertyLocations();
+		bool HasUniformBinding(BindingPoint binding) const;
 
 	private:
 		static Map<String, Ref<Shader>> m_shaders;
+		static Map<String, Future<Ref<Shader>>> m_compiling_shaders;
+		static Map<String, Ref<Source>> m_sources;
+		static Mutex m_sources_mutex;
+		static Map<String, int> m_keyword_ids;
+		static Vector<String> m_keyword_names;
+		static Map<String, int> m_property_ids;
+		static Vector<String> m_property_names;
         String m_shader_key;
 		Vector<String> m_keywords;
+		KeywordMask m_keyword_mask;
 		Vector<Pass> m_passes;
 		int m_queue;
+		// binaries of last Build came from disk cache
+		bool m_cache_hit;
+		Vector<PropertyLocation> m_property_locations;
+		Vector<int> m_property_location_ranges; // begin and count per property id
     };
 }
@@ -0,0 +1,119 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ShaderVariantCollection.h"
+#include "Engine.h"
+#include "Debug.h"
+#include "io/File.h"
+#include "json/json.h"
+
+namespace Viry3D
+{
+    Ref<ShaderVariantCollection> ShaderVariantCollection::LoadFromFile(const String& path)
+    {
+        Ref<ShaderVariantCollection> collection;
+
+        String full_path = Engine::Instance()->GetDataPath() + "/" + path;
+        if (!File::Exist(full_path))
+        {
+            Log("shader variant collection not exist: %s", full_path.CString());
+            return collection;
+        }
+
+        String json = File::ReadAllText(full_path);
+
+        auto reader = Ref<Json::CharReader>(Json::CharReaderBuilder().newCharReader());
+        Json::Value root;
+        const char* begin = json.CString();
+        const char* end = begin + json.Size();
+        if (reader->parse(begin, end, &root, nullptr) && root.isArray())
+        {
+            collection = RefMake<ShaderVariantCollection>();
+            collection->SetName(path);
+
+            for (Json::ArrayIndex i = 0; i < root.size(); ++i)
+            {
+                const Json::Value& item = root[i];
+
+                Vector<String> keywords;
+                const Json::Value& keyword_array = item["keywords"];
+                for (Json::ArrayIndex j = 0; j < keyword_array.size(); ++j)
+                {
+                    keywords.Add(keyword_array[j].asCString());
+                }
+
+                collection->Add(item["shader"].asCString(), keywords);
+            }
+        }
+        else
+        {
+            Log("shader variant collection parse error: %s", full_path.CString());
+        }
+
+        return collection;
+    }
+
+    ShaderVariantCollection::ShaderVariantCollection()
+    {
+
+    }
+
+    ShaderVariantCollection::~ShaderVariantCollection()
+    {
+
+    }
+
+    void ShaderVariantCollection::Add(const String& shader, const Vector<String>& keywords)
+    {
+        Variant variant;
+        variant.shader = shader;
+        variant.keywords = keywords;
+        m_variants.Add(variant);
+    }
+
+    bool ShaderVariantCollection::IsWarmedUp() const
+    {
+        for (const auto& i : m_variants)
+        {
+            if (!Shader::FindLoaded(i.shader, Shader::KeywordsToMask(i.keywords)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Future<bool> ShaderVariantCollection::WarmUp()
+    {
+        Vector<Future<Ref<Shader>>> futures;
+        for (const auto& i : m_variants)
+        {
+            futures.Add(Shader::FindAsync(i.shader, Shader::KeywordsToMask(i.keywords)));
+        }
+
+        return Task::WhenAll(futures).Then([](const Vector<Ref<Shader>>& shaders) {
+            for (const auto& i : shaders)
+            {
+                if (!i)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }, TaskContext::MainThread);
+    }
+}
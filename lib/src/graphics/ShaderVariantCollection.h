@@ -0,0 +1,50 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "Shader.h"
+#include "thread/Future.h"
+
+namespace Viry3D
+{
+    // list of shader variants to compile before they are drawn, such as during a loading screen.
+    // file is a json array of { "shader": "Diffuse", "keywords": ["SKIN_ON"] }
+    class ShaderVariantCollection : public Object
+    {
+    public:
+        struct Variant
+        {
+            String shader;
+            Vector<String> keywords;
+        };
+
+        static Ref<ShaderVariantCollection> LoadFromFile(const String& path);
+        ShaderVariantCollection();
+        virtual ~ShaderVariantCollection();
+        void Add(const String& shader, const Vector<String>& keywords = Vector<String>());
+        int GetVariantCount() const { return m_variants.Size(); }
+        const Variant& GetVariant(int index) const { return m_variants[index]; }
+        bool IsWarmedUp() const;
+        // compiles all variants on worker threads in parallel, ready on main thread,
+        // value is false if any shader not exist
+        Future<bool> WarmUp();
+
+    private:
+        Vector<Variant> m_variants;
+    };
+}
@@ -17,13 +17,18 @@
 
 #include "SkinnedMeshRenderer.h"
 #include "GameObject.h"
+#include "Texture.h"
 #include "Engine.h"
+#include "RenderStats.h"
 #include "Debug.h"
+#include "math/Mathf.h"
 
 namespace Viry3D
 {
     SkinnedMeshRenderer::SkinnedMeshRenderer():
 		m_blend_shape_dirty(false),
+        m_world_bounds_valid(false),
+        m_bones_texture_enable(false),
 		m_vb_vertex_count(0)
     {
 
@@ -38,6 +43,12 @@ namespace Viry3D
             driver.destroyUniformBuffer(m_bones_uniform_buffer);
 			m_bones_uniform_buffer.clear();
         }
+        if (m_bones_sampler_group)
+        {
+            driver.destroySamplerGroup(m_bones_sampler_group);
+            m_bones_sampler_group.clear();
+        }
+        m_bones_texture.reset();
         if (m_blend_shape_sampler_group)
         {
             driver.destroySamplerGroup(m_blend_shape_sampler_group);
@@ -62,6 +73,8 @@ namespace Viry3D
 		MeshRenderer::SetMesh(mesh);
 
 		m_blend_shape_weights.Clear();
+		m_bone_bounds.Clear();
+		m_world_bounds_valid = false;
 
 		auto& driver = Engine::Instance()->GetDriverApi();
 		if (m_vb)
@@ -127,6 +140,57 @@ namespace Viry3D
 		}
 	}
 
+    Bounds SkinnedMeshRenderer::GetWorldBounds() const
+    {
+        if (m_world_bounds_valid)
+        {
+            return m_world_bounds;
+        }
+
+        return Renderer::GetWorldBounds();
+    }
+
+    void SkinnedMeshRenderer::UpdateBoneBounds(const Ref<Mesh>& mesh)
+    {
+        const auto& vertices = mesh->GetVertices();
+        const auto& bindposes = mesh->GetBindposes();
+        int bone_count = bindposes.Size();
+
+        Vector<Vector3> mins(bone_count);
+        Vector<Vector3> maxs(bone_count);
+        for (int i = 0; i < bone_count; ++i)
+        {
+            mins[i] = Vector3(Mathf::MaxFloatValue, Mathf::MaxFloatValue, Mathf::MaxFloatValue);
+            maxs[i] = Vector3(Mathf::MinFloatValue, Mathf::MinFloatValue, Mathf::MinFloatValue);
+        }
+
+        // blended vertex lies between its positions skinned by each bone, so union of bone bounds contains it
+        for (const auto& v : vertices)
+        {
+            Vector3 pos(v.vertex.x, v.vertex.y, v.vertex.z);
+            const float* weights = &v.bone_weights.x;
+            const float* indices = &v.bone_indices.x;
+
+            for (int j = 0; j < 4; ++j)
+            {
+                int bone = (int) indices[j];
+                if (weights[j] > 0 && bone >= 0 && bone < bone_count)
+                {
+                    Vector3 bone_pos = bindposes[bone].MultiplyPoint3x4(pos);
+                    mins[bone] = Vector3::Min(mins[bone], bone_pos);
+                    maxs[bone] = Vector3::Max(maxs[bone], bone_pos);
+                }
+            }
+        }
+
+        // bones without vertices only add their position
+        m_bone_bounds.Resize(bone_count);
+        for (int i = 0; i < bone_count; ++i)
+        {
+            m_bone_bounds[i] = mins[i].x <= maxs[i].x ? Bounds(mins[i], maxs[i]) : Bounds();
+        }
+    }
+
     void SkinnedMeshRenderer::FindBones()
     {
         auto root = m_bones_root.lock();
@@ -147,6 +211,45 @@ namespace Viry3D
         }
     }
 
+    void SkinnedMeshRenderer::UpdateBonesTexture(int bone_count)
+    {
+        auto& driver = Engine::Instance()->GetDriverApi();
+
+        if (!m_bones_texture || m_bones_texture->GetHeight() != bone_count)
+        {
+            m_bones_texture = Texture::CreateTexture2D(
+                SkinnedMeshRendererUniforms::BONES_TEXTURE_WIDTH,
+                bone_count,
+                TextureFormat::R32G32B32A32F,
+                FilterMode::Nearest,
+                SamplerAddressMode::ClampToEdge,
+                false);
+
+            if (!m_bones_sampler_group)
+            {
+                m_bones_sampler_group = driver.createSamplerGroup(1);
+            }
+            filament::backend::SamplerGroup samplers(1);
+            samplers.setSampler(0, m_bones_texture->GetTexture(), m_bones_texture->GetSampler());
+            driver.updateSamplerGroup(m_bones_sampler_group, std::move(samplers));
+        }
+
+        ByteBuffer pixels((byte*) m_bone_vectors.Bytes(), m_bone_vectors.SizeInBytes());
+        m_bones_texture->UpdateTexture(pixels, 0, 0, 0, 0, SkinnedMeshRendererUniforms::BONES_TEXTURE_WIDTH, bone_count);
+    }
+
+    bool SkinnedMeshRenderer::IsBonesTextureNeeded(int bone_count)
+    {
+        return bone_count > SkinnedMeshRendererUniforms::BONES_VECTOR_MAX_COUNT / 3;
+    }
+
+    void SkinnedMeshRenderer::PackBone(Vector<Vector4>& vectors, int bone, const Matrix4x4& mat)
+    {
+        vectors[bone * 3 + 0] = mat.GetRow(0);
+        vectors[bone * 3 + 1] = mat.GetRow(1);
+        vectors[bone * 3 + 2] = mat.GetRow(2);
+    }
+
     void SkinnedMeshRenderer::Prepare()
     {
         auto& driver = Engine::Instance()->GetDriverApi();
@@ -160,7 +263,25 @@ namespace Viry3D
             int bone_count = bindposes.Size();
 
             assert(m_bone_paths.Size() == bone_count);
-            assert(m_bone_paths.Size() <= SkinnedMeshRendererUniforms::BONES_VECTOR_MAX_COUNT / 3);
+            assert(m_bone_paths.Size() <= SkinnedMeshRendererUniforms::BONES_TEXTURE_MAX_COUNT);
+
+            bool bones_texture_enable = IsBonesTextureNeeded(bone_count);
+            if (m_bones_texture_enable != bones_texture_enable)
+            {
+                m_bones_texture_enable = bones_texture_enable;
+
+                if (m_bones_texture_enable)
+                {
+                    // no texel fetch in vertex shader on gles 2.0
+                    assert(Engine::Instance()->GetShaderModel() != filament::backend::ShaderModel::GL_ES_20);
+
+                    this->EnableShaderKeyword("SKIN_TEXTURE_ON");
+                }
+                else
+                {
+                    this->DisableShaderKeyword("SKIN_TEXTURE_ON");
+                }
+            }
 
             if (m_bones.Empty())
             {
@@ -169,23 +290,45 @@ namespace Viry3D
 
 			m_bone_vectors.Resize(bone_count * 3);
 
+            if (m_bone_bounds.Size() != bone_count)
+            {
+                this->UpdateBoneBounds(mesh);
+            }
+
             for (int i = 0; i < bone_count; ++i)
             {
-                Matrix4x4 mat = m_bones[i].lock()->GetLocalToWorldMatrix() * bindposes[i];
+                Matrix4x4 bone_matrix = m_bones[i].lock()->GetLocalToWorldMatrix();
+                PackBone(m_bone_vectors, i, bone_matrix * bindposes[i]);
 
-				m_bone_vectors[i * 3 + 0] = mat.GetRow(0);
-				m_bone_vectors[i * 3 + 1] = mat.GetRow(1);
-				m_bone_vectors[i * 3 + 2] = mat.GetRow(2);
+                // skinned vertices are in world space
+                Bounds bone_bounds = m_bone_bounds[i].Transform(bone_matrix);
+                if (i == 0)
+                {
+                    m_world_bounds = bone_bounds;
+                }
+                else
+                {
+                    m_world_bounds.Encapsulate(bone_bounds);
+                }
             }
+            m_world_bounds_valid = bone_count > 0;
 
-            if (!m_bones_uniform_buffer)
+            if (m_bones_texture_enable)
             {
-                m_bones_uniform_buffer = driver.createUniformBuffer(sizeof(SkinnedMeshRendererUniforms), filament::backend::BufferUsage::DYNAMIC);
+                this->UpdateBonesTexture(bone_count);
             }
+            else
+            {
+                if (!m_bones_uniform_buffer)
+                {
+                    m_bones_uniform_buffer = driver.createUniformBuffer(sizeof(SkinnedMeshRendererUniforms), filament::backend::BufferUsage::DYNAMIC);
+                }
 
-			void* buffer = driver.allocate(m_bone_vectors.SizeInBytes());
-            Memory::Copy(buffer, m_bone_vectors.Bytes(), m_bone_vectors.SizeInBytes());
-            driver.loadUniformBuffer(m_bones_uniform_buffer, filament::backend::BufferDescriptor(buffer, m_bone_vectors.SizeInBytes()));
+                void* buffer = driver.allocate(m_bone_vectors.SizeInBytes());
+                Memory::Copy(buffer, m_bone_vectors.Bytes(), m_bone_vectors.SizeInBytes());
+                driver.loadUniformBuffer(m_bones_uniform_buffer, filament::backend::BufferDescriptor(buffer, m_bone_vectors.SizeInBytes()));
+                RenderStats::AddUniformUpload(m_bone_vectors.SizeInBytes());
+            }
         }
 
 		// update blend shapes
@@ -217,6 +360,7 @@ namespace Viry3D
                 void* buffer = driver.allocate(m_bone_vectors.SizeInBytes());
                 Memory::Copy(buffer, m_bone_vectors.Bytes(), m_bone_vectors.SizeInBytes());
                 driver.loadUniformBuffer(m_bones_uniform_buffer, filament::backend::BufferDescriptor(buffer, m_bone_vectors.SizeInBytes()));
+                RenderStats::AddUniformUpload(m_bone_vectors.SizeInBytes());
                 
                 // blend shape sampler
                 if (!m_blend_shape_sampler_group)
@@ -294,6 +438,7 @@ namespace Viry3D
                 }
 
                 driver.updateVertexBuffer(m_vb, 0, filament::backend::BufferDescriptor(buffer, vertices.SizeInBytes()), 0);
+                RenderStats::AddBufferUpload(vertices.SizeInBytes());
             }
 		}
         
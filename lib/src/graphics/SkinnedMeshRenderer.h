@@ -22,6 +22,8 @@
 
 namespace Viry3D
 {
+    class Texture;
+
     class SkinnedMeshRenderer : public MeshRenderer
     {
     public:
@@ -36,14 +38,25 @@ namespace Viry3D
         void SetBlendShapeWeight(const String& name, float weight);
 		const Vector<Vector4>& GetBoneVectors() const { return m_bone_vectors; };
         const filament::backend::UniformBufferHandle& GetBonesUniformBuffer() const { return m_bones_uniform_buffer; }
+        // bone palette is stored in a float texture when bones exceed uniform block budget
+        bool IsBonesTextureEnable() const { return m_bones_texture_enable; }
+        const Ref<Texture>& GetBonesTexture() const { return m_bones_texture; }
+        const filament::backend::SamplerGroupHandle& GetBonesSamplerGroup() const { return m_bones_sampler_group; }
         const filament::backend::SamplerGroupHandle& GetBlendShapeSamplerGroup() const { return m_blend_shape_sampler_group; }
         virtual Vector<filament::backend::RenderPrimitiveHandle> GetPrimitives();
+        // follows bones updated in last prepare, mesh bounds are bind pose
+        virtual Bounds GetWorldBounds() const;
+        static bool IsBonesTextureNeeded(int bone_count);
+        // bone is packed as 3 rows at vectors[bone * 3], same as texels (0, bone) to (2, bone) in bones texture
+        static void PackBone(Vector<Vector4>& vectors, int bone, const Matrix4x4& mat);
         
 	protected:
 		virtual void Prepare();
 
     private:
         void FindBones();
+        void UpdateBoneBounds(const Ref<Mesh>& mesh);
+        void UpdateBonesTexture(int bone_count);
 
 	private:
 		struct BlendShapeWeight
@@ -59,7 +72,14 @@ namespace Viry3D
 		Map<String, BlendShapeWeight> m_blend_shape_weights;
 		bool m_blend_shape_dirty;
 		Vector<Vector4> m_bone_vectors;
+        // bounds of vertices skinned by each bone in bone space
+        Vector<Bounds> m_bone_bounds;
+        Bounds m_world_bounds;
+        bool m_world_bounds_valid;
         filament::backend::UniformBufferHandle m_bones_uniform_buffer;
+        bool m_bones_texture_enable;
+        Ref<Texture> m_bones_texture;
+        filament::backend::SamplerGroupHandle m_bones_sampler_group;
         filament::backend::SamplerGroupHandle m_blend_shape_sampler_group;
 		filament::backend::VertexBufferHandle m_vb;
 		Vector<filament::backend::RenderPrimitiveHandle> m_primitives;
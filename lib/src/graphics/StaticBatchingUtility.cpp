@@ -0,0 +1,223 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "StaticBatchingUtility.h"
+#include "MeshRenderer.h"
+#include "SkinnedMeshRenderer.h"
+#include "Skybox.h"
+#include "Mesh.h"
+#include "math/Mathf.h"
+
+namespace Viry3D
+{
+    static bool IsSameMaterials(const Vector<Ref<Material>>& a, const Vector<Ref<Material>>& b)
+    {
+        if (a.Size() != b.Size())
+        {
+            return false;
+        }
+        for (int i = 0; i < a.Size(); ++i)
+        {
+            if (a[i] != b[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // batch root draws all members with one set of render states
+    static bool IsSameStates(const Ref<MeshRenderer>& a, const Ref<MeshRenderer>& b)
+    {
+        return a->GetGameObject()->GetLayer() == b->GetGameObject()->GetLayer() &&
+            a->IsCastShadow() == b->IsCastShadow() &&
+            a->IsRecieveShadow() == b->IsRecieveShadow() &&
+            a->GetShaderKeywordMask() == b->GetShaderKeywordMask() &&
+            a->GetLightmapIndex() == b->GetLightmapIndex() &&
+            a->GetMaxLightCount() == b->GetMaxLightCount();
+    }
+
+    static bool CanCombine(const Ref<MeshRenderer>& renderer)
+    {
+        const auto& mesh = renderer->GetMesh();
+
+        return mesh &&
+            !renderer->IsStaticBatched() &&
+            !RefCast<SkinnedMeshRenderer>(renderer) &&
+            !RefCast<Skybox>(renderer) &&
+            !renderer->HasPropertyBlock() &&
+            renderer->GetMaterials().Size() > 0 &&
+            mesh->GetPrimitiveType() == filament::backend::PrimitiveType::TRIANGLES &&
+            mesh->GetBlendShapes().Size() == 0 &&
+            mesh->GetVertices().Size() > 0 &&
+            mesh->GetVertices().Size() <= StaticBatchingUtility::BATCH_VERTEX_MAX_COUNT;
+    }
+
+    void StaticBatchingUtility::CombineBatch(const Ref<GameObject>& root, const Batch& batch)
+    {
+        const auto& first = batch.renderers[0];
+        int material_count = batch.materials.Size();
+        int member_count = batch.renderers.Size();
+
+        Vector<Mesh::Vertex> vertices;
+        Vector<unsigned int> indices;
+        Vector<Mesh::Submesh> submeshes;
+        Vector<Mesh::Submesh> member_ranges(material_count * member_count);
+        Vector<Bounds> bounds(member_count);
+        Vector<int> vertex_offsets(member_count);
+        vertices.Resize(batch.vertex_count);
+
+        int vertex_offset = 0;
+        for (int i = 0; i < member_count; ++i)
+        {
+            const auto& renderer = batch.renderers[i];
+            const auto& mesh_vertices = renderer->GetMesh()->GetVertices();
+
+            // normals use inverse transpose for non uniform scale
+            Matrix4x4 model_matrix = renderer->GetTransform()->GetLocalToWorldMatrix();
+            Matrix4x4 normal_matrix = model_matrix.Inverse().Transpose();
+            // lightmap scale offset is per renderer, batch root draws with identity scale offset
+            Vector4 lightmap_scale_offset = renderer->GetLightmapScaleOffset();
+            bool lightmap = renderer->GetLightmapIndex() >= 0;
+
+            Vector3 min(Mathf::MaxFloatValue, Mathf::MaxFloatValue, Mathf::MaxFloatValue);
+            Vector3 max(Mathf::MinFloatValue, Mathf::MinFloatValue, Mathf::MinFloatValue);
+
+            for (int j = 0; j < mesh_vertices.Size(); ++j)
+            {
+                Mesh::Vertex v = mesh_vertices[j];
+                Vector3 pos = model_matrix.MultiplyPoint3x4(Vector3(v.vertex.x, v.vertex.y, v.vertex.z));
+                Vector3 tangent = Vector3::Normalize(model_matrix.MultiplyDirection(Vector3(v.tangent.x, v.tangent.y, v.tangent.z)));
+
+                v.vertex = Vector4(pos.x, pos.y, pos.z, v.vertex.w);
+                v.normal = Vector3::Normalize(normal_matrix.MultiplyDirection(v.normal));
+                v.tangent = Vector4(tangent.x, tangent.y, tangent.z, v.tangent.w);
+                if (lightmap)
+                {
+                    v.uv2 = Vector2(v.uv2.x * lightmap_scale_offset.x + lightmap_scale_offset.z, v.uv2.y * lightmap_scale_offset.y + lightmap_scale_offset.w);
+                }
+                vertices[vertex_offset + j] = v;
+
+                min = Vector3::Min(min, pos);
+                max = Vector3::Max(max, pos);
+            }
+            bounds[i] = Bounds(min, max);
+
+            vertex_offsets[i] = vertex_offset;
+            vertex_offset += mesh_vertices.Size();
+        }
+
+        // one submesh per material with members in order, so visible members next to each other draw as one range.
+        // renderer material i draws submesh i, or first submesh if there are less submeshes
+        for (int i = 0; i < material_count; ++i)
+        {
+            Mesh::Submesh combined_submesh;
+            combined_submesh.index_first = indices.Size();
+
+            for (int j = 0; j < member_count; ++j)
+            {
+                const auto& mesh = batch.renderers[j]->GetMesh();
+                const auto& mesh_indices = mesh->GetIndices();
+                const auto& mesh_submeshes = mesh->GetSubmeshes();
+                const auto& submesh = mesh_submeshes[i < mesh_submeshes.Size() ? i : 0];
+
+                auto& range = member_ranges[i * member_count + j];
+                range.index_first = indices.Size();
+                range.index_count = submesh.index_count;
+
+                for (int k = 0; k < submesh.index_count; ++k)
+                {
+                    indices.Add(mesh_indices[submesh.index_first + k] + vertex_offsets[j]);
+                }
+            }
+
+            combined_submesh.index_count = indices.Size() - combined_submesh.index_first;
+            submeshes.Add(combined_submesh);
+        }
+
+        // batch vertex count is limited to fit 16 bit indices
+        Ref<Mesh> mesh = RefMake<Mesh>(std::move(vertices), std::move(indices), submeshes);
+
+        auto obj = GameObject::Create("StaticBatch");
+        obj->GetTransform()->SetParent(root->GetTransform());
+        obj->SetLayer(first->GetGameObject()->GetLayer());
+
+        auto batch_root = obj->AddComponent<MeshRenderer>();
+        batch_root->SetMaterials(batch.materials);
+        batch_root->SetShaderKeywords(first->GetShaderKeywords());
+        batch_root->EnableCastShadow(first->IsCastShadow());
+        batch_root->EnableRecieveShadow(first->IsRecieveShadow());
+        batch_root->SetLightmapIndex(first->GetLightmapIndex());
+        batch_root->SetMaxLightCount(first->GetMaxLightCount());
+        batch_root->SetStaticBatchRoot(mesh, std::move(member_ranges), member_count);
+
+        for (int i = 0; i < member_count; ++i)
+        {
+            batch.renderers[i]->SetStaticBatchMember(batch_root, i, bounds[i]);
+        }
+    }
+
+    void StaticBatchingUtility::Combine(const Ref<GameObject>& root)
+    {
+        Vector<Batch> batches;
+
+        auto renderers = root->GetComponentsInChildren<MeshRenderer>();
+        for (int i = 0; i < renderers.Size(); ++i)
+        {
+            const auto& renderer = renderers[i];
+            if (!CanCombine(renderer))
+            {
+                continue;
+            }
+
+            int vertex_count = renderer->GetMesh()->GetVertices().Size();
+
+            Batch* batch = nullptr;
+            for (int j = 0; j < batches.Size(); ++j)
+            {
+                if (batches[j].vertex_count + vertex_count <= BATCH_VERTEX_MAX_COUNT &&
+                    IsSameMaterials(batches[j].materials, renderer->GetMaterials()) &&
+                    IsSameStates(batches[j].renderers[0], renderer))
+                {
+                    batch = &batches[j];
+                    break;
+                }
+            }
+
+            if (batch == nullptr)
+            {
+                Batch new_batch;
+                new_batch.materials = renderer->GetMaterials();
+                new_batch.vertex_count = 0;
+                batches.Add(new_batch);
+                batch = &batches[batches.Size() - 1];
+            }
+
+            batch->renderers.Add(renderer);
+            batch->vertex_count += vertex_count;
+        }
+
+        for (const auto& i : batches)
+        {
+            // single renderer keeps its own mesh
+            if (i.renderers.Size() > 1)
+            {
+                CombineBatch(root, i);
+            }
+        }
+    }
+}
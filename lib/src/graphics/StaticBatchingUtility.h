@@ -0,0 +1,48 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "GameObject.h"
+#include "Material.h"
+
+namespace Viry3D
+{
+    class MeshRenderer;
+
+    // combines meshes of static mesh renderers sharing materials and render states into world space meshes
+    // drawn by a batch root renderer added under root, one draw per material over index ranges of visible members.
+    // members are still culled one by one but draw nothing themselves
+    class StaticBatchingUtility
+    {
+    public:
+        static constexpr int BATCH_VERTEX_MAX_COUNT = 65536;
+
+        // renderers under root must not move after combined
+        static void Combine(const Ref<GameObject>& root);
+
+    private:
+        struct Batch
+        {
+            Vector<Ref<Material>> materials;
+            Vector<Ref<MeshRenderer>> renderers;
+            int vertex_count;
+        };
+
+        static void CombineBatch(const Ref<GameObject>& root, const Batch& batch);
+    };
+}
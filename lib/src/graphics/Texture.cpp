@@ -18,6 +18,7 @@
 #include "Texture.h"
 #include "Image.h"
 #include "Engine.h"
+#include "RenderStats.h"
 #include "math/Mathf.h"
 #include "memory/Memory.h"
 #include "io/MemoryStream.h"
@@ -534,10 +535,20 @@ namespace Viry3D
 		FilterMode filter_mode,
 		SamplerAddressMode wrap_mode,
 		bool gen_mipmap)
+	{
+		auto image = Image::LoadFromMemory(image_buffer);
+
+		return Texture::CreateTexture2DFromImage(image, filter_mode, wrap_mode, gen_mipmap);
+	}
+
+	Ref<Texture> Texture::CreateTexture2DFromImage(
+		const Ref<Image>& image,
+		FilterMode filter_mode,
+		SamplerAddressMode wrap_mode,
+		bool gen_mipmap)
 	{
 		Ref<Texture> texture;
 
-		auto image = Image::LoadFromMemory(image_buffer);
 		if (image)
 		{
 			TextureFormat format;
@@ -963,6 +974,7 @@ namespace Viry3D
 
 		void* buffer = Memory::Alloc<void>(pixels.Size());
 		Memory::Copy(buffer, pixels.Bytes(), pixels.Size());
+		RenderStats::AddTextureUpload(pixels.Size());
         if (IsCompressedFormat(m_format))
         {
             auto data = filament::backend::PixelBufferDescriptor(
@@ -991,6 +1003,7 @@ namespace Viry3D
 
 		void* buffer = Memory::Alloc<void>(pixels.Size());
 		Memory::Copy(buffer, pixels.Bytes(), pixels.Size());
+		RenderStats::AddTextureUpload(pixels.Size());
 		if (IsCompressedFormat(m_format))
 		{
 			auto data = filament::backend::PixelBufferDescriptor(
@@ -108,6 +108,12 @@ namespace Viry3D
 			FilterMode filter_mode,
 			SamplerAddressMode wrap_mode,
 			bool gen_mipmap);
+        // image is decoded already, only upload is left
+        static Ref<Texture> CreateTexture2DFromImage(
+            const Ref<Image>& image,
+            FilterMode filter_mode,
+            SamplerAddressMode wrap_mode,
+            bool gen_mipmap);
         static Ref<Texture> CreateTexture2DFromMemory(
             const ByteBuffer& pixels,
             int width,
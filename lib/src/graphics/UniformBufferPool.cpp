@@ -0,0 +1,205 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "UniformBufferPool.h"
+#include "RenderStats.h"
+#include "Engine.h"
+#include "memory/Memory.h"
+
+namespace Viry3D
+{
+    bool UniformBufferPool::m_range_binding = true;
+    uint32_t UniformBufferPool::m_frame = 1;
+    Vector<UniformBufferPool::Page> UniformBufferPool::m_pages;
+    Map<int, Vector<UniformBufferSlice>> UniformBufferPool::m_free_slices;
+    Vector<UniformBufferPool::Page> UniformBufferPool::m_ring_pages;
+    int UniformBufferPool::m_ring_page = 0;
+    int UniformBufferPool::m_upload_size = 0;
+
+    void UniformBufferPool::Init()
+    {
+        m_range_binding = Engine::Instance()->GetBackend() != filament::backend::Backend::D3D11;
+    }
+
+    void UniformBufferPool::Done()
+    {
+        auto& driver = Engine::Instance()->GetDriverApi();
+
+        for (auto& i : m_pages)
+        {
+            driver.destroyUniformBuffer(i.uniform_buffer);
+        }
+        m_pages.Clear();
+        m_free_slices.Clear();
+
+        for (auto& i : m_ring_pages)
+        {
+            driver.destroyUniformBuffer(i.uniform_buffer);
+        }
+        m_ring_pages.Clear();
+        m_ring_page = 0;
+    }
+
+    void UniformBufferPool::BeginFrame()
+    {
+        ++m_frame;
+        if (m_frame == 0)
+        {
+            m_frame = 1;
+        }
+
+        for (auto& i : m_ring_pages)
+        {
+            i.used = 0;
+        }
+        m_ring_page = 0;
+        m_upload_size = 0;
+    }
+
+    UniformBufferPool::Page UniformBufferPool::CreatePage(int size)
+    {
+        // stream usage keeps gl range binding checks on the uploaded size
+        auto usage = m_range_binding ? filament::backend::BufferUsage::STREAM : filament::backend::BufferUsage::DYNAMIC;
+
+        Page page;
+        page.uniform_buffer = Engine::Instance()->GetDriverApi().createUniformBuffer(size, usage);
+        page.buffer = ByteBuffer(size);
+        Memory::Zero(page.buffer.Bytes(), size);
+        return page;
+    }
+
+    UniformBufferSlice UniformBufferPool::Alloc(int size)
+    {
+        assert(size > 0 && size <= PAGE_SIZE);
+
+        int aligned_size = m_range_binding ? (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : size;
+
+        Vector<UniformBufferSlice>* free_slices;
+        if (m_free_slices.TryGet(aligned_size, &free_slices) && free_slices->Size() > 0)
+        {
+            UniformBufferSlice slice = (*free_slices)[free_slices->Size() - 1];
+            free_slices->Remove(free_slices->Size() - 1);
+            slice.size = size;
+            return slice;
+        }
+
+        if (m_pages.Size() == 0 || !m_range_binding || m_pages[m_pages.Size() - 1].used + aligned_size > PAGE_SIZE)
+        {
+            m_pages.Add(CreatePage(m_range_binding ? PAGE_SIZE : aligned_size));
+        }
+
+        int page_index = m_pages.Size() - 1;
+        auto& page = m_pages[page_index];
+
+        UniformBufferSlice slice;
+        slice.uniform_buffer = page.uniform_buffer;
+        slice.page = page_index;
+        slice.offset = page.used;
+        slice.size = size;
+        page.used += aligned_size;
+
+        return slice;
+    }
+
+    UniformBufferSlice UniformBufferPool::AllocFrame(int size)
+    {
+        assert(m_range_binding);
+        assert(size > 0 && size <= PAGE_SIZE);
+
+        int aligned_size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+        if (m_ring_page < m_ring_pages.Size() && m_ring_pages[m_ring_page].used + aligned_size > PAGE_SIZE)
+        {
+            ++m_ring_page;
+        }
+        if (m_ring_page >= m_ring_pages.Size())
+        {
+            m_ring_pages.Add(CreatePage(PAGE_SIZE));
+        }
+
+        auto& page = m_ring_pages[m_ring_page];
+
+        UniformBufferSlice slice;
+        slice.uniform_buffer = page.uniform_buffer;
+        slice.page = m_ring_page;
+        slice.offset = page.used;
+        slice.size = size;
+        slice.frame = m_frame;
+        page.used += aligned_size;
+
+        return slice;
+    }
+
+    void UniformBufferPool::Free(UniformBufferSlice& slice)
+    {
+        // ring slices go away with their frame
+        if (slice.frame == 0 && slice.page >= 0 && slice.page < m_pages.Size())
+        {
+            int aligned_size = m_range_binding ? (slice.size + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : slice.size;
+            m_free_slices[aligned_size].Add(slice);
+        }
+
+        slice = UniformBufferSlice();
+    }
+
+    UniformBufferPool::Page& UniformBufferPool::GetPage(const UniformBufferSlice& slice)
+    {
+        if (slice.frame != 0)
+        {
+            assert(slice.frame == m_frame);
+            return m_ring_pages[slice.page];
+        }
+        return m_pages[slice.page];
+    }
+
+    void UniformBufferPool::Write(const UniformBufferSlice& slice, const void* data, int size)
+    {
+        assert(size <= slice.size);
+
+        auto& page = GetPage(slice);
+        Memory::Copy(&page.buffer[slice.offset], data, size);
+        page.dirty = true;
+    }
+
+    void UniformBufferPool::FlushPage(Page& page)
+    {
+        if (!page.dirty || page.used == 0)
+        {
+            return;
+        }
+        page.dirty = false;
+
+        // pages are loaded from start, bytes after used are never bound
+        void* buffer = Memory::Alloc<void>(page.used);
+        Memory::Copy(buffer, page.buffer.Bytes(), page.used);
+        Engine::Instance()->GetDriverApi().loadUniformBuffer(page.uniform_buffer, filament::backend::BufferDescriptor(buffer, page.used, FreeBufferCallback));
+        m_upload_size += page.used;
+        RenderStats::AddUniformUpload(page.used);
+    }
+
+    void UniformBufferPool::Flush()
+    {
+        for (auto& i : m_pages)
+        {
+            FlushPage(i);
+        }
+        for (auto& i : m_ring_pages)
+        {
+            FlushPage(i);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "container/Vector.h"
+#include "container/Map.h"
+#include "memory/ByteBuffer.h"
+#include "private/backend/DriverApi.h"
+
+namespace Viry3D
+{
+    // range of a pooled uniform buffer page, bound with bindUniformBufferRange
+    struct UniformBufferSlice
+    {
+        filament::backend::UniformBufferHandle uniform_buffer;
+        int page = -1;
+        int offset = 0;
+        int size = 0;
+        uint32_t frame = 0; // frame of ring slices, 0 for pooled slices
+    };
+
+    // packs uniform buffers into a few large driver buffers with a cpu copy each.
+    // pooled slices live until freed, ring slices are written once and valid in the frame
+    // they are allocated in. dirty pages are uploaded in one load each before a render pass begins.
+    // d3d11 ignores binding offsets, so there every pooled slice gets its own buffer and ring is off
+    class UniformBufferPool
+    {
+    public:
+        static constexpr int PAGE_SIZE = 64 * 1024;
+        static constexpr int ALIGNMENT = 256;
+
+        static void Init();
+        static void Done();
+        static bool IsRingEnable() { return m_range_binding; }
+        static void BeginFrame();
+        static uint32_t GetFrame() { return m_frame; }
+        static UniformBufferSlice Alloc(int size);
+        static UniformBufferSlice AllocFrame(int size);
+        static void Free(UniformBufferSlice& slice);
+        static void Write(const UniformBufferSlice& slice, const void* data, int size);
+        // upload dirty pages, outside render pass
+        static void Flush();
+        static int GetPageCount() { return m_pages.Size() + m_ring_pages.Size(); }
+        // bytes uploaded since frame begin
+        static int GetUploadSize() { return m_upload_size; }
+
+    private:
+        struct Page
+        {
+            filament::backend::UniformBufferHandle uniform_buffer;
+            ByteBuffer buffer;
+            int used = 0;
+            bool dirty = false;
+        };
+
+        static Page CreatePage(int size);
+        static void FlushPage(Page& page);
+        static Page& GetPage(const UniformBufferSlice& slice);
+
+    private:
+        static bool m_range_binding;
+        static uint32_t m_frame;
+        static Vector<Page> m_pages;
+        static Map<int, Vector<UniformBufferSlice>> m_free_slices; // aligned size to freed slices
+        static Vector<Page> m_ring_pages;
+        static int m_ring_page;
+        static int m_upload_size;
+    };
+}
@@ -17,6 +17,7 @@
 
 #include "Bounds.h"
 #include "Mathf.h"
+#include "Matrix4x4.h"
 
 namespace Viry3D
 {
@@ -42,4 +43,23 @@ namespace Viry3D
             (point.z > m_min.z || Mathf::FloatEqual(point.z, m_min.z)) &&
             (point.z < m_max.z || Mathf::FloatEqual(point.z, m_max.z));
 	}
+
+	void Bounds::Encapsulate(const Bounds& bounds)
+	{
+		m_min = Vector3::Min(m_min, bounds.m_min);
+		m_max = Vector3::Max(m_max, bounds.m_max);
+	}
+
+	Bounds Bounds::Transform(const Matrix4x4& mat) const
+	{
+		// transform center and project extents onto world axes, avoids transforming 8 corners
+		Vector3 center = mat.MultiplyPoint3x4(this->GetCenter());
+		Vector3 extents = this->GetSize() * 0.5f;
+		Vector3 world_extents(
+			fabs(mat.m00) * extents.x + fabs(mat.m01) * extents.y + fabs(mat.m02) * extents.z,
+			fabs(mat.m10) * extents.x + fabs(mat.m11) * extents.y + fabs(mat.m12) * extents.z,
+			fabs(mat.m20) * extents.x + fabs(mat.m21) * extents.y + fabs(mat.m22) * extents.z);
+
+		return Bounds(center - world_extents, center + world_extents);
+	}
 }
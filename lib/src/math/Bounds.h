@@ -21,6 +21,8 @@
 
 namespace Viry3D
 {
+	class Matrix4x4;
+
 	class Bounds
 	{
 	public:
@@ -31,6 +33,9 @@ namespace Viry3D
         Vector3 GetCenter() const { return (m_min + m_max) * 0.5f; }
         Vector3 GetSize() const { return m_max - m_min; }
 		bool Contains(const Vector3& point) const;
+		void Encapsulate(const Bounds& bounds);
+		// axis aligned bounds of transformed box
+		Bounds Transform(const Matrix4x4& mat) const;
 
 	private:
 		Vector3 m_min;
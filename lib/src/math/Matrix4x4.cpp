@@ -62,9 +62,9 @@ namespace Viry3D
 		ptr[row * 4 + 3] = v.w;
 	}
 
-	Vector4 Matrix4x4::GetRow(int row)
+	Vector4 Matrix4x4::GetRow(int row) const
 	{
-		float* ptr = (float*) this;
+		const float* ptr = (const float*) this;
 
 		return Vector4(
 			ptr[row * 4 + 0],
@@ -83,9 +83,9 @@ namespace Viry3D
 		ptr[3 * 4 + row] = v.w;
 	}
 
-	Vector4 Matrix4x4::GetColumn(int row)
+	Vector4 Matrix4x4::GetColumn(int row) const
 	{
-		float* ptr = (float*) this;
+		const float* ptr = (const float*) this;
 
 		return Vector4(
 			ptr[0 * 4 + row],
@@ -47,9 +47,9 @@ namespace Viry3D
 		Matrix4x4 Transpose() const;
 		String ToString() const;
 		void SetRow(int row, const Vector4& v);
-		Vector4 GetRow(int row);
+		Vector4 GetRow(int row) const;
 		void SetColumn(int row, const Vector4& v);
-		Vector4 GetColumn(int row);
+		Vector4 GetColumn(int row) const;
 
 		static Matrix4x4 Identity();
 		static Matrix4x4 Translation(const Vector3& t);
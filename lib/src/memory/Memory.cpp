@@ -19,6 +19,9 @@
 
 namespace Viry3D
 {
+#if VR_MEMORY_ALLOC_COUNT
+	std::atomic<int64_t> Memory::m_alloc_count(0);
+#endif
 #ifndef NDEBUG
 	std::mutex Memory::m_mutex;
 	int Memory::m_alloc_size = 0;
@@ -18,8 +18,15 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <mutex>
+#include <atomic>
+
+// benchmark only, counts Alloc, Realloc and New with an atomic per call
+#ifndef VR_MEMORY_ALLOC_COUNT
+#define VR_MEMORY_ALLOC_COUNT 0
+#endif
 
 namespace Viry3D
 {
@@ -29,6 +36,9 @@ namespace Viry3D
 		template<class T>
 		inline static T* Alloc(int size)
 		{
+#if VR_MEMORY_ALLOC_COUNT
+			m_alloc_count.fetch_add(1, std::memory_order_relaxed);
+#endif
 #ifndef NDEBUG
 			m_mutex.lock();
 			m_alloc_size += size;
@@ -40,6 +50,9 @@ namespace Viry3D
         template<class T>
 		inline static T* Realloc(T* block, int size, int old_size = 0)
 		{
+#if VR_MEMORY_ALLOC_COUNT
+			m_alloc_count.fetch_add(1, std::memory_order_relaxed);
+#endif
 #ifndef NDEBUG
 			m_mutex.lock();
 			m_alloc_size -= old_size;
@@ -77,6 +90,9 @@ namespace Viry3D
 		template<class T, typename ... ARGS>
 		inline static T* New(ARGS&& ... args)
 		{
+#if VR_MEMORY_ALLOC_COUNT
+			m_alloc_count.fetch_add(1, std::memory_order_relaxed);
+#endif
 #ifndef NDEBUG
 			m_mutex.lock();
 			m_new_size += sizeof(T);
@@ -100,12 +116,19 @@ namespace Viry3D
             }
         }
 
+#if VR_MEMORY_ALLOC_COUNT
+		// Alloc, Realloc and New calls since startup, also counted in release
+		static int64_t GetAllocCount() { return m_alloc_count.load(std::memory_order_relaxed); }
+#endif
 #ifndef NDEBUG
 		static int GetAllocSize() { return m_alloc_size; }
 		static int GetNewSize() { return m_new_size; }
 #endif
 
 	private:
+#if VR_MEMORY_ALLOC_COUNT
+		static std::atomic<int64_t> m_alloc_count;
+#endif
 #ifndef NDEBUG
 		static std::mutex m_mutex;
 		static int m_alloc_size;
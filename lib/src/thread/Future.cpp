@@ -0,0 +1,46 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Future.h"
+#include "Engine.h"
+
+namespace Viry3D
+{
+	void Task::Dispatch(Action action, TaskContext context)
+	{
+		if (context == TaskContext::MainThread)
+		{
+			Engine::Instance()->PostAction(std::move(action));
+			return;
+		}
+
+		ThreadPool* thread_pool = Engine::Instance()->GetThreadPool();
+		if (thread_pool)
+		{
+			Thread::Task task;
+			task.job = [=]() {
+				action();
+				return nullptr;
+			};
+			thread_pool->AddTask(task);
+		}
+		else
+		{
+			action();
+		}
+	}
+}
@@ -0,0 +1,209 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "ThreadPool.h"
+#include "container/Vector.h"
+#include <atomic>
+#include <assert.h>
+#include <type_traits>
+
+namespace Viry3D
+{
+	template <typename T>
+	class Future;
+
+	// thread a task or continuation runs on
+	enum class TaskContext
+	{
+		Worker,
+		MainThread,
+	};
+
+	// continuations returning void produce Future<bool>
+	template <typename R>
+	struct TaskResult
+	{
+		typedef R Type;
+
+		template <typename F, typename... A>
+		static R Invoke(F& func, const A&... args)
+		{
+			return func(args...);
+		}
+	};
+
+	template <>
+	struct TaskResult<void>
+	{
+		typedef bool Type;
+
+		template <typename F, typename... A>
+		static bool Invoke(F& func, const A&... args)
+		{
+			func(args...);
+			return true;
+		}
+	};
+
+	// starts tasks on engine thread pool and joins futures,
+	// tasks run inline where there is no thread pool
+	class Task
+	{
+	public:
+		static void Dispatch(Action action, TaskContext context);
+		template <typename F>
+		static Future<typename TaskResult<typename std::result_of<F()>::type>::Type> Run(F func, TaskContext context = TaskContext::Worker);
+		// ready when all futures are ready, values keep input order
+		template <typename T>
+		static Future<Vector<T>> WhenAll(const Vector<Future<T>>& futures);
+	};
+
+	// result of a task which completes once, copies share the same result.
+	// never block a worker on a future that needs a worker to complete, nor main thread on one that needs main thread
+	template <typename T>
+	class Future
+	{
+	public:
+		Future(): m_state(RefMake<State>()) { }
+
+		bool IsReady() const
+		{
+			std::lock_guard<Mutex> lock(m_state->mutex);
+			return m_state->ready;
+		}
+
+		// blocks until ready
+		const T& Get() const
+		{
+			std::unique_lock<Mutex> lock(m_state->mutex);
+			m_state->condition.wait(lock, [this]() {
+				return m_state->ready;
+			});
+			return m_state->value;
+		}
+
+		// called once by producer, continuations are dispatched on this thread
+		void SetValue(const T& value)
+		{
+			Vector<Action> continuations;
+
+			{
+				std::lock_guard<Mutex> lock(m_state->mutex);
+				assert(!m_state->ready);
+				m_state->value = value;
+				m_state->ready = true;
+				continuations = m_state->continuations;
+				m_state->continuations.Clear();
+			}
+			m_state->condition.notify_all();
+
+			for (const auto& i : continuations)
+			{
+				i();
+			}
+		}
+
+		// action runs on completing thread, or at once if already ready
+		void OnReady(Action action) const
+		{
+			{
+				std::lock_guard<Mutex> lock(m_state->mutex);
+				if (!m_state->ready)
+				{
+					m_state->continuations.Add(action);
+					return;
+				}
+			}
+
+			action();
+		}
+
+		// runs func with result of this future in context after it is ready
+		template <typename F>
+		Future<typename TaskResult<typename std::result_of<F(const T&)>::type>::Type> Then(F func, TaskContext context = TaskContext::Worker) const
+		{
+			typedef typename std::result_of<F(const T&)>::type R;
+
+			Future<typename TaskResult<R>::Type> next;
+			Ref<State> state = m_state;
+			this->OnReady([=]() {
+				Task::Dispatch([=]() mutable {
+					next.SetValue(TaskResult<R>::Invoke(func, state->value));
+				}, context);
+			});
+
+			return next;
+		}
+
+	private:
+		struct State
+		{
+			Mutex mutex;
+			std::condition_variable condition;
+			bool ready = false;
+			T value;
+			Vector<Action> continuations;
+		};
+
+		Ref<State> m_state;
+	};
+
+	template <typename F>
+	Future<typename TaskResult<typename std::result_of<F()>::type>::Type> Task::Run(F func, TaskContext context)
+	{
+		typedef typename std::result_of<F()>::type R;
+
+		Future<typename TaskResult<R>::Type> future;
+		Task::Dispatch([=]() mutable {
+			future.SetValue(TaskResult<R>::Invoke(func));
+		}, context);
+
+		return future;
+	}
+
+	template <typename T>
+	Future<Vector<T>> Task::WhenAll(const Vector<Future<T>>& futures)
+	{
+		Future<Vector<T>> all;
+
+		if (futures.Size() == 0)
+		{
+			all.SetValue(Vector<T>());
+			return all;
+		}
+
+		auto remain = RefMake<std::atomic<int>>(futures.Size());
+		for (const auto& i : futures)
+		{
+			i.OnReady([=]() mutable {
+				if (--(*remain) == 0)
+				{
+					Vector<T> values(futures.Size());
+					for (int j = 0; j < futures.Size(); ++j)
+					{
+						values[j] = futures[j].Get();
+					}
+					all.SetValue(values);
+				}
+			});
+		}
+
+		return all;
+	}
+}
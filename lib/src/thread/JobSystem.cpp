@@ -0,0 +1,128 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "JobSystem.h"
+#include "memory/Memory.h"
+#include "Profiler.h"
+#include <thread>
+
+namespace Viry3D
+{
+	struct GrainSplitter
+	{
+		static constexpr int MAX_SPLITS = 12;
+
+		uint32_t grain;
+
+		bool split(size_t splits, size_t count) const
+		{
+			return splits < MAX_SPLITS && count >= grain * 2;
+		}
+	};
+
+	JobSystem::JobSystem(int thread_count, int adoptable_thread_count)
+	{
+		if (thread_count <= 0)
+		{
+			thread_count = (int) std::thread::hardware_concurrency() - adoptable_thread_count;
+			if (thread_count < 1)
+			{
+				thread_count = 1;
+			}
+		}
+
+		m_thread_count = thread_count;
+		m_job_system = Memory::New<utils::JobSystem>((size_t) thread_count, (size_t) adoptable_thread_count);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		Memory::SafeDelete(m_job_system);
+	}
+
+	void JobSystem::Adopt()
+	{
+		m_job_system->adopt();
+	}
+
+	void JobSystem::Emancipate()
+	{
+		m_job_system->emancipate();
+	}
+
+	JobSystem::Job* JobSystem::CreateJob(Job* parent, Action action)
+	{
+		if (action)
+		{
+			return utils::jobs::createJob(*m_job_system, parent, std::move(action));
+		}
+		else
+		{
+			return m_job_system->createJob(parent);
+		}
+	}
+
+	void JobSystem::Run(Job* job)
+	{
+		m_job_system->run(job);
+	}
+
+	JobSystem::Job* JobSystem::RunAndRetain(Job* job)
+	{
+		return m_job_system->runAndRetain(job);
+	}
+
+	void JobSystem::WaitAndRelease(Job*& job)
+	{
+		m_job_system->waitAndRelease(job);
+	}
+
+	void JobSystem::RunAndWait(Job* job)
+	{
+		m_job_system->runAndWait(job);
+	}
+
+	void JobSystem::ParallelFor(int begin, int end, int grain, const std::function<void(int begin, int end)>& func)
+	{
+		int count = end - begin;
+		if (count <= 0)
+		{
+			return;
+		}
+		if (grain < 1)
+		{
+			grain = 1;
+		}
+
+		if (count < grain * 2)
+		{
+			func(begin, end);
+			return;
+		}
+
+		// only pointer is captured to keep job data in job storage,
+		// func outlives jobs as this waits for all of them
+		const auto* f = &func;
+		Job* job = utils::jobs::parallel_for(*m_job_system, nullptr, (uint32_t) begin, (uint32_t) count,
+			[f](uint32_t start, uint32_t size) {
+				PROFILE_SCOPE("JobSystem::ParallelFor");
+				(*f)((int) start, (int) (start + size));
+			},
+			GrainSplitter({ (uint32_t) grain }));
+		m_job_system->runAndWait(job);
+	}
+}
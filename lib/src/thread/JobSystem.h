@@ -0,0 +1,58 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "Action.h"
+#include <utils/JobSystem.h>
+#include <functional>
+
+namespace Viry3D
+{
+	// work stealing job system for fanning out work within a frame, worker count follows cpu cores.
+	// jobs are created, run and waited on threads of the system only, engine adopts main thread.
+	// long blocking tasks like file loading and audio decoding go to ThreadPool instead
+	class JobSystem
+	{
+	public:
+		typedef utils::JobSystem::Job Job;
+
+		// thread count 0 uses one worker per hardware thread besides the adopted ones
+		JobSystem(int thread_count = 0, int adoptable_thread_count = 1);
+		~JobSystem();
+		// make current thread part of the system so it can create, run and wait jobs
+		void Adopt();
+		void Emancipate();
+		int GetThreadCount() const { return m_thread_count; }
+		// parent finishes after all its children finish, empty action makes a job only for grouping
+		Job* CreateJob(Job* parent = nullptr, Action action = nullptr);
+		// job is released after run
+		void Run(Job* job);
+		// job must be waited with WaitAndRelease
+		Job* RunAndRetain(Job* job);
+		// current thread runs other jobs while waiting
+		void WaitAndRelease(Job*& job);
+		void RunAndWait(Job* job);
+		// splits [begin, end) into ranges not smaller than grain and runs them in parallel,
+		// returns after all ranges are done
+		void ParallelFor(int begin, int end, int grain, const std::function<void(int begin, int end)>& func);
+
+	private:
+		utils::JobSystem* m_job_system;
+		int m_thread_count;
+	};
+}
@@ -0,0 +1,179 @@
+/*
+* Viry3D
+* Copyright 2014-2019 by Stack - stackos@qq.com
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include "ThreadPool.h"
+#include <atomic>
+#include <assert.h>
+
+namespace Viry3D
+{
+	// bounded lock free queue for many producer threads and one consumer thread.
+	// values are moved into preallocated cells, so the ring itself does not allocate.
+	// heap memory a value already owns moves with it, e.g. an Action wrapped into InplaceAction
+	// keeps its allocated capture, only lambdas built directly as InplaceAction avoid it.
+	// when ring is full producers fall back to a locked overflow list until consumer drains it,
+	// so nothing is dropped and values of one producer keep their order
+	template <typename T>
+	class MpscQueue
+	{
+	public:
+		// capacity must be power of 2
+		MpscQueue(int capacity);
+		~MpscQueue();
+		void Push(T value);
+		// consumer thread only
+		bool Pop(T& value);
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		bool TryPush(T& value);
+		bool TryPop(T& value);
+
+	private:
+		Cell* m_cells;
+		size_t m_mask;
+		std::atomic<size_t> m_push_pos;
+		size_t m_pop_pos;
+		List<T> m_overflow;
+		std::atomic<int> m_overflow_count;
+		Mutex m_overflow_mutex;
+	};
+
+	template <typename T>
+	MpscQueue<T>::MpscQueue(int capacity):
+		m_cells(nullptr),
+		m_mask((size_t) capacity - 1),
+		m_push_pos(0),
+		m_pop_pos(0),
+		m_overflow_count(0)
+	{
+		assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+		m_cells = new Cell[capacity];
+		for (int i = 0; i < capacity; ++i)
+		{
+			m_cells[i].sequence.store((size_t) i, std::memory_order_relaxed);
+		}
+	}
+
+	template <typename T>
+	MpscQueue<T>::~MpscQueue()
+	{
+		delete[] m_cells;
+	}
+
+	template <typename T>
+	void MpscQueue<T>::Push(T value)
+	{
+		// keep going to overflow while it has values, or they would be passed by later ones
+		if (m_overflow_count.load(std::memory_order_acquire) == 0 && this->TryPush(value))
+		{
+			return;
+		}
+
+		std::lock_guard<Mutex> lock(m_overflow_mutex);
+		m_overflow.AddLast(std::move(value));
+		m_overflow_count.fetch_add(1, std::memory_order_release);
+	}
+
+	template <typename T>
+	bool MpscQueue<T>::Pop(T& value)
+	{
+		if (this->TryPop(value))
+		{
+			return true;
+		}
+
+		// only take overflow when ring is really empty, a claimed but unwritten head cell
+		// may hold an older value of a producer whose later ones went to overflow
+		if (m_overflow_count.load(std::memory_order_acquire) > 0 &&
+			m_push_pos.load(std::memory_order_acquire) == m_pop_pos)
+		{
+			std::lock_guard<Mutex> lock(m_overflow_mutex);
+			value = std::move(m_overflow.First());
+			m_overflow.RemoveFirst();
+			m_overflow_count.fetch_sub(1, std::memory_order_release);
+			return true;
+		}
+
+		return false;
+	}
+
+	template <typename T>
+	bool MpscQueue<T>::TryPush(T& value)
+	{
+		Cell* cell;
+		size_t pos = m_push_pos.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			cell = &m_cells[pos & m_mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+
+			if (diff == 0)
+			{
+				// claim cell
+				if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// full
+				return false;
+			}
+			else
+			{
+				pos = m_push_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->value = std::move(value);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template <typename T>
+	bool MpscQueue<T>::TryPop(T& value)
+	{
+		Cell* cell = &m_cells[m_pop_pos & m_mask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+
+		// empty, or producer has claimed cell but not written it yet
+		if ((intptr_t) sequence - (intptr_t) (m_pop_pos + 1) < 0)
+		{
+			return false;
+		}
+
+		value = std::move(cell->value);
+		cell->value = T();
+		cell->sequence.store(m_pop_pos + m_mask + 1, std::memory_order_release);
+		m_pop_pos += 1;
+
+		return true;
+	}
+}
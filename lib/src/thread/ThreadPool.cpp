@@ -18,6 +18,7 @@
 #include "ThreadPool.h"
 #include "Object.h"
 #include "Engine.h"
+#include "Profiler.h"
 
 namespace Viry3D
 {
@@ -73,6 +74,8 @@ namespace Viry3D
 
     void Thread::Run()
     {
+        Profiler::SetThreadName("ThreadPool");
+
         if (m_init_action)
         {
             m_init_action();
@@ -100,12 +103,17 @@ namespace Viry3D
 
             if (task.job)
             {
-                void* result = task.job();
+                void* result;
+                {
+                    PROFILE_SCOPE("ThreadPool::Task");
+                    result = task.job();
+                }
 
                 if (task.complete)
                 {
-                    Engine::Instance()->PostAction([=]() {
-                        task.complete(result);
+                    // only callback and result, so capture fits InplaceAction
+                    Engine::Instance()->PostAction([complete = std::move(task.complete), result]() {
+                        complete(result);
                     });
                 }
             }
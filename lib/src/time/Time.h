@@ -50,6 +50,7 @@ namespace Viry3D
 		//	local date
 		static Date GetDate();
 		static int GetFPS() { return m_fps; }
+		// draws of last frame, see RenderStats for more
 		static void SetDrawCall(int count) { m_draw_call = count; }
 		static int GetDrawCall() { return m_draw_call; }
 		static void Update();
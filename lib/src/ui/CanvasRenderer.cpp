@@ -20,6 +20,7 @@
 #include "Debug.h"
 #include "Input.h"
 #include "Engine.h"
+#include "Profiler.h"
 #include "graphics/Mesh.h"
 #include "graphics/Shader.h"
 #include "graphics/Material.h"
@@ -175,6 +176,8 @@ namespace Viry3D
 
     void CanvasRenderer::UpdateCanvas()
     {
+        PROFILE_SCOPE("CanvasRenderer::UpdateCanvas");
+
         m_view_meshes.Clear();
 
         for (int i = 0; i < m_views.Size(); ++i)
@@ -22,6 +22,7 @@
 #include "graphics/Shader.h"
 #include "graphics/Material.h"
 #include "graphics/Camera.h"
+#include "graphics/RenderStats.h"
 #include "Engine.h"
 #include "Input.h"
 #include "imgui/imgui.h"
@@ -65,6 +66,56 @@ namespace Viry3D
         ImGui::DestroyContext();
     }
 
+    Rect ImGuiRenderer::DrawRenderStats()
+    {
+        const auto& stats = RenderStats::GetLastFrame();
+        Rect rect;
+
+        ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowBgAlpha(0.6f);
+        if (ImGui::Begin("Render Stats", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            ImGui::Text("FPS: %d  Frame: %d", Time::GetFPS(), stats.frame_count);
+            ImGui::Separator();
+            ImGui::Text("Draw calls: %d", stats.draws.draw_calls);
+            ImGui::Text("Instanced draws: %d (%d instances)", stats.draws.instanced_draws, stats.draws.instances);
+            ImGui::Text("Triangles: %lld", (long long) stats.draws.triangles);
+            ImGui::Text("Material binds: %d", stats.draws.material_binds);
+            ImGui::Text("Program changes: %d", stats.draws.program_changes);
+            ImGui::Text("Buffer and sampler binds: %d (%d skipped)", stats.binds, stats.bind_skips);
+            ImGui::Separator();
+            ImGui::Text("Uniform uploads: %d (%.1f KB)", stats.uniform_uploads, stats.uniform_upload_bytes / 1024.0f);
+            ImGui::Text("Texture uploads: %d (%.1f KB)", stats.texture_uploads, stats.texture_upload_bytes / 1024.0f);
+            ImGui::Text("Mesh uploads: %d (%.1f KB)", stats.buffer_uploads, stats.buffer_upload_bytes / 1024.0f);
+            ImGui::Separator();
+            ImGui::Text("Renderers: %d visible, %d culled", stats.visible_renderers, stats.culled_renderers);
+            ImGui::Text("Shadow casters: %d", stats.shadow_casters);
+            ImGui::Text("Shader variants: %d compiled, %d from disk cache", stats.shader_variants_compiled, stats.shader_variant_cache_hits);
+            ImGui::Text("Temporary targets: %d (%d created)", stats.temporary_targets, stats.temporary_targets_created);
+
+            if (stats.cameras.Size() > 0 && ImGui::CollapsingHeader("Cameras"))
+            {
+                for (int i = 0; i < stats.cameras.Size(); ++i)
+                {
+                    const auto& camera = stats.cameras[i];
+                    ImGui::Text("%d %s: %d visible, %d culled, %d draws",
+                        i,
+                        camera.name.CString(),
+                        camera.visible_renderers,
+                        camera.culled_renderers,
+                        camera.draw_calls);
+                }
+            }
+
+            auto pos = ImGui::GetWindowPos();
+            auto size = ImGui::GetWindowSize();
+            rect = Rect(pos.x, pos.y, size.x, size.y);
+        }
+        ImGui::End();
+
+        return rect;
+    }
+
     void ImGuiRenderer::UpdateImGui()
     {
         ImGuiIO& io = ImGui::GetIO();
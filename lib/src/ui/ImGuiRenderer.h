@@ -19,12 +19,15 @@
 
 #include "graphics/MeshRenderer.h"
 #include "Action.h"
+#include "math/Rect.h"
 
 namespace Viry3D
 {
     class ImGuiRenderer : public MeshRenderer
     {
     public:
+        // window with render stats of last frame, call in draw action. returns window rect in pixels
+        static Rect DrawRenderStats();
         ImGuiRenderer();
         virtual ~ImGuiRenderer();
         void UpdateImGui();